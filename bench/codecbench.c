@@ -0,0 +1,329 @@
+/***************************************************************************
+ * codecbench.c
+ *
+ * Microbenchmark of the libmseed data sample encoders and decoders.
+ *
+ * Random walk signals are generated with first differences limited to
+ * a number of bits, which decides the Steim 1 (8, 16, 32-bit) and
+ * Steim 2 (4, 5, 6, 8, 10, 15, 30-bit) difference widths used.  Each
+ * signal is encoded into record payloads, as when packing 4096-byte
+ * records, and decoded again, for both byte orders.
+ *
+ * For each codec, difference width and byte order the time per sample
+ * for encoding and decoding and the compression ratio (32-bit input
+ * bytes per encoded byte) are reported.  Decoded samples are compared
+ * to the input, lossless codecs must reproduce the signal exactly.
+ *
+ * Usage: codecbench [samples]
+ *
+ * Modified: 2026.292
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libmseed.h>
+#include <packdata.h>
+#include <unpackdata.h>
+
+/* Payload of a 4096-byte record with a 64-byte header */
+#define PAYLOAD 4032
+
+/* Codecs */
+enum
+{
+  CODEC_STEIM1,
+  CODEC_STEIM2,
+  CODEC_INT32,
+  CODEC_INT16,
+  CODEC_FLOAT32,
+  CODEC_COUNT
+};
+
+static const char *codecnames[CODEC_COUNT] = {
+    "steim1", "steim2", "int32", "int16", "float32"};
+
+static int widths[] = {4, 5, 6, 8, 10, 15, 16, 20, 30};
+
+static int encodeall (int codec, int32_t *input, float *finput, int npts,
+                      char *payloads, int *counts, int swapflag);
+static int decodeall (int codec, char *payloads, int *counts, int npayloads,
+                      int32_t *output, float *foutput, int npts, int swapflag);
+static double nowsec (void);
+
+int
+main (int argc, char **argv)
+{
+  int nwidths = sizeof (widths) / sizeof (widths[0]);
+  int npts    = 1000000;
+  int32_t *input;
+  int32_t *output;
+  float *finput;
+  float *foutput;
+  char *payloads;
+  int *counts;
+  int npayloads = 0;
+  int maxpayloads;
+  int32_t diff;
+  int32_t range;
+  int32_t limit;
+  double start;
+  double encodens;
+  double decodens;
+  double ratio;
+  int repeat;
+  int lossless;
+  int mismatch;
+  int failures = 0;
+  int swapflag;
+  int codec;
+  int widx;
+  int idx;
+
+  if (argc > 1)
+    npts = atoi (argv[1]);
+
+  if (npts < 1000)
+  {
+    fprintf (stderr, "Usage: %s [samples], at least 1000 samples\n", argv[0]);
+    return 1;
+  }
+
+  /* Wide Steim differences encode fewer samples per payload than int32,
+   * at least 1/2 sample per 32-bit word including frame overhead */
+  maxpayloads = npts / (PAYLOAD / 8) + 2;
+
+  input    = (int32_t *)malloc (npts * sizeof (int32_t));
+  output   = (int32_t *)malloc (npts * sizeof (int32_t));
+  finput   = (float *)malloc (npts * sizeof (float));
+  foutput  = (float *)malloc (npts * sizeof (float));
+  payloads = (char *)malloc ((size_t)maxpayloads * PAYLOAD);
+  counts   = (int *)malloc (maxpayloads * sizeof (int));
+
+  if (!input || !output || !finput || !foutput || !payloads || !counts)
+  {
+    fprintf (stderr, "Cannot allocate memory\n");
+    return 1;
+  }
+
+  printf ("%-8s %5s %-6s %12s %12s %7s %s\n",
+          "codec", "width", "order", "encode ns", "decode ns", "ratio", "check");
+
+  for (widx = 0; widx < nwidths; widx++)
+  {
+    /* Random walk with differences of at most widths[widx] bits,
+     * kept within 16 bits when the differences are narrow enough */
+    range = (1 << (widths[widx] - 1)) - 1;
+    limit = (widths[widx] < 15) ? 32767 - range : (1 << 30);
+    srand (widths[widx]);
+
+    input[0] = 0;
+    for (idx = 1; idx < npts; idx++)
+    {
+      diff = (int32_t)(((int64_t)rand () * rand ()) % (2 * (int64_t)range + 1)) - range;
+
+      if (input[idx - 1] + (int64_t)diff > limit || input[idx - 1] + (int64_t)diff < -limit)
+        diff = -diff;
+
+      input[idx] = input[idx - 1] + diff;
+    }
+
+    for (idx = 0; idx < npts; idx++)
+      finput[idx] = (float)input[idx];
+
+    for (codec = 0; codec < CODEC_COUNT; codec++)
+    {
+      /* Samples beyond 16 bits are truncated by int16 and rounded by float32 */
+      lossless = 1;
+      for (idx = 0; idx < npts && lossless; idx++)
+      {
+        if (codec == CODEC_INT16 && (input[idx] > 32767 || input[idx] < -32768))
+          lossless = 0;
+        else if (codec == CODEC_FLOAT32 && (input[idx] > (1 << 24) || input[idx] < -(1 << 24)))
+          lossless = 0;
+      }
+
+      for (swapflag = 0; swapflag <= 1; swapflag++)
+      {
+        start = nowsec ();
+        for (repeat = 0; repeat == 0 || nowsec () - start < 0.1; repeat++)
+        {
+          if ((npayloads = encodeall (codec, input, finput, npts, payloads, counts, swapflag)) < 0)
+          {
+            fprintf (stderr, "Error encoding %s\n", codecnames[codec]);
+            return 1;
+          }
+        }
+        encodens = (nowsec () - start) / repeat / npts * 1e9;
+
+        start = nowsec ();
+        for (repeat = 0; repeat == 0 || nowsec () - start < 0.1; repeat++)
+        {
+          if (decodeall (codec, payloads, counts, npayloads, output, foutput, npts, swapflag) != npts)
+          {
+            fprintf (stderr, "Error decoding %s\n", codecnames[codec]);
+            return 1;
+          }
+        }
+        decodens = (nowsec () - start) / repeat / npts * 1e9;
+
+        ratio = (double)npts * 4 / ((double)npayloads * PAYLOAD);
+
+        if (codec == CODEC_FLOAT32)
+          mismatch = memcmp (finput, foutput, npts * sizeof (float));
+        else
+          mismatch = memcmp (input, output, npts * sizeof (int32_t));
+
+        if (mismatch && lossless)
+          failures++;
+
+        /* Swapping produces the byte order opposite to the host */
+        printf ("%-8s %5d %-6s %12.2f %12.2f %7.2f %s\n",
+                codecnames[codec], widths[widx],
+                (ms_bigendianhost () ^ swapflag) ? "big" : "little",
+                encodens, decodens, ratio,
+                (!mismatch) ? "ok" : (lossless) ? "FAILED" : "lossy");
+      }
+    }
+  }
+
+  free (input);
+  free (output);
+  free (finput);
+  free (foutput);
+  free (payloads);
+  free (counts);
+
+  if (failures)
+    fprintf (stderr, "%d round trip(s) FAILED\n", failures);
+
+  return (failures) ? 1 : 0;
+} /* End of main() */
+
+/***************************************************************************
+ * encodeall:
+ *
+ * Encode all samples into consecutive payloads, storing the sample
+ * count of each payload.  Steim difference chains continue across
+ * payloads as when packing records.
+ *
+ * Returns the number of payloads on success and -1 on error.
+ ***************************************************************************/
+static int
+encodeall (int codec, int32_t *input, float *finput, int npts,
+           char *payloads, int *counts, int swapflag)
+{
+  char *payload;
+  int32_t diff0;
+  int npayloads = 0;
+  int offset    = 0;
+  int count     = 0;
+
+  while (offset < npts)
+  {
+    payload = payloads + (size_t)npayloads * PAYLOAD;
+    diff0   = (offset > 0) ? input[offset] - input[offset - 1] : 0;
+
+    switch (codec)
+    {
+    case CODEC_STEIM1:
+      count = msr_encode_steim1 (input + offset, npts - offset, (int32_t *)payload,
+                                 PAYLOAD, diff0, swapflag);
+      break;
+    case CODEC_STEIM2:
+      count = msr_encode_steim2 (input + offset, npts - offset, (int32_t *)payload,
+                                 PAYLOAD, diff0, "BENCH", swapflag);
+      break;
+    case CODEC_INT32:
+      count = msr_encode_int32 (input + offset, npts - offset, (int32_t *)payload,
+                                PAYLOAD, swapflag);
+      break;
+    case CODEC_INT16:
+      count = msr_encode_int16 (input + offset, npts - offset, (int16_t *)payload,
+                                PAYLOAD, swapflag);
+      break;
+    case CODEC_FLOAT32:
+      count = msr_encode_float32 (finput + offset, npts - offset, (float *)payload,
+                                  PAYLOAD, swapflag);
+      break;
+    }
+
+    if (count <= 0)
+      return -1;
+
+    counts[npayloads++] = count;
+    offset += count;
+  }
+
+  return npayloads;
+} /* End of encodeall() */
+
+/***************************************************************************
+ * decodeall:
+ *
+ * Decode all payloads into the output array.
+ *
+ * Returns the number of samples decoded on success and -1 on error.
+ ***************************************************************************/
+static int
+decodeall (int codec, char *payloads, int *counts, int npayloads,
+           int32_t *output, float *foutput, int npts, int swapflag)
+{
+  char *payload;
+  int offset = 0;
+  int count  = 0;
+  int pidx;
+
+  for (pidx = 0; pidx < npayloads; pidx++)
+  {
+    payload = payloads + (size_t)pidx * PAYLOAD;
+
+    switch (codec)
+    {
+    case CODEC_STEIM1:
+      count = msr_decode_steim1 ((int32_t *)payload, PAYLOAD, counts[pidx],
+                                 output + offset, (npts - offset) * 4, "BENCH", swapflag);
+      break;
+    case CODEC_STEIM2:
+      count = msr_decode_steim2 ((int32_t *)payload, PAYLOAD, counts[pidx],
+                                 output + offset, (npts - offset) * 4, "BENCH", swapflag);
+      break;
+    case CODEC_INT32:
+      count = msr_decode_int32 ((int32_t *)payload, counts[pidx],
+                                output + offset, (npts - offset) * 4, swapflag);
+      break;
+    case CODEC_INT16:
+      count = msr_decode_int16 ((int16_t *)payload, counts[pidx],
+                                output + offset, (npts - offset) * 4, swapflag);
+      break;
+    case CODEC_FLOAT32:
+      count = msr_decode_float32 ((float *)payload, counts[pidx],
+                                  foutput + offset, (npts - offset) * 4, swapflag);
+      break;
+    }
+
+    if (count != counts[pidx])
+      return -1;
+
+    offset += count;
+  }
+
+  return offset;
+} /* End of decodeall() */
+
+/***************************************************************************
+ * nowsec:
+ *
+ * Returns the monotonic clock time in seconds.
+ ***************************************************************************/
+static double
+nowsec (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+} /* End of nowsec() */
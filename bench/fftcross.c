@@ -0,0 +1,192 @@
+/***************************************************************************
+ * fftcross.c
+ *
+ * Crossover benchmark of direct form and overlap-save FFT filtering
+ * for decimation.
+ *
+ * For a range of decimation factors and filter lengths a white noise
+ * time-series is decimated with streaming decimators using both
+ * methods, the time per output
+ * sample is reported with the method selected automatically by
+ * decim_fftsize().  For each factor the measured crossover is the
+ * shortest filter for which FFT filtering is faster.
+ *
+ * Usage: fftcross [samples]
+ *
+ * Modified: 2026.292
+ ***************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "decimate.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static double timedecim (double *input, double *work, int npts, int factor,
+                         double *fir, int firnc, int mode);
+static double nowsec (void);
+
+static int factors[] = {2, 3, 4, 5, 7, 10, 20};
+static int lengths[] = {16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+
+int
+main (int argc, char **argv)
+{
+  int nfactors = sizeof (factors) / sizeof (factors[0]);
+  int nlengths = sizeof (lengths) / sizeof (lengths[0]);
+  int npts     = 1000000;
+  double *input;
+  double *work;
+  double *fir;
+  double direct;
+  double fft;
+  double sum;
+  double x;
+  int crossover;
+  int factor;
+  int firnc;
+  int fidx;
+  int lidx;
+  int idx;
+
+  if (argc > 1)
+    npts = atoi (argv[1]);
+
+  if (npts < 1000)
+  {
+    fprintf (stderr, "Usage: %s [samples], at least 1000 samples\n", argv[0]);
+    return 1;
+  }
+
+  input = (double *)malloc (npts * sizeof (double));
+  work  = (double *)malloc (npts * sizeof (double));
+  fir   = (double *)malloc (lengths[nlengths - 1] * sizeof (double));
+
+  if (!input || !work || !fir)
+  {
+    fprintf (stderr, "Cannot allocate memory\n");
+    return 1;
+  }
+
+  srand (1);
+  for (idx = 0; idx < npts; idx++)
+    input[idx] = (double)(rand () % 16777216) - 8388608.0;
+
+  printf ("%6s %6s %12s %12s %8s %6s %6s\n",
+          "factor", "firnc", "direct ns", "fft ns", "speedup", "auto", "fftn");
+
+  for (fidx = 0; fidx < nfactors; fidx++)
+  {
+    factor    = factors[fidx];
+    crossover = 0;
+
+    for (lidx = 0; lidx < nlengths; lidx++)
+    {
+      firnc = lengths[lidx];
+
+      /* Hann windowed-sinc low-pass at the output Nyquist frequency */
+      for (idx = 0, sum = 0.0; idx < firnc; idx++)
+      {
+        x = M_PI * idx / factor;
+        fir[idx] = ((idx) ? sin (x) / x : 1.0) * (0.5 + 0.5 * cos (M_PI * idx / firnc));
+        sum += (idx) ? 2.0 * fir[idx] : fir[idx];
+      }
+      for (idx = 0; idx < firnc; idx++)
+        fir[idx] /= sum;
+
+      direct = timedecim (input, work, npts, factor, fir, firnc, 0);
+      fft    = timedecim (input, work, npts, factor, fir, firnc, 1);
+
+      decim_setfft (-1);
+
+      if (!crossover && fft < direct)
+        crossover = firnc;
+
+      printf ("%6d %6d %12.2f %12.2f %8.2f %6s %6d\n",
+              factor, firnc, direct, fft, direct / fft,
+              (decim_fftsize (factor, firnc)) ? "fft" : "direct",
+              decim_fftsize (factor, firnc));
+    }
+
+    if (crossover)
+      printf ("Factor %d: FFT faster from %d coefficients\n\n", factor, crossover);
+    else
+      printf ("Factor %d: FFT not faster for tested lengths\n\n", factor);
+  }
+
+  free (input);
+  free (work);
+  free (fir);
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * timedecim:
+ *
+ * Decimate the input with a streaming decimator created with the FFT
+ * mode set, repeating until at least 0.2 seconds have elapsed.
+ *
+ * Returns the time per output sample in nanoseconds.
+ ***************************************************************************/
+static double
+timedecim (double *input, double *work, int npts, int factor,
+           double *fir, int firnc, int mode)
+{
+  DecimState *ds;
+  double start;
+  double elapsed;
+  int64_t outputs = 0;
+  int nout;
+  int nflush;
+
+  decim_setfft (mode);
+
+  if (!(ds = decim_init (factor, fir, firnc, 1)))
+  {
+    fprintf (stderr, "Error initializing decimation by %d with %d coefficients\n",
+             factor, firnc);
+    exit (1);
+  }
+
+  start = nowsec ();
+  do
+  {
+    nout   = decim_process (ds, input, npts, 'd', work);
+    nflush = decim_flush (ds, work + nout, 'd');
+
+    if (nout < 0 || nflush < 0)
+    {
+      fprintf (stderr, "Error decimating by %d with %d coefficients\n", factor, firnc);
+      exit (1);
+    }
+
+    outputs += nout + nflush;
+    elapsed = nowsec () - start;
+  } while (elapsed < 0.2);
+
+  decim_free (&ds);
+
+  return elapsed * 1e9 / outputs;
+} /* End of timedecim() */
+
+/***************************************************************************
+ * nowsec:
+ *
+ * Returns the monotonic clock time in seconds.
+ ***************************************************************************/
+static double
+nowsec (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+} /* End of nowsec() */
@@ -0,0 +1,353 @@
+/***************************************************************************
+ * gensdr.c
+ *
+ * Generate synthetic (Win)SDR files for benchmarking.
+ *
+ * Version 1 files contain 8- and 16-bit compressed samples, version 2
+ * files contain 24-bit samples.  The content is either white noise,
+ * where the amplitude controls the mix of 8- and 16-bit samples and
+ * the Steim difference widths, or steps: a constant level changing
+ * once a second with a small amount of noise, compressing to narrow
+ * differences with occasional wide ones.
+ *
+ * The generated samples only depend on the seed.
+ *
+ * Usage: gensdr [-v version] [-c channels] [-r rate] [-b blocks]
+ *               [-m noise|step] [-a amplitude] [-s seed] [-t start] outfile
+ *
+ * Modified: 2026.292
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libmseed.h>
+
+#include "sdrformat.h"
+
+static int32_t nextsample (int32_t *level, int64_t sidx, int32_t limit);
+static int32_t randrange (int32_t amplitude);
+static void usage (void);
+
+static int version       = HDR_VERSION2;
+static int numchannels   = 3;
+static int samplerate    = 100;
+static int numblocks     = 60;
+static int stepmode      = 0;
+static int32_t amplitude = -1;
+static uint32_t seed     = 1;
+static uint32_t start    = 1500000000;
+
+int
+main (int argc, char **argv)
+{
+  HeaderBlock *hblock = NULL;
+  InfoBlock *iblock;
+  BTime btime;
+  FILE *ofp;
+  char *outfile = NULL;
+  uint8_t *block;
+  uint8_t *flags;
+  uint8_t *data;
+  int32_t level[MAX_CHANNELS];
+  int32_t limit;
+  int32_t sample;
+  int64_t sidx[MAX_CHANNELS];
+  int64_t totalsamples = 0;
+  uint32_t position;
+  uint32_t blocktime;
+  int blocksamples;
+  int maxblocksize;
+  int blocksize;
+  int flagsize;
+  int bidx;
+  int cidx;
+  int idx;
+
+  for (idx = 1; idx < argc; idx++)
+  {
+    if (strcmp (argv[idx], "-h") == 0)
+    {
+      usage ();
+      return 0;
+    }
+    else if (strcmp (argv[idx], "-v") == 0 && idx + 1 < argc)
+      version = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-c") == 0 && idx + 1 < argc)
+      numchannels = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-r") == 0 && idx + 1 < argc)
+      samplerate = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-b") == 0 && idx + 1 < argc)
+      numblocks = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-m") == 0 && idx + 1 < argc)
+    {
+      idx++;
+      if (strcmp (argv[idx], "noise") == 0)
+        stepmode = 0;
+      else if (strcmp (argv[idx], "step") == 0)
+        stepmode = 1;
+      else
+      {
+        fprintf (stderr, "Unknown content: %s\n", argv[idx]);
+        return 1;
+      }
+    }
+    else if (strcmp (argv[idx], "-a") == 0 && idx + 1 < argc)
+      amplitude = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-s") == 0 && idx + 1 < argc)
+      seed = strtoul (argv[++idx], NULL, 10);
+    else if (strcmp (argv[idx], "-t") == 0 && idx + 1 < argc)
+      start = strtoul (argv[++idx], NULL, 10);
+    else if (argv[idx][0] == '-')
+    {
+      fprintf (stderr, "Unknown option: %s\n", argv[idx]);
+      return 1;
+    }
+    else
+      outfile = argv[idx];
+  }
+
+  if (!outfile)
+  {
+    usage ();
+    return 1;
+  }
+
+  if (version != HDR_VERSION1 && version != HDR_VERSION2)
+  {
+    fprintf (stderr, "Error, version must be 1 or 2\n");
+    return 1;
+  }
+  if (numchannels < 1 || numchannels > MAX_CHANNELS)
+  {
+    fprintf (stderr, "Error, channels must be 1-%d\n", MAX_CHANNELS);
+    return 1;
+  }
+  if (samplerate < 1 || samplerate > MAX_SAMPLE_RATE)
+  {
+    fprintf (stderr, "Error, sample rate must be 1-%d\n", MAX_SAMPLE_RATE);
+    return 1;
+  }
+  if (numblocks < 1 || numblocks > MAX_FILE_INFO)
+  {
+    fprintf (stderr, "Error, blocks must be 1-%d\n", MAX_FILE_INFO);
+    return 1;
+  }
+
+  /* Sample range of the version, 16 or 24-bit */
+  limit = (version == HDR_VERSION1) ? 32767 : 8388607;
+
+  if (amplitude < 0)
+    amplitude = (version == HDR_VERSION1) ? 1000 : 100000;
+  if (amplitude > limit)
+    amplitude = limit;
+
+  blocksamples = samplerate * numchannels * BLOCK_LEN;
+  flagsize     = (version == HDR_VERSION1) ? flagBlkSize (samplerate * numchannels) : 0;
+  maxblocksize = sizeof (InfoBlock) + flagsize + blocksamples * ((version == HDR_VERSION1) ? 2 : 3);
+
+  hblock = (HeaderBlock *)calloc (1, sizeof (HeaderBlock));
+  block  = (uint8_t *)malloc (maxblocksize);
+
+  if (!hblock || !block)
+  {
+    fprintf (stderr, "Cannot allocate memory\n");
+    return 1;
+  }
+
+  if (!(ofp = fopen (outfile, "wb")))
+  {
+    fprintf (stderr, "Cannot open output file: %s\n", outfile);
+    return 1;
+  }
+
+  hblock->fileVersionFlags = version;
+  hblock->sampleRate       = samplerate;
+  hblock->numSamples       = samplerate * numchannels;
+  hblock->numChannels      = numchannels;
+  hblock->numBlocks        = numblocks;
+  hblock->startTime        = start;
+
+  for (cidx = 0; cidx < numchannels; cidx++)
+  {
+    level[cidx] = 0;
+    sidx[cidx]  = 0;
+  }
+
+  /* Data blocks follow the header block */
+  position = sizeof (HeaderBlock);
+
+  if (fwrite (hblock, sizeof (HeaderBlock), 1, ofp) != 1)
+  {
+    fprintf (stderr, "Error writing to output file\n");
+    return 1;
+  }
+
+  for (bidx = 0; bidx < numblocks; bidx++)
+  {
+    blocktime = start + bidx * BLOCK_LEN;
+
+    memset (block, 0, sizeof (InfoBlock) + flagsize);
+
+    iblock = (InfoBlock *)block;
+    flags  = block + sizeof (InfoBlock);
+    data   = flags + flagsize;
+
+    iblock->goodID        = GOOD_BLK_ID;
+    iblock->flags         = F_ISLOCKED;
+    iblock->startTime     = blocktime;
+    iblock->startTimeTick = (blocktime % SEC_PER_DAY) * MSEC;
+
+    /* Multiplexed samples, channel by channel for each sample time */
+    for (idx = 0; idx < blocksamples; idx++)
+    {
+      cidx   = idx % numchannels;
+      sample = nextsample (&level[cidx], sidx[cidx]++, limit);
+
+      if (version == HDR_VERSION1)
+      {
+        if (sample >= -127 && sample <= 127)
+        {
+          *((int8_t *)data) = (int8_t)sample;
+          data += 1;
+        }
+        else
+        {
+          /* Flag bit set for 16-bit samples */
+          flags[idx / 8] |= 1 << (idx % 8);
+          *((int16_t *)data) = (int16_t)sample;
+          data += 2;
+        }
+      }
+      else
+      {
+        /* 24-bit big-endian */
+        data[0] = (sample >> 16) & 0xFF;
+        data[1] = (sample >> 8) & 0xFF;
+        data[2] = sample & 0xFF;
+        data += 3;
+      }
+    }
+
+    blocksize = (int)(data - block);
+    iblock->blockSize = blocksize;
+
+    ms_hptime2btime (MS_EPOCH2HPTIME (blocktime), &btime);
+
+    hblock->fileInfo[bidx].startTime    = blocktime;
+    hblock->fileInfo[bidx].filePosition = position;
+    hblock->fileInfo[bidx].blockSize    = blocksize;
+    hblock->fileInfo[bidx].julian       = btime.day;
+
+    if (fwrite (block, blocksize, 1, ofp) != 1)
+    {
+      fprintf (stderr, "Error writing to output file\n");
+      return 1;
+    }
+
+    hblock->lastTime        = blocktime;
+    hblock->lastBlockSize   = blocksize;
+    hblock->lastBlockOffset = position;
+
+    position += blocksize;
+    totalsamples += blocksamples;
+  }
+
+  /* Rewrite the completed header block */
+  if (fseek (ofp, 0, SEEK_SET) || fwrite (hblock, sizeof (HeaderBlock), 1, ofp) != 1)
+  {
+    fprintf (stderr, "Error writing to output file\n");
+    return 1;
+  }
+
+  fclose (ofp);
+
+  printf ("Wrote %s: version %d, %d channel(s) @ %d sps, %d block(s), %s, %lld samples, %u bytes\n",
+          outfile, version, numchannels, samplerate, numblocks,
+          (stepmode) ? "step" : "noise", (long long int)totalsamples, position);
+
+  free (hblock);
+  free (block);
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * nextsample:
+ *
+ * Generate the next sample of a channel.  Noise is uniform within
+ * +/- amplitude.  Steps change the level once a second by up to
+ * amplitude, with noise of +/- 1.  Samples are clipped to the limit.
+ *
+ * Returns the sample value.
+ ***************************************************************************/
+static int32_t
+nextsample (int32_t *level, int64_t sidx, int32_t limit)
+{
+  int32_t sample;
+
+  if (stepmode)
+  {
+    if (sidx % samplerate == 0)
+    {
+      *level += randrange (amplitude);
+
+      if (*level > limit / 2 || *level < -limit / 2)
+        *level /= 2;
+    }
+
+    sample = *level + randrange (1);
+  }
+  else
+  {
+    sample = randrange (amplitude);
+  }
+
+  if (sample > limit)
+    sample = limit;
+  else if (sample < -limit)
+    sample = -limit;
+
+  return sample;
+} /* End of nextsample() */
+
+/***************************************************************************
+ * randrange:
+ *
+ * Generate a uniformly distributed integer within +/- amplitude with
+ * a xorshift generator, independent of the C library.
+ *
+ * Returns the random value.
+ ***************************************************************************/
+static int32_t
+randrange (int32_t amplitude)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  return (int32_t)(seed % (uint32_t)(2 * amplitude + 1)) - amplitude;
+} /* End of randrange() */
+
+/***************************************************************************
+ * usage:
+ *
+ * Print the usage message.
+ ***************************************************************************/
+static void
+usage (void)
+{
+  fprintf (stderr, "Generate a synthetic (Win)SDR file\n\n");
+  fprintf (stderr, "Usage: gensdr [options] outfile\n\n"
+                   " -v version      SDR file version, 1 (8/16-bit) or 2 (24-bit), default: 2\n"
+                   " -c channels     Number of channels, default: 3\n"
+                   " -r rate         Sample rate per channel, default: 100\n"
+                   " -b blocks       Number of 1-minute data blocks, default: 60\n"
+                   " -m content      Sample content, 'noise' (default) or 'step'\n"
+                   " -a amplitude    Noise amplitude or maximum step,\n"
+                   "                   default: 1000 for version 1, 100000 for version 2\n"
+                   " -s seed         Random seed, default: 1\n"
+                   " -t start        Start time in seconds since the epoch, default: 1500000000\n"
+                   "\n");
+} /* End of usage() */
@@ -0,0 +1,738 @@
+/***************************************************************************
+ * sdrbench.c
+ *
+ * Per-stage throughput benchmark of (Win)SDR to Mini-SEED conversion.
+ *
+ * An SDR file is converted block by block as sdr2mseed does, timing
+ * each stage separately:
+ *
+ *   read     : reading the data blocks from the file
+ *   decode   : decompressing 8/16-bit or unpacking 24-bit samples
+ *   demux    : demultiplexing the samples into channels
+ *   decimate : decimating the channels, only with -D
+ *   pack     : packing the samples into Mini-SEED records in memory
+ *   write    : writing the records to the output file
+ *
+ * For each stage the time, the throughput of the data handled by the
+ * stage in MB/s (10^6 bytes) and in samples/s are reported, followed
+ * by the peak resident set size of the process.  Files are expected to
+ * be contiguous, as produced by gensdr, decimated sample times follow
+ * from the first block.
+ *
+ * Usage: sdrbench [-D ratio] [-Q] [-e encoding] [-r reclen] [-o outfile] file
+ *
+ * Modified: 2026.292
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include <libmseed.h>
+
+#include "decimate.h"
+#include "sdrdecode.h"
+
+#define MAX_STAGES 8
+
+/* Benchmark stages in processing order */
+enum
+{
+  ST_READ,
+  ST_DECODE,
+  ST_DEMUX,
+  ST_DECIMATE,
+  ST_PACK,
+  ST_WRITE,
+  ST_COUNT
+};
+
+/* Time and data handled by a stage */
+struct stage
+{
+  const char *name; /* Stage name */
+  double seconds;   /* Time spent in stage */
+  int64_t bytes;    /* Bytes handled by stage */
+  int64_t samples;  /* Samples handled by stage */
+};
+
+/* Growing buffer of packed records */
+struct recbuffer
+{
+  char *data;  /* Record data */
+  size_t len;  /* Bytes of record data */
+  size_t size; /* Allocated bytes */
+};
+
+static int decimatechannel (int cidx, void *input, int nin, int flush);
+static int packchannel (MSTraceGroup *mstg, MSRecord *msr, int cidx, void *data, int nsamples);
+static int64_t packgroup (MSTraceGroup *mstg, flag flush);
+static void record_handler (char *record, int reclen, void *handlerdata);
+static void report (struct stage *stages, double wall, int64_t filebytes);
+static double nowsec (void);
+static void usage (void);
+
+static int ratio       = 1;
+static int fixedpoint  = 0;
+static int encoding    = 11;
+static int reclen      = 4096;
+static char sampletype = 'i';
+static char *outfile   = "sdrbench.mseed";
+
+static int nfactors = 0;
+static int factors[MAX_STAGES];
+static DecimState *decim[MAX_CHANNELS][MAX_STAGES];
+static void *work[MAX_CHANNELS][MAX_STAGES];
+static int worksize[MAX_CHANNELS][MAX_STAGES];
+static int lastout[MAX_CHANNELS];
+static int64_t outsamples[MAX_CHANNELS];
+static hptime_t streamstart;
+static double samprate;
+
+static struct recbuffer records;
+
+int
+main (int argc, char **argv)
+{
+  struct stage stages[ST_COUNT] = {
+      {"read", 0.0, 0, 0},
+      {"decode", 0.0, 0, 0},
+      {"demux", 0.0, 0, 0},
+      {"decimate", 0.0, 0, 0},
+      {"pack", 0.0, 0, 0},
+      {"write", 0.0, 0, 0}};
+  HeaderBlock *hblock = NULL;
+  FileInfo *finfo;
+  InfoBlock *iblock;
+  MSTraceGroup *mstg = NULL;
+  MSRecord *msr = NULL;
+  BTime btime;
+  FILE *ifp;
+  FILE *ofp;
+  char *sdrfile = NULL;
+  char *datablock = NULL;
+  int datablocklength = 0;
+  int16_t *i16muxed = NULL;
+  int32_t *i32muxed = NULL;
+  int32_t *cdata = NULL;
+  void *chandata[MAX_CHANNELS];
+  int chansamples[MAX_CHANNELS];
+  int64_t filebytes = 0;
+  int64_t packed;
+  hptime_t blocktime;
+  int32_t sample;
+  int headerversion;
+  int mssamples;
+  int numblocks = 0;
+  double wall;
+  double t0;
+  int idx;
+  int cidx;
+  int sidx;
+  int midx;
+
+  for (idx = 1; idx < argc; idx++)
+  {
+    if (strcmp (argv[idx], "-h") == 0)
+    {
+      usage ();
+      return 0;
+    }
+    else if (strcmp (argv[idx], "-D") == 0 && idx + 1 < argc)
+      ratio = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-Q") == 0)
+      fixedpoint = 1;
+    else if (strcmp (argv[idx], "-e") == 0 && idx + 1 < argc)
+      encoding = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-r") == 0 && idx + 1 < argc)
+      reclen = atoi (argv[++idx]);
+    else if (strcmp (argv[idx], "-o") == 0 && idx + 1 < argc)
+      outfile = argv[++idx];
+    else if (argv[idx][0] == '-')
+    {
+      fprintf (stderr, "Unknown option: %s\n", argv[idx]);
+      return 1;
+    }
+    else
+      sdrfile = argv[idx];
+  }
+
+  if (!sdrfile)
+  {
+    usage ();
+    return 1;
+  }
+
+  /* Float encoding is decimated in single precision, as by sdr2mseed */
+  if (encoding == DE_FLOAT32)
+    sampletype = 'f';
+
+  if (fixedpoint && sampletype == 'f')
+  {
+    fprintf (stderr, "Error, fixed-point decimation (-Q) cannot be used with float encoding\n");
+    return 1;
+  }
+
+  if (ratio < 1 || (ratio > 1 && (nfactors = decim_plan (ratio, MAX_STAGES, factors)) < 1))
+  {
+    fprintf (stderr, "Error, invalid decimation ratio: %d\n", ratio);
+    return 1;
+  }
+
+  if (!(ifp = fopen (sdrfile, "rb")))
+  {
+    fprintf (stderr, "Cannot open input file: %s\n", sdrfile);
+    return 1;
+  }
+
+  if (!(ofp = fopen (outfile, "wb")))
+  {
+    fprintf (stderr, "Cannot open output file: %s\n", outfile);
+    return 1;
+  }
+
+  if (!(hblock = (HeaderBlock *)malloc (sizeof (HeaderBlock))))
+  {
+    fprintf (stderr, "Cannot allocate memory\n");
+    return 1;
+  }
+
+  wall = nowsec ();
+
+  /* Read the header block */
+  t0 = nowsec ();
+  if (fread (hblock, sizeof (HeaderBlock), 1, ifp) < 1)
+  {
+    fprintf (stderr, "%s: Cannot read header block\n", sdrfile);
+    return 1;
+  }
+  stages[ST_READ].seconds += nowsec () - t0;
+  stages[ST_READ].bytes += sizeof (HeaderBlock);
+  filebytes += sizeof (HeaderBlock);
+
+  headerversion = hblock->fileVersionFlags & 0xFF;
+
+  if ((headerversion != HDR_VERSION1 && headerversion != HDR_VERSION2) ||
+      hblock->numSamples != hblock->sampleRate * hblock->numChannels ||
+      hblock->numChannels < 1 || hblock->numChannels > MAX_CHANNELS ||
+      hblock->sampleRate < 1 || hblock->sampleRate > MAX_SAMPLE_RATE)
+  {
+    fprintf (stderr, "%s: Unrecognized file type\n", sdrfile);
+    return 1;
+  }
+
+  samprate = hblock->sampleRate;
+
+  i16muxed = (int16_t *)malloc (60 * hblock->numSamples * sizeof (int16_t));
+  i32muxed = (int32_t *)malloc (60 * hblock->numSamples * sizeof (int32_t));
+  cdata    = (int32_t *)malloc (60 * hblock->numSamples * sizeof (int32_t));
+  mstg     = mst_initgroup (NULL);
+  msr      = msr_init (NULL);
+
+  if (!i16muxed || !i32muxed || !cdata || !mstg || !msr)
+  {
+    fprintf (stderr, "Cannot allocate memory\n");
+    return 1;
+  }
+
+  ms_strncpclean (msr->network, "XX", 2);
+  ms_strncpclean (msr->station, "SDR", 5);
+  msr->sampletype = sampletype;
+
+  for (idx = 0; idx < hblock->numBlocks && idx < MAX_FILE_INFO; idx++)
+  {
+    finfo = &(hblock->fileInfo[idx]);
+
+    if (!finfo->startTime && !finfo->filePosition && !finfo->blockSize && !finfo->julian)
+      continue;
+
+    /* Read */
+    t0 = nowsec ();
+
+    if (!datablock || datablocklength < finfo->blockSize)
+    {
+      if (!(datablock = (char *)realloc (datablock, finfo->blockSize)))
+      {
+        fprintf (stderr, "Cannot allocate memory\n");
+        return 1;
+      }
+
+      datablocklength = finfo->blockSize;
+    }
+
+    if (fseek (ifp, finfo->filePosition, SEEK_SET) ||
+        fread (datablock, finfo->blockSize, 1, ifp) < 1)
+    {
+      fprintf (stderr, "%s: Error reading data block %d\n", sdrfile, idx + 1);
+      return 1;
+    }
+
+    stages[ST_READ].seconds += nowsec () - t0;
+    stages[ST_READ].bytes += finfo->blockSize;
+    filebytes += finfo->blockSize;
+
+    iblock = (InfoBlock *)datablock;
+
+    if (iblock->goodID != GOOD_BLK_ID)
+    {
+      fprintf (stderr, "%s: Good ID not found for data block %d\n", sdrfile, idx + 1);
+      continue;
+    }
+
+    /* Decode */
+    t0 = nowsec ();
+
+    if (headerversion == HDR_VERSION1)
+      mssamples = decompressSDR (hblock, iblock, idx + 1, i16muxed, 0);
+    else
+      mssamples = normalizeSDR24 (hblock, iblock, idx + 1, i32muxed, 0);
+
+    stages[ST_DECODE].seconds += nowsec () - t0;
+
+    if (mssamples < 0 || mssamples > 60 * hblock->numSamples)
+    {
+      fprintf (stderr, "%s: Error decoding data block %d\n", sdrfile, idx + 1);
+      return 1;
+    }
+
+    stages[ST_READ].samples += mssamples;
+    stages[ST_DECODE].bytes += finfo->blockSize;
+    stages[ST_DECODE].samples += mssamples;
+
+    ms_hptime2btime (MS_EPOCH2HPTIME (iblock->startTime), &btime);
+    btime.hour = btime.min = btime.sec = 0;
+    btime.fract = 0;
+    blocktime = ms_btime2hptime (&btime) + ((hptime_t)iblock->startTimeTick * (HPTMODULUS / 1000));
+
+    if (numblocks++ == 0)
+      streamstart = blocktime;
+
+    /* Demultiplex */
+    t0 = nowsec ();
+
+    for (cidx = 0; cidx < hblock->numChannels; cidx++)
+    {
+      chandata[cidx] = cdata + (cidx * 60 * hblock->sampleRate);
+
+      for (sidx = 0, midx = cidx; midx < mssamples; sidx++, midx += hblock->numChannels)
+      {
+        if (headerversion == HDR_VERSION1)
+          sample = i16muxed[midx];
+        else
+          sample = i32muxed[midx];
+
+        if (sampletype == 'f')
+          ((float *)chandata[cidx])[sidx] = (float)sample;
+        else
+          ((int32_t *)chandata[cidx])[sidx] = sample;
+      }
+
+      chansamples[cidx] = sidx;
+    }
+
+    stages[ST_DEMUX].seconds += nowsec () - t0;
+    stages[ST_DEMUX].bytes += (int64_t)mssamples * sizeof (int32_t);
+    stages[ST_DEMUX].samples += mssamples;
+
+    /* Decimate */
+    if (nfactors > 0)
+    {
+      t0 = nowsec ();
+
+      for (cidx = 0; cidx < hblock->numChannels; cidx++)
+      {
+        if (decimatechannel (cidx, chandata[cidx], chansamples[cidx], 0))
+          return 1;
+      }
+
+      stages[ST_DECIMATE].seconds += nowsec () - t0;
+      stages[ST_DECIMATE].bytes += (int64_t)mssamples * sizeof (int32_t);
+      stages[ST_DECIMATE].samples += mssamples;
+    }
+
+    /* Pack */
+    t0 = nowsec ();
+
+    for (cidx = 0; cidx < hblock->numChannels; cidx++)
+    {
+      if (nfactors > 0)
+      {
+        if (packchannel (mstg, msr, cidx, work[cidx][nfactors - 1], lastout[cidx]))
+          return 1;
+      }
+      else
+      {
+        msr->starttime = blocktime;
+
+        if (packchannel (mstg, msr, cidx, chandata[cidx], chansamples[cidx]))
+          return 1;
+      }
+    }
+
+    if ((packed = packgroup (mstg, 0)) < 0)
+      return 1;
+
+    stages[ST_PACK].seconds += nowsec () - t0;
+    stages[ST_PACK].bytes += packed * sizeof (int32_t);
+    stages[ST_PACK].samples += packed;
+
+    /* Write */
+    t0 = nowsec ();
+
+    if (records.len > 0 && fwrite (records.data, records.len, 1, ofp) != 1)
+    {
+      fprintf (stderr, "Error writing to output file\n");
+      return 1;
+    }
+
+    stages[ST_WRITE].seconds += nowsec () - t0;
+    stages[ST_WRITE].bytes += records.len;
+    stages[ST_WRITE].samples += packed;
+    records.len = 0;
+  }
+
+  /* Flush decimators */
+  if (nfactors > 0)
+  {
+    t0 = nowsec ();
+
+    for (cidx = 0; cidx < hblock->numChannels; cidx++)
+    {
+      if (decimatechannel (cidx, NULL, 0, 1))
+        return 1;
+    }
+
+    stages[ST_DECIMATE].seconds += nowsec () - t0;
+  }
+
+  /* Flush packing */
+  t0 = nowsec ();
+
+  for (cidx = 0; cidx < hblock->numChannels && nfactors > 0; cidx++)
+  {
+    if (packchannel (mstg, msr, cidx, work[cidx][nfactors - 1], lastout[cidx]))
+      return 1;
+  }
+
+  if ((packed = packgroup (mstg, 1)) < 0)
+    return 1;
+
+  stages[ST_PACK].seconds += nowsec () - t0;
+  stages[ST_PACK].bytes += packed * sizeof (int32_t);
+  stages[ST_PACK].samples += packed;
+
+  /* Write remaining records and close */
+  t0 = nowsec ();
+
+  if (records.len > 0 && fwrite (records.data, records.len, 1, ofp) != 1)
+  {
+    fprintf (stderr, "Error writing to output file\n");
+    return 1;
+  }
+
+  fclose (ofp);
+
+  stages[ST_WRITE].seconds += nowsec () - t0;
+  stages[ST_WRITE].bytes += records.len;
+  stages[ST_WRITE].samples += packed;
+
+  wall = nowsec () - wall;
+
+  fclose (ifp);
+
+  printf ("%s: version %d, %d channel(s) @ %d sps, %d block(s), %lld samples\n",
+          sdrfile, headerversion, hblock->numChannels, hblock->sampleRate,
+          numblocks, (long long int)stages[ST_DECODE].samples);
+  printf ("Decimation ratio: %d, encoding: %d, record length: %d, output: %s\n",
+          ratio, encoding, reclen, outfile);
+
+  report (stages, wall, filebytes);
+
+  for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+  {
+    for (idx = 0; idx < nfactors; idx++)
+    {
+      decim_free (&decim[cidx][idx]);
+      free (work[cidx][idx]);
+    }
+  }
+
+  mst_freegroup (&mstg);
+  msr->datasamples = NULL;
+  msr_free (&msr);
+  free (records.data);
+  free (datablock);
+  free (i16muxed);
+  free (i32muxed);
+  free (cdata);
+  free (hblock);
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * decimatechannel:
+ *
+ * Run a block of channel samples through the decimation stages,
+ * optionally flushing each stage.  The output of the last stage is
+ * left in its work buffer with the sample count in lastout.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+decimatechannel (int cidx, void *input, int nin, int flush)
+{
+  DecimState *ds;
+  void *nodeout;
+  int maxout;
+  int nout;
+  int flushed;
+  int sidx;
+
+  for (sidx = 0; sidx < nfactors; sidx++)
+  {
+    if (!decim[cidx][sidx])
+    {
+      if (fixedpoint)
+        decim[cidx][sidx] = decim_init_fixed (factors[sidx], NULL, -1, -1);
+      else if (sampletype == 'f')
+        decim[cidx][sidx] = decim_init_float (factors[sidx], NULL, -1, -1);
+      else
+        decim[cidx][sidx] = decim_init (factors[sidx], NULL, -1, -1);
+
+      if (!decim[cidx][sidx])
+        return -1;
+    }
+
+    ds = decim[cidx][sidx];
+
+    /* Grow stage output buffer as needed, int32_t and float samples are 4 bytes */
+    maxout = decim_maxoutput (ds, nin);
+
+    if (maxout < 1)
+      maxout = 1;
+
+    if (maxout > worksize[cidx][sidx])
+    {
+      if (!(nodeout = realloc (work[cidx][sidx], maxout * sizeof (int32_t))))
+      {
+        fprintf (stderr, "Cannot allocate memory\n");
+        return -1;
+      }
+
+      work[cidx][sidx]     = nodeout;
+      worksize[cidx][sidx] = maxout;
+    }
+
+    nodeout = work[cidx][sidx];
+
+    if ((nout = decim_process (ds, input, nin, sampletype, nodeout)) < 0)
+      return -1;
+
+    if (flush)
+    {
+      if ((flushed = decim_flush (ds, (int32_t *)nodeout + nout, sampletype)) < 0)
+        return -1;
+
+      nout += flushed;
+    }
+
+    input = nodeout;
+    nin   = nout;
+  }
+
+  lastout[cidx] = nin;
+
+  return 0;
+} /* End of decimatechannel() */
+
+/***************************************************************************
+ * packchannel:
+ *
+ * Add channel samples to the trace group.  Decimated sample times
+ * follow from the first block and the decimated output count.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+packchannel (MSTraceGroup *mstg, MSRecord *msr, int cidx, void *data, int nsamples)
+{
+  char chanstr[4];
+
+  if (nsamples <= 0)
+    return 0;
+
+  snprintf (chanstr, sizeof (chanstr), "%03d", cidx + 1);
+  ms_strncpclean (msr->channel, chanstr, 3);
+
+  msr->samprate = samprate / ratio;
+
+  if (nfactors > 0)
+  {
+    msr->starttime = streamstart +
+                     (hptime_t) ((double)outsamples[cidx] / msr->samprate * HPTMODULUS + 0.5);
+    outsamples[cidx] += nsamples;
+  }
+
+  msr->datasamples = data;
+  msr->samplecnt = msr->numsamples = nsamples;
+
+  if (!mst_addmsrtogroup (mstg, msr, 0, -1.0, -1.0))
+  {
+    fprintf (stderr, "Error adding samples to MSTraceGroup\n");
+    return -1;
+  }
+
+  return 0;
+} /* End of packchannel() */
+
+/***************************************************************************
+ * packgroup:
+ *
+ * Pack the traces of the group into the record buffer, only complete
+ * records unless flushing.
+ *
+ * Returns the number of samples packed on success and -1 on error.
+ ***************************************************************************/
+static int64_t
+packgroup (MSTraceGroup *mstg, flag flush)
+{
+  MSTrace *mst;
+  int64_t trpackedsamples;
+  int64_t packed = 0;
+
+  for (mst = mstg->traces; mst; mst = mst->next)
+  {
+    if (mst->numsamples <= 0)
+      continue;
+
+    trpackedsamples = 0;
+
+    if (mst_pack (mst, &record_handler, &records, reclen, encoding, 1,
+                  &trpackedsamples, flush, 0, NULL) < 0)
+    {
+      fprintf (stderr, "Error packing data\n");
+      return -1;
+    }
+
+    packed += trpackedsamples;
+  }
+
+  return packed;
+} /* End of packgroup() */
+
+/***************************************************************************
+ * record_handler:
+ *
+ * Append a packed record to the record buffer.
+ ***************************************************************************/
+static void
+record_handler (char *record, int reclen, void *handlerdata)
+{
+  struct recbuffer *rb = (struct recbuffer *)handlerdata;
+  char *data;
+  size_t size;
+
+  if (rb->len + reclen > rb->size)
+  {
+    size = (rb->size) ? rb->size * 2 : 65536;
+
+    while (size < rb->len + reclen)
+      size *= 2;
+
+    if (!(data = (char *)realloc (rb->data, size)))
+    {
+      fprintf (stderr, "Cannot allocate memory for records\n");
+      return;
+    }
+
+    rb->data = data;
+    rb->size = size;
+  }
+
+  memcpy (rb->data + rb->len, record, reclen);
+  rb->len += reclen;
+} /* End of record_handler() */
+
+/***************************************************************************
+ * report:
+ *
+ * Print the time and throughput of each stage, the total and the
+ * peak resident set size.
+ ***************************************************************************/
+static void
+report (struct stage *stages, double wall, int64_t filebytes)
+{
+  struct rusage usage;
+  double total = 0.0;
+  long maxrss;
+  int idx;
+
+  printf ("%-10s %10s %12s %14s\n", "stage", "seconds", "MB/s", "samples/s");
+
+  for (idx = 0; idx < ST_COUNT; idx++)
+  {
+    total += stages[idx].seconds;
+
+    if (stages[idx].bytes == 0 || stages[idx].seconds <= 0.0)
+    {
+      printf ("%-10s %10.4f %12s %14s\n", stages[idx].name, stages[idx].seconds, "-", "-");
+      continue;
+    }
+
+    printf ("%-10s %10.4f %12.1f %14.0f\n", stages[idx].name, stages[idx].seconds,
+            stages[idx].bytes / stages[idx].seconds / 1e6,
+            stages[idx].samples / stages[idx].seconds);
+  }
+
+  printf ("%-10s %10.4f %12.1f %14.0f\n", "total", wall,
+          filebytes / wall / 1e6, stages[ST_DECODE].samples / wall);
+  printf ("Stages account for %.1f%% of the total time\n", (wall > 0.0) ? 100.0 * total / wall : 0.0);
+
+  getrusage (RUSAGE_SELF, &usage);
+
+  /* Maximum resident set size is reported in bytes on macOS, kilobytes elsewhere */
+#if defined(__APPLE__)
+  maxrss = usage.ru_maxrss / 1024;
+#else
+  maxrss = usage.ru_maxrss;
+#endif
+
+  printf ("Peak RSS: %ld KB\n", maxrss);
+} /* End of report() */
+
+/***************************************************************************
+ * nowsec:
+ *
+ * Returns the monotonic clock time in seconds.
+ ***************************************************************************/
+static double
+nowsec (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+} /* End of nowsec() */
+
+/***************************************************************************
+ * usage:
+ *
+ * Print the usage message.
+ ***************************************************************************/
+static void
+usage (void)
+{
+  fprintf (stderr, "Per-stage throughput benchmark of SDR to Mini-SEED conversion\n\n");
+  fprintf (stderr, "Usage: sdrbench [options] file\n\n"
+                   " -D ratio        Decimate by ratio, default: 1 (no decimation)\n"
+                   " -Q              Decimate using fixed-point integer arithmetic\n"
+                   " -e encoding     SEED encoding format for packing, default: 11 (Steim2)\n"
+                   "                   encoding 4 (floats) decimates in single precision\n"
+                   " -r bytes        Record length in bytes for packing, default: 4096\n"
+                   " -o outfile      Output file, default: sdrbench.mseed\n"
+                   "\n");
+} /* End of usage() */
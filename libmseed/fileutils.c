@@ -953,6 +953,233 @@ ms_readtracelist_selection (MSTraceList **ppmstl, const char *msfile,
   return retcode;
 } /* End of ms_readtracelist_selection() */
 
+/*********************************************************************
+ * msr_writeindex:
+ *
+ * Write the index entry of a record to a file, a line with the source
+ * name, start and end times, byte offset of the record in its file
+ * and record length:
+ *
+ * NET_STA_LOC_CHAN_QUAL START END OFFSET RECLEN
+ *
+ * Times are ISO formatted with microseconds.  The record header must
+ * be unpacked, e.g. with msr_unpack(), the data samples are not used.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+msr_writeindex (FILE *ofp, MSRecord *msr, int64_t offset)
+{
+  char srcname[50];
+  char stime[30];
+  char etime[30];
+
+  if (!ofp || !msr)
+    return -1;
+
+  msr_srcname (msr, srcname, 1);
+  ms_hptime2isotimestr (msr->starttime, stime, 1);
+  ms_hptime2isotimestr (msr_endtime (msr), etime, 1);
+
+  if (fprintf (ofp, "%s %s %s %lld %d\n", srcname, stime, etime,
+               (long long int)offset, msr->reclen) < 0)
+    return -1;
+
+  return 0;
+} /* End of msr_writeindex() */
+
+/*********************************************************************
+ * ms_readindex:
+ *
+ * Read a record index as written by msr_writeindex().  Empty lines
+ * and lines starting with '#' are skipped.
+ *
+ * Returns the number of entries and sets *ppindex to a newly
+ * allocated array of them, which the caller must free, or returns -1
+ * on error.
+ *********************************************************************/
+int
+ms_readindex (MSRecordIndex **ppindex, const char *indexfile, flag verbose)
+{
+  MSRecordIndex *index = NULL;
+  MSRecordIndex *newindex;
+  FILE *ifp;
+  char line[200];
+  char stime[50];
+  char etime[50];
+  long long int offset;
+  int maxcount = 0;
+  int count    = 0;
+  int lineno   = 0;
+
+  if (!ppindex || !indexfile)
+    return -1;
+
+  if ((ifp = fopen (indexfile, "rb")) == NULL)
+  {
+    ms_log (2, "Cannot open index file: %s (%s)\n", indexfile, strerror (errno));
+    return -1;
+  }
+
+  while (fgets (line, sizeof (line), ifp))
+  {
+    lineno++;
+
+    if (*line == '#' || *line == '\n' || *line == '\r')
+      continue;
+
+    if (count == maxcount)
+    {
+      maxcount = (maxcount) ? maxcount * 2 : 256;
+
+      if ((newindex = (MSRecordIndex *)realloc (index, maxcount * sizeof (MSRecordIndex))) == NULL)
+      {
+        ms_log (2, "ms_readindex(): Cannot allocate memory\n");
+        break;
+      }
+
+      index = newindex;
+    }
+
+    if (sscanf (line, "%49s %49s %49s %lld %d", index[count].srcname, stime, etime,
+                &offset, &index[count].reclen) != 5 ||
+        offset < 0 || index[count].reclen <= 0 ||
+        (index[count].starttime = ms_timestr2hptime (stime)) == HPTERROR ||
+        (index[count].endtime = ms_timestr2hptime (etime)) == HPTERROR)
+    {
+      ms_log (2, "%s: Invalid index entry on line %d\n", indexfile, lineno);
+      break;
+    }
+
+    index[count++].offset = offset;
+  }
+
+  if (!feof (ifp))
+  {
+    fclose (ifp);
+    free (index);
+    return -1;
+  }
+
+  fclose (ifp);
+
+  if (verbose)
+    ms_log (1, "Read %d index entries from %s\n", count, indexfile);
+
+  *ppindex = index;
+
+  return count;
+} /* End of ms_readindex() */
+
+/*********************************************************************
+ * ms_readtraces_indexed:
+ *
+ * Read the Mini-SEED records of a file listed in its record index
+ * and populate a trace group.  Only the records of index entries
+ * matching the Selections list, if supplied, are read: the file is
+ * positioned at each of them directly instead of being scanned.
+ *
+ * If indexfile is NULL the index is read from the file name with an
+ * .idx suffix added.
+ *
+ * Returns MS_NOERROR and populates an MSTraceGroup struct at *ppmstg
+ * on successful read, otherwise returns a libmseed error code (listed
+ * in libmseed.h).
+ *********************************************************************/
+int
+ms_readtraces_indexed (MSTraceGroup **ppmstg, const char *msfile,
+                       const char *indexfile, double timetol, double sampratetol,
+                       Selections *selections, flag dataquality,
+                       flag dataflag, flag verbose)
+{
+  MSRecordIndex *index = NULL;
+  MSRecord *msr        = NULL;
+  char *record         = NULL;
+  char *newrecord;
+  char idxpath[1024];
+  FILE *ifp;
+  int recsize = 0;
+  int count;
+  int idx;
+  int retcode = MS_NOERROR;
+
+  if (!ppmstg || !msfile)
+    return MS_GENERROR;
+
+  /* Initialize MSTraceGroup if needed */
+  if (!*ppmstg)
+  {
+    *ppmstg = mst_initgroup (*ppmstg);
+
+    if (!*ppmstg)
+      return MS_GENERROR;
+  }
+
+  if (!indexfile)
+  {
+    snprintf (idxpath, sizeof (idxpath), "%s.idx", msfile);
+    indexfile = idxpath;
+  }
+
+  if ((count = ms_readindex (&index, indexfile, verbose)) < 0)
+    return MS_GENERROR;
+
+  if ((ifp = fopen (msfile, "rb")) == NULL)
+  {
+    ms_log (2, "Cannot open file: %s (%s)\n", msfile, strerror (errno));
+    free (index);
+    return MS_GENERROR;
+  }
+
+  for (idx = 0; idx < count; idx++)
+  {
+    /* Test against selections if supplied */
+    if (selections &&
+        ms_matchselect (selections, index[idx].srcname, index[idx].starttime,
+                        index[idx].endtime, NULL) == NULL)
+      continue;
+
+    if (index[idx].reclen > recsize)
+    {
+      if ((newrecord = (char *)realloc (record, index[idx].reclen)) == NULL)
+      {
+        ms_log (2, "ms_readtraces_indexed(): Cannot allocate memory\n");
+        retcode = MS_GENERROR;
+        break;
+      }
+
+      record  = newrecord;
+      recsize = index[idx].reclen;
+    }
+
+    if (lmp_fseeko (ifp, (off_t)index[idx].offset, SEEK_SET) ||
+        ms_fread (record, 1, index[idx].reclen, ifp) != index[idx].reclen)
+    {
+      ms_log (2, "%s: Cannot read record at offset %lld\n", msfile,
+              (long long int)index[idx].offset);
+      retcode = MS_GENERROR;
+      break;
+    }
+
+    if ((retcode = msr_unpack (record, index[idx].reclen, &msr, dataflag, verbose)) != MS_NOERROR)
+    {
+      ms_log (2, "%s: Cannot unpack record at offset %lld: %s\n", msfile,
+              (long long int)index[idx].offset, ms_errorstr (retcode));
+      break;
+    }
+
+    /* Add to trace group */
+    mst_addmsrtogroup (*ppmstg, msr, dataquality, timetol, sampratetol);
+  }
+
+  fclose (ifp);
+  free (record);
+  free (index);
+  msr_free (&msr);
+
+  return retcode;
+} /* End of ms_readtraces_indexed() */
+
 /*********************************************************************
  * ms_fread:
  *
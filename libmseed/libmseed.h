@@ -641,6 +641,22 @@ extern int      ms_readtracelist_timewin (MSTraceList **ppmstl, const char *msfi
 extern int      ms_readtracelist_selection (MSTraceList **ppmstl, const char *msfile, int reclen, double timetol, double sampratetol,
 					    Selections *selections, flag dataquality, flag skipnotdata, flag dataflag, flag verbose);
 
+/* Record index entry of a Mini-SEED file, see msr_writeindex() */
+typedef struct MSRecordIndex_s
+{
+  char     srcname[50];      /* Source name, NET_STA_LOC_CHAN_QUAL */
+  hptime_t starttime;        /* Time of first sample */
+  hptime_t endtime;          /* Time of last sample */
+  int64_t  offset;           /* Byte offset of the record in the file */
+  int      reclen;           /* Record length in bytes */
+} MSRecordIndex;
+
+extern int      msr_writeindex (FILE *ofp, MSRecord *msr, int64_t offset);
+extern int      ms_readindex (MSRecordIndex **ppindex, const char *indexfile, flag verbose);
+extern int      ms_readtraces_indexed (MSTraceGroup **ppmstg, const char *msfile, const char *indexfile,
+				       double timetol, double sampratetol, Selections *selections,
+				       flag dataquality, flag dataflag, flag verbose);
+
 extern int      msr_writemseed ( MSRecord *msr, const char *msfile, flag overwrite, int reclen,
 				 flag encoding, flag byteorder, flag verbose );
 extern int      mst_writemseed ( MSTrace *mst, const char *msfile, flag overwrite, int reclen,
@@ -0,0 +1,193 @@
+/***************************************************************************
+ * lmtestindex.c
+ *
+ * A program for libmseed record index tests.
+ *
+ * Writes the record index of a file to stdout or, with -i, reads the
+ * records of a file listed in an index, optionally limited to a time
+ * window, and prints the trace list.
+ *
+ * modified 2026.292
+ ***************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libmseed.h>
+
+#define PACKAGE "lmtestindex"
+#define VERSION "[libmseed " LIBMSEED_VERSION " " PACKAGE " ]"
+
+static flag verbose       = 0;
+static char *indexfile    = 0;
+static char *inputfile    = 0;
+static hptime_t starttime = HPTERROR;
+static hptime_t endtime   = HPTERROR;
+
+static int parameter_proc (int argcount, char **argvec);
+static void print_stderr (char *message);
+static void usage (void);
+
+/* Binary I/O for Windows platforms */
+#ifdef LMP_WIN
+  unsigned int _CRT_fmode = _O_BINARY;
+#endif
+
+int
+main (int argc, char **argv)
+{
+  MSTraceGroup *mstg     = 0;
+  MSRecord *msr          = 0;
+  Selections *selections = 0;
+  off_t fpos;
+  int retcode;
+
+  /* Redirect libmseed logging facility to stderr for consistency */
+  ms_loginit (print_stderr, NULL, print_stderr, NULL);
+
+  /* Process given parameters (command line and parameter file) */
+  if (parameter_proc (argc, argv) < 0)
+    return -1;
+
+  /* Write the index of each record */
+  if (!indexfile)
+  {
+    while ((retcode = ms_readmsr (&msr, inputfile, -1, &fpos, NULL, 1,
+                                  0, verbose)) == MS_NOERROR)
+    {
+      msr_writeindex (stdout, msr, fpos);
+    }
+
+    if (retcode != MS_ENDOFFILE)
+      ms_log (2, "Cannot read %s: %s\n", inputfile, ms_errorstr (retcode));
+
+    ms_readmsr (&msr, NULL, 0, NULL, NULL, 0, 0, 0);
+
+    return 0;
+  }
+
+  /* Read the records in the time window */
+  if ((starttime != HPTERROR || endtime != HPTERROR) &&
+      ms_addselect (&selections, "*", starttime, endtime))
+    return -1;
+
+  if ((retcode = ms_readtraces_indexed (&mstg, inputfile, indexfile, -1.0, -1.0,
+                                        selections, 0, 1, verbose)) != MS_NOERROR)
+    ms_log (2, "Cannot read %s: %s\n", inputfile, ms_errorstr (retcode));
+
+  mst_printtracelist (mstg, 0, 1, 1);
+
+  mst_freegroup (&mstg);
+  ms_freeselections (selections);
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * parameter_proc():
+ * Process the command line parameters.
+ *
+ * Returns 0 on success, and -1 on failure
+ ***************************************************************************/
+static int
+parameter_proc (int argcount, char **argvec)
+{
+  int optind;
+
+  /* Process all command line arguments */
+  for (optind = 1; optind < argcount; optind++)
+  {
+    if (strcmp (argvec[optind], "-V") == 0)
+    {
+      ms_log (1, "%s version: %s\n", PACKAGE, VERSION);
+      exit (0);
+    }
+    else if (strcmp (argvec[optind], "-h") == 0)
+    {
+      usage ();
+      exit (0);
+    }
+    else if (strncmp (argvec[optind], "-v", 2) == 0)
+    {
+      verbose += strspn (&argvec[optind][1], "v");
+    }
+    else if (strcmp (argvec[optind], "-i") == 0 && optind + 1 < argcount)
+    {
+      indexfile = argvec[++optind];
+    }
+    else if (strcmp (argvec[optind], "-ts") == 0 && optind + 1 < argcount)
+    {
+      starttime = ms_seedtimestr2hptime (argvec[++optind]);
+    }
+    else if (strcmp (argvec[optind], "-te") == 0 && optind + 1 < argcount)
+    {
+      endtime = ms_seedtimestr2hptime (argvec[++optind]);
+    }
+    else if (strncmp (argvec[optind], "-", 1) == 0 &&
+             strlen (argvec[optind]) > 1)
+    {
+      ms_log (2, "Unknown option: %s\n", argvec[optind]);
+      exit (1);
+    }
+    else if (inputfile == 0)
+    {
+      inputfile = argvec[optind];
+    }
+    else
+    {
+      ms_log (2, "Unknown option: %s\n", argvec[optind]);
+      exit (1);
+    }
+  }
+
+  /* Make sure an inputfile was specified */
+  if (!inputfile)
+  {
+    ms_log (2, "No input file was specified\n\n");
+    ms_log (1, "%s version %s\n\n", PACKAGE, VERSION);
+    ms_log (1, "Try %s -h for usage\n", PACKAGE);
+    exit (1);
+  }
+
+  /* Report the program version */
+  if (verbose)
+    ms_log (1, "%s version: %s\n", PACKAGE, VERSION);
+
+  return 0;
+} /* End of parameter_proc() */
+
+/***************************************************************************
+ * print_stderr():
+ * Print messsage to stderr.
+ ***************************************************************************/
+static void
+print_stderr (char *message)
+{
+  fprintf (stderr, "%s", message);
+} /* End of print_stderr() */
+
+/***************************************************************************
+ * usage():
+ * Print the usage message and exit.
+ ***************************************************************************/
+static void
+usage (void)
+{
+  fprintf (stderr, "%s version: %s\n\n", PACKAGE, VERSION);
+  fprintf (stderr, "Usage: %s [options] file\n\n", PACKAGE);
+  fprintf (stderr,
+           " ## Options ##\n"
+           " -V             Report program version\n"
+           " -h             Show this usage message\n"
+           " -v             Be more verbose, multiple flags can be used\n"
+           " -i indexfile   Read the records listed in a record index\n"
+           " -ts time       Read records with samples after time, YYYY,DDD,HH:MM:SS\n"
+           " -te time       Read records with samples before time, YYYY,DDD,HH:MM:SS\n"
+           "\n"
+           " file           File of Mini-SEED records, the record index is written\n"
+           "                  to stdout unless -i is given\n"
+           "\n");
+} /* End of usage() */
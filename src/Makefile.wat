@@ -17,11 +17,25 @@ INCS = -I..\libmseed
 
 all: $(BIN)
 
-$(BIN):	decimate.obj sdr2mseed.obj
-	wlink $(lflags) name $(BIN) file {decimate.obj sdr2mseed.obj}
+$(BIN):	asyncio.obj decimate.obj fft.obj pipeline.obj tpool.obj sdrdecode.obj sdrindex.obj stats.obj recwriter.obj checkpoint.obj journal.obj watch.obj archive.obj dlclient.obj fnv.obj sdr2mseed.obj
+	wlink $(lflags) name $(BIN) file {asyncio.obj decimate.obj fft.obj pipeline.obj tpool.obj sdrdecode.obj sdrindex.obj stats.obj recwriter.obj checkpoint.obj journal.obj watch.obj archive.obj dlclient.obj fnv.obj sdr2mseed.obj}
 
 # Source dependencies:
+asyncio.obj:	asyncio.h asyncio.c
 decimate.obj:	decimate.h decimate.c
+fft.obj:	fft.h fft.c
+pipeline.obj:	pipeline.h stats.h pipeline.c
+tpool.obj:	tpool.h tpool.c
+sdrdecode.obj:	sdrdecode.h sdrformat.h sdrdecode.c
+sdrindex.obj:	sdrindex.h sdrindex.c
+stats.obj:	stats.h stats.c
+recwriter.obj:	recwriter.h asyncio.h recwriter.c
+checkpoint.obj:	checkpoint.h checkpoint.c
+journal.obj:	journal.h fnv.h journal.c
+watch.obj:	watch.h watch.c
+archive.obj:	archive.h fnv.h recwriter.h archive.c
+dlclient.obj:	dlclient.h dlclient.c
+fnv.obj:	fnv.h fnv.c
 sdr2mseed.obj:	sdr2mseed.c
 
 # How to compile sources:
@@ -0,0 +1,325 @@
+/*********************************************************************
+ * archive.c
+ *
+ * Archive of records in day files.
+ *
+ * Each record is written to the file of its stream and the day of
+ * its start time in an SDS or BUD directory layout:
+ *
+ *   SDS: <root>/YEAR/NET/STA/CHAN.D/NET.STA.LOC.CHAN.D.YEAR.DAY
+ *   BUD: <root>/NET/STA/STA.NET.LOC.CHAN.YEAR.DAY
+ *
+ * Records are appended to existing day files, directories are
+ * created as needed.  Day files are kept open in a cache of at most
+ * maxopen files, each with a RecWriter buffer, and the least recently
+ * written file is closed when another one is opened.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <direct.h>
+#define mkdir(path, mode) _mkdir (path)
+#endif
+
+#include <libmseed.h>
+
+#include "archive.h"
+#include "fnv.h"
+#include "recwriter.h"
+
+/* Number of hash buckets of open files */
+#define ARCHIVE_BUCKETS 1024
+
+/* Open day file */
+struct dayfile
+{
+  char *path;             /* Day file path */
+  RecWriter *rw;          /* Writer appending to the file */
+  struct dayfile *prev;   /* More recently written file */
+  struct dayfile *next;   /* Less recently written file */
+  struct dayfile *hnext;  /* Next file in the bucket */
+};
+
+struct Archive_s
+{
+  int layout;                               /* ARCHIVE_* layout */
+  char *root;                               /* Archive root directory */
+  int maxopen;                              /* Maximum open files */
+  int nopen;                                /* Open files */
+  size_t bufsize;                           /* Buffer size of each file */
+  MSRecord *msr;                            /* Unpacked record header */
+  struct dayfile *first;                    /* Most recently written file */
+  struct dayfile *last;                     /* Least recently written file */
+  struct dayfile *buckets[ARCHIVE_BUCKETS]; /* Open files by path hash */
+};
+
+static struct dayfile *opendayfile (Archive *archive, const char *path, int *evictrv);
+static int closedayfile (Archive *archive, struct dayfile *file);
+static int makedirs (char *path);
+
+/*********************************************************************
+ * archive_open:
+ *
+ * Open an archive of the layout under the root directory, keeping at
+ * most maxopen day files open with bufsize bytes buffered for each.
+ *
+ * Returns a new Archive on success and NULL on error.
+ *********************************************************************/
+Archive *
+archive_open (int layout, const char *root, int maxopen, size_t bufsize)
+{
+  Archive *archive;
+
+  if (layout != ARCHIVE_SDS && layout != ARCHIVE_BUD)
+    return NULL;
+
+  if (!(archive = (Archive *)calloc (1, sizeof (Archive))) ||
+      !(archive->root = strdup (root)))
+  {
+    fprintf (stderr, "archive_open(): Cannot allocate memory\n");
+    free (archive);
+    return NULL;
+  }
+
+  archive->layout  = layout;
+  archive->maxopen = (maxopen > 0) ? maxopen : ARCHIVE_DEFAULTOPEN;
+  archive->bufsize = bufsize;
+
+  return archive;
+} /* End of archive_open() */
+
+/*********************************************************************
+ * archive_write:
+ *
+ * Write a record to its day file, opening the file if needed.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+archive_write (Archive *archive, const char *record, int reclen)
+{
+  struct dayfile *file;
+  BTime btime;
+  char path[1024];
+  int evictrv = 0;
+  int retcode;
+
+  if ((retcode = msr_unpack ((char *)record, reclen, &archive->msr, 0, 0)) != MS_NOERROR)
+  {
+    fprintf (stderr, "Cannot archive record: %s\n", ms_errorstr (retcode));
+    return -1;
+  }
+
+  ms_hptime2btime (archive->msr->starttime, &btime);
+
+  if (archive->layout == ARCHIVE_SDS)
+    snprintf (path, sizeof (path), "%s/%04d/%s/%s/%s.D/%s.%s.%s.%s.D.%04d.%03d",
+              archive->root, btime.year, archive->msr->network, archive->msr->station,
+              archive->msr->channel, archive->msr->network, archive->msr->station,
+              archive->msr->location, archive->msr->channel, btime.year, btime.day);
+  else
+    snprintf (path, sizeof (path), "%s/%s/%s/%s.%s.%s.%s.%04d.%03d",
+              archive->root, archive->msr->network, archive->msr->station,
+              archive->msr->station, archive->msr->network, archive->msr->location,
+              archive->msr->channel, btime.year, btime.day);
+
+  if (!(file = opendayfile (archive, path, &evictrv)))
+    return -1;
+
+  /* Errors are reported by the writers, also of a closed evicted file */
+  if (recwriter_write (file->rw, record, reclen) || evictrv)
+    return -1;
+
+  return 0;
+} /* End of archive_write() */
+
+/*********************************************************************
+ * archive_close:
+ *
+ * Write the buffered records, close all day files and free the
+ * archive.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+archive_close (Archive **parchive)
+{
+  int rv = 0;
+
+  if (!parchive || !*parchive)
+    return -1;
+
+  while ((*parchive)->first)
+  {
+    if (closedayfile (*parchive, (*parchive)->first))
+      rv = -1;
+  }
+
+  msr_free (&(*parchive)->msr);
+  free ((*parchive)->root);
+  free (*parchive);
+  *parchive = NULL;
+
+  return rv;
+} /* End of archive_close() */
+
+/*********************************************************************
+ * opendayfile:
+ *
+ * Find an open day file, or open it closing the least recently
+ * written file if maxopen files are open, and make it the most
+ * recently written file.  If writing the buffered records of the
+ * closed file fails evictrv is set to -1.
+ *
+ * Returns the day file on success and NULL on error.
+ *********************************************************************/
+static struct dayfile *
+opendayfile (Archive *archive, const char *path, int *evictrv)
+{
+  struct dayfile *file;
+  unsigned int bucket = fnv_hashstr (path) % ARCHIVE_BUCKETS;
+
+  for (file = archive->buckets[bucket]; file; file = file->hnext)
+  {
+    if (!strcmp (file->path, path))
+      break;
+  }
+
+  if (file)
+  {
+    if (file == archive->first)
+      return file;
+
+    /* Unlink from the recently written list */
+    file->prev->next = file->next;
+    if (file->next)
+      file->next->prev = file->prev;
+    else
+      archive->last = file->prev;
+  }
+  else
+  {
+    if (archive->nopen >= archive->maxopen && closedayfile (archive, archive->last))
+      *evictrv = -1;
+
+    if (!(file = (struct dayfile *)calloc (1, sizeof (struct dayfile))) ||
+        !(file->path = strdup (path)))
+    {
+      fprintf (stderr, "opendayfile(): Cannot allocate memory\n");
+      free (file);
+      return NULL;
+    }
+
+    if (makedirs (file->path))
+      fprintf (stderr, "Cannot create directories of %s (%s)\n", path, strerror (errno));
+
+    /* Errors are reported by the writer */
+    if (!(file->rw = recwriter_append (file->path, RECWRITER_END, archive->bufsize, NULL)))
+    {
+      free (file->path);
+      free (file);
+      return NULL;
+    }
+
+    file->hnext              = archive->buckets[bucket];
+    archive->buckets[bucket] = file;
+    archive->nopen++;
+  }
+
+  /* Link as the most recently written file */
+  file->prev = NULL;
+  file->next = archive->first;
+  if (archive->first)
+    archive->first->prev = file;
+  else
+    archive->last = file;
+  archive->first = file;
+
+  return file;
+} /* End of opendayfile() */
+
+/*********************************************************************
+ * closedayfile:
+ *
+ * Write the buffered records and close an open day file.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+closedayfile (Archive *archive, struct dayfile *file)
+{
+  struct dayfile **plink;
+  int rv;
+
+  plink = &archive->buckets[fnv_hashstr (file->path) % ARCHIVE_BUCKETS];
+  while (*plink != file)
+    plink = &(*plink)->hnext;
+  *plink = file->hnext;
+
+  if (file->prev)
+    file->prev->next = file->next;
+  else
+    archive->first = file->next;
+
+  if (file->next)
+    file->next->prev = file->prev;
+  else
+    archive->last = file->prev;
+
+  rv = recwriter_close (&file->rw);
+
+  archive->nopen--;
+  free (file->path);
+  free (file);
+
+  return rv;
+} /* End of closedayfile() */
+
+/*********************************************************************
+ * makedirs:
+ *
+ * Create the missing parent directories of a file path, the path is
+ * modified temporarily.
+ *
+ * Returns 0 on success and -1 on error with errno set.
+ *********************************************************************/
+static int
+makedirs (char *path)
+{
+  struct stat st;
+  char *sep;
+
+  /* Usually the directory of the file exists */
+  if ((sep = strrchr (path, '/')) && sep != path)
+  {
+    *sep = '\0';
+    if (!stat (path, &st))
+    {
+      *sep = '/';
+      return 0;
+    }
+    *sep = '/';
+  }
+
+  for (sep = strchr (path + 1, '/'); sep; sep = strchr (sep + 1, '/'))
+  {
+    *sep = '\0';
+
+    if (mkdir (path, 0777) && errno != EEXIST)
+    {
+      *sep = '/';
+      return -1;
+    }
+
+    *sep = '/';
+  }
+
+  return 0;
+} /* End of makedirs() */
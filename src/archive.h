@@ -0,0 +1,32 @@
+/* Archive of records in day files with a cache of open files */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H 1
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Archive layouts */
+#define ARCHIVE_SDS 1 /* SeisComP Data Structure */
+#define ARCHIVE_BUD 2 /* IRIS Buffer of Uniform Data */
+
+/* Default maximum number of day files kept open */
+#define ARCHIVE_DEFAULTOPEN 64
+
+/* Bytes gathered for each open day file before writing */
+#define ARCHIVE_BUFSIZE (64 * 1024)
+
+typedef struct Archive_s Archive;
+
+Archive *archive_open (int layout, const char *root, int maxopen, size_t bufsize);
+int archive_write (Archive *archive, const char *record, int reclen);
+int archive_close (Archive **parchive);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARCHIVE_H */
@@ -0,0 +1,815 @@
+/*********************************************************************
+ * asyncio.c
+ *
+ * Asynchronous file reads and writes.
+ *
+ * Requests are queued with asyncio_read() and asyncio_write() and
+ * complete while the caller continues with other work, the caller
+ * waits for each request with asyncio_wait() before using or reusing
+ * its buffer.  Requests are submitted and waited for by one thread.
+ *
+ * asyncio_willneed() queues posix_fadvise(POSIX_FADV_WILLNEED) for a
+ * file range, starting kernel read-ahead of a file that will be read
+ * later without blocking the caller.
+ *
+ * Three backends are available:
+ *
+ * io_uring: Linux 5.6 and later, submitted with the raw system calls
+ * so no library is needed.  Used by default when the kernel supports
+ * it and it is not blocked, e.g. by a seccomp profile.
+ *
+ * threads: I/O threads running pread(), write() and posix_fadvise(),
+ * used when io_uring is not available and on older kernels.
+ *
+ * sync: blocking I/O when a request is queued, used on platforms
+ * without POSIX threads.
+ *
+ * Transfers completing short, other than reads at the end of a file,
+ * are completed by the waiting thread.  Requests with an offset of -1
+ * read or write at the current file position, only one such request
+ * should be in flight for a file.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#define ASYNCIO_WIN32 1
+#include <io.h>
+#include <sys/stat.h>
+#else
+#define ASYNCIO_PTHREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define ASYNCIO_IOURING 1
+#endif
+#endif
+#endif
+
+#include "asyncio.h"
+
+/* Number of I/O threads of the thread backend */
+#define ASYNCIO_THREADCOUNT 2
+
+#ifdef ASYNCIO_IOURING
+/* Mapped submission and completion rings */
+struct uring
+{
+  int fd;                    /* Ring file descriptor */
+  unsigned entries;          /* Submission ring entries */
+  unsigned *sqhead;          /* Submission ring head, kernel owned */
+  unsigned *sqtail;          /* Submission ring tail */
+  unsigned *sqmask;          /* Submission ring index mask */
+  unsigned *sqarray;         /* Submission ring entry indexes */
+  struct io_uring_sqe *sqes; /* Submission queue entries */
+  unsigned *cqhead;          /* Completion ring head */
+  unsigned *cqtail;          /* Completion ring tail, kernel owned */
+  unsigned *cqmask;          /* Completion ring index mask */
+  struct io_uring_cqe *cqes; /* Completion queue entries */
+  void *sqring;              /* Mapping of the submission ring */
+  size_t sqringsize;
+  void *cqring;              /* Mapping of the completion ring */
+  size_t cqringsize;
+  size_t sqessize;           /* Mapping size of the queue entries */
+};
+#endif
+
+struct AsyncIO_s
+{
+  int backend;            /* Backend in use */
+  int depth;              /* Maximum number of requests in flight */
+  int inflight;           /* Requests submitted and not reaped */
+#ifdef ASYNCIO_IOURING
+  struct uring ring;      /* io_uring rings */
+#endif
+#ifdef ASYNCIO_PTHREADS
+  pthread_t threads[ASYNCIO_THREADCOUNT]; /* I/O threads */
+  int nthreads;           /* Number of started I/O threads */
+  pthread_mutex_t lock;   /* Protects the queue and request completion */
+  pthread_cond_t queued;  /* Signaled when a request is queued */
+  pthread_cond_t done;    /* Signaled when a request completes */
+  AsyncIOReq *head;       /* First queued request */
+  AsyncIOReq *tail;       /* Last queued request */
+  int shutdown;           /* Flag for I/O threads to exit */
+#endif
+};
+
+static int submit (AsyncIO *aio, AsyncIOReq *req);
+static long transfer (AsyncIOReq *req, size_t count);
+
+#ifdef ASYNCIO_IOURING
+/*********************************************************************
+ * uring_setup:
+ *
+ * Create an io_uring instance and map its rings.  Kernels without
+ * reads and writes at the current file position (before 5.6) are
+ * not used.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+uring_setup (struct uring *ring, unsigned entries)
+{
+  struct io_uring_params params;
+  int single;
+
+  memset (ring, 0, sizeof (struct uring));
+  memset (&params, 0, sizeof (params));
+
+  if ((ring->fd = (int)syscall (__NR_io_uring_setup, entries, &params)) < 0)
+    return -1;
+
+  if (!(params.features & IORING_FEAT_RW_CUR_POS))
+  {
+    close (ring->fd);
+    return -1;
+  }
+
+  ring->entries    = params.sq_entries;
+  ring->sqringsize = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+  ring->cqringsize = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+  ring->sqessize   = params.sq_entries * sizeof (struct io_uring_sqe);
+
+  /* Both rings share a mapping on 5.4 and later */
+  single = (params.features & IORING_FEAT_SINGLE_MMAP) ? 1 : 0;
+
+  if (single)
+  {
+    if (ring->cqringsize > ring->sqringsize)
+      ring->sqringsize = ring->cqringsize;
+    ring->cqringsize = ring->sqringsize;
+  }
+
+  ring->sqring = mmap (NULL, ring->sqringsize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+  if (ring->sqring == MAP_FAILED)
+  {
+    close (ring->fd);
+    return -1;
+  }
+
+  if (single)
+    ring->cqring = ring->sqring;
+  else
+    ring->cqring = mmap (NULL, ring->cqringsize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+
+  ring->sqes = (struct io_uring_sqe *)mmap (NULL, ring->sqessize, PROT_READ | PROT_WRITE,
+                                            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+
+  if (ring->cqring == MAP_FAILED || ring->sqes == MAP_FAILED)
+  {
+    if (ring->sqes != MAP_FAILED)
+      munmap (ring->sqes, ring->sqessize);
+    if (!single && ring->cqring != MAP_FAILED)
+      munmap (ring->cqring, ring->cqringsize);
+    munmap (ring->sqring, ring->sqringsize);
+    close (ring->fd);
+    return -1;
+  }
+
+  ring->sqhead  = (unsigned *)((char *)ring->sqring + params.sq_off.head);
+  ring->sqtail  = (unsigned *)((char *)ring->sqring + params.sq_off.tail);
+  ring->sqmask  = (unsigned *)((char *)ring->sqring + params.sq_off.ring_mask);
+  ring->sqarray = (unsigned *)((char *)ring->sqring + params.sq_off.array);
+  ring->cqhead  = (unsigned *)((char *)ring->cqring + params.cq_off.head);
+  ring->cqtail  = (unsigned *)((char *)ring->cqring + params.cq_off.tail);
+  ring->cqmask  = (unsigned *)((char *)ring->cqring + params.cq_off.ring_mask);
+  ring->cqes    = (struct io_uring_cqe *)((char *)ring->cqring + params.cq_off.cqes);
+
+  return 0;
+} /* End of uring_setup() */
+
+/*********************************************************************
+ * uring_enter:
+ *
+ * Submit queued entries and optionally wait for a completion,
+ * retrying when interrupted.
+ *
+ * Returns 0 on success and -errno on error.
+ *********************************************************************/
+static int
+uring_enter (struct uring *ring, unsigned tosubmit, unsigned wait)
+{
+  while (syscall (__NR_io_uring_enter, ring->fd, tosubmit, wait,
+                  (wait) ? IORING_ENTER_GETEVENTS : 0, NULL, 0) < 0)
+  {
+    if (errno != EINTR)
+      return -errno;
+  }
+
+  return 0;
+} /* End of uring_enter() */
+
+/*********************************************************************
+ * uring_submit:
+ *
+ * Add a request to the submission ring and submit it.
+ *
+ * Returns 0 on success and -errno on error.
+ *********************************************************************/
+static int
+uring_submit (struct uring *ring, AsyncIOReq *req)
+{
+  struct io_uring_sqe *sqe;
+  unsigned tail;
+  unsigned index;
+
+  tail  = *ring->sqtail;
+  index = tail & *ring->sqmask;
+  sqe   = &ring->sqes[index];
+
+  memset (sqe, 0, sizeof (struct io_uring_sqe));
+  if (req->op == ASYNCIO_OPWILLNEED)
+  {
+    sqe->opcode         = IORING_OP_FADVISE;
+    sqe->fadvise_advice = POSIX_FADV_WILLNEED;
+  }
+  else
+  {
+    sqe->opcode = (req->op == ASYNCIO_OPWRITE) ? IORING_OP_WRITE : IORING_OP_READ;
+  }
+
+  sqe->fd        = req->fd;
+  sqe->addr      = (uint64_t)(uintptr_t)req->buf;
+  sqe->len       = (req->len > (1U << 30)) ? (1U << 30) : (unsigned)req->len;
+  sqe->off       = (uint64_t)req->offset;
+  sqe->user_data = (uint64_t)(uintptr_t)req;
+
+  ring->sqarray[index] = index;
+
+  /* Publish the entry before the tail */
+  __atomic_store_n (ring->sqtail, tail + 1, __ATOMIC_RELEASE);
+
+  return uring_enter (ring, 1, 0);
+} /* End of uring_submit() */
+
+/*********************************************************************
+ * uring_reap:
+ *
+ * Mark the requests of all available completions as done, waiting
+ * for at least one if requested and none are available.
+ *
+ * Returns the number of completions reaped or -errno on error.
+ *********************************************************************/
+static int
+uring_reap (AsyncIO *aio, int wait)
+{
+  struct uring *ring = &aio->ring;
+  struct io_uring_cqe *cqe;
+  AsyncIOReq *req;
+  unsigned head;
+  unsigned tail;
+  int count = 0;
+  int rv;
+
+  for (;;)
+  {
+    head = *ring->cqhead;
+    tail = __atomic_load_n (ring->cqtail, __ATOMIC_ACQUIRE);
+
+    if (head != tail || !wait)
+      break;
+
+    if ((rv = uring_enter (ring, 0, 1)))
+      return rv;
+  }
+
+  while (head != tail)
+  {
+    cqe = &ring->cqes[head & *ring->cqmask];
+    req = (AsyncIOReq *)(uintptr_t)cqe->user_data;
+
+    req->result = cqe->res;
+    req->done   = 1;
+
+    head++;
+    count++;
+    aio->inflight--;
+  }
+
+  __atomic_store_n (ring->cqhead, head, __ATOMIC_RELEASE);
+
+  return count;
+} /* End of uring_reap() */
+#endif /* ASYNCIO_IOURING */
+
+#ifdef ASYNCIO_PTHREADS
+/*********************************************************************
+ * iothread:
+ *
+ * I/O thread loop, run queued requests until shut down.
+ *********************************************************************/
+static void *
+iothread (void *arg)
+{
+  AsyncIO *aio = (AsyncIO *)arg;
+  AsyncIOReq *req;
+  long result;
+
+  pthread_mutex_lock (&aio->lock);
+
+  for (;;)
+  {
+    while (!aio->head && !aio->shutdown)
+      pthread_cond_wait (&aio->queued, &aio->lock);
+
+    if (!aio->head)
+      break;
+
+    req       = aio->head;
+    aio->head = req->next;
+    if (!aio->head)
+      aio->tail = NULL;
+
+    pthread_mutex_unlock (&aio->lock);
+    result = transfer (req, 0);
+    pthread_mutex_lock (&aio->lock);
+
+    req->result = result;
+    req->done   = 1;
+    aio->inflight--;
+
+    pthread_cond_broadcast (&aio->done);
+  }
+
+  pthread_mutex_unlock (&aio->lock);
+
+  return NULL;
+} /* End of iothread() */
+#endif /* ASYNCIO_PTHREADS */
+
+/*********************************************************************
+ * asyncio_init:
+ *
+ * Initialize asynchronous I/O with a backend, ASYNCIO_AUTO selects
+ * io_uring when the kernel supports it and I/O threads otherwise.
+ * At most depth requests are in flight, submitting more waits for
+ * earlier requests to complete.
+ *
+ * Returns a new AsyncIO on success and NULL on error.
+ *********************************************************************/
+AsyncIO *
+asyncio_init (int backend, int depth)
+{
+  AsyncIO *aio;
+
+  if (depth < 1)
+    depth = ASYNCIO_DEFAULTDEPTH;
+
+  if (!(aio = (AsyncIO *)calloc (1, sizeof (AsyncIO))))
+  {
+    fprintf (stderr, "asyncio_init(): Cannot allocate memory\n");
+    return NULL;
+  }
+
+  aio->depth = depth;
+
+  if (backend == ASYNCIO_AUTO || backend == ASYNCIO_URING)
+  {
+#ifdef ASYNCIO_IOURING
+    if (uring_setup (&aio->ring, depth) == 0)
+    {
+      aio->backend = ASYNCIO_URING;
+
+      /* The kernel may round the ring size up */
+      if ((unsigned)aio->depth > aio->ring.entries)
+        aio->depth = aio->ring.entries;
+
+      return aio;
+    }
+#endif
+
+    if (backend == ASYNCIO_URING)
+    {
+      fprintf (stderr, "Error, io_uring is not supported by this system\n");
+      free (aio);
+      return NULL;
+    }
+
+    backend = ASYNCIO_THREADS;
+  }
+
+#ifdef ASYNCIO_PTHREADS
+  if (backend == ASYNCIO_THREADS)
+  {
+    aio->backend = ASYNCIO_THREADS;
+
+    pthread_mutex_init (&aio->lock, NULL);
+    pthread_cond_init (&aio->queued, NULL);
+    pthread_cond_init (&aio->done, NULL);
+
+    for (aio->nthreads = 0; aio->nthreads < ASYNCIO_THREADCOUNT; aio->nthreads++)
+    {
+      if (pthread_create (&aio->threads[aio->nthreads], NULL, iothread, aio))
+        break;
+    }
+
+    if (aio->nthreads > 0)
+      return aio;
+
+    pthread_cond_destroy (&aio->done);
+    pthread_cond_destroy (&aio->queued);
+    pthread_mutex_destroy (&aio->lock);
+  }
+#endif
+
+  aio->backend = ASYNCIO_SYNC;
+
+  return aio;
+} /* End of asyncio_init() */
+
+/*********************************************************************
+ * asyncio_backend:
+ *
+ * Returns the backend in use.
+ *********************************************************************/
+int
+asyncio_backend (AsyncIO *aio)
+{
+  return (aio) ? aio->backend : ASYNCIO_SYNC;
+} /* End of asyncio_backend() */
+
+/*********************************************************************
+ * asyncio_name:
+ *
+ * Returns the name of a backend.
+ *********************************************************************/
+const char *
+asyncio_name (int backend)
+{
+  switch (backend)
+  {
+  case ASYNCIO_AUTO:
+    return "auto";
+  case ASYNCIO_URING:
+    return "uring";
+  case ASYNCIO_THREADS:
+    return "threads";
+  case ASYNCIO_SYNC:
+    return "sync";
+  }
+
+  return "unknown";
+} /* End of asyncio_name() */
+
+/*********************************************************************
+ * asyncio_parse:
+ *
+ * Returns the backend for a name or -1 if the name is not known.
+ *********************************************************************/
+int
+asyncio_parse (const char *name)
+{
+  int backend;
+
+  for (backend = ASYNCIO_AUTO; backend <= ASYNCIO_SYNC; backend++)
+  {
+    if (strcmp (name, asyncio_name (backend)) == 0)
+      return backend;
+  }
+
+  return -1;
+} /* End of asyncio_parse() */
+
+/*********************************************************************
+ * asyncio_open:
+ *
+ * Open a file for reading or, if write is non-zero, create or
+ * truncate it for writing.
+ *
+ * Returns the file descriptor on success and -1 on error with errno
+ * set.
+ *********************************************************************/
+int
+asyncio_open (const char *path, int write)
+{
+#if defined(ASYNCIO_WIN32)
+  if (write)
+    return _open (path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+
+  return _open (path, _O_RDONLY | _O_BINARY);
+#else
+  if (write)
+    return open (path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+  return open (path, O_RDONLY);
+#endif
+} /* End of asyncio_open() */
+
+/*********************************************************************
+ * asyncio_close:
+ *
+ * Close a file opened with asyncio_open().  No requests for the file
+ * may be in flight.
+ *
+ * Returns 0 on success and -1 on error with errno set.
+ *********************************************************************/
+int
+asyncio_close (int fd)
+{
+#if defined(ASYNCIO_WIN32)
+  return _close (fd);
+#else
+  return close (fd);
+#endif
+} /* End of asyncio_close() */
+
+/*********************************************************************
+ * asyncio_read:
+ *
+ * Queue a read of len bytes from a file offset into a buffer.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+asyncio_read (AsyncIO *aio, AsyncIOReq *req, int fd, void *buf,
+              size_t len, int64_t offset)
+{
+  req->fd     = fd;
+  req->op     = ASYNCIO_OPREAD;
+  req->buf    = (char *)buf;
+  req->len    = len;
+  req->offset = offset;
+
+  return submit (aio, req);
+} /* End of asyncio_read() */
+
+/*********************************************************************
+ * asyncio_write:
+ *
+ * Queue a write of len bytes from a buffer to a file offset.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+asyncio_write (AsyncIO *aio, AsyncIOReq *req, int fd, const void *buf,
+               size_t len, int64_t offset)
+{
+  req->fd     = fd;
+  req->op     = ASYNCIO_OPWRITE;
+  req->buf    = (char *)buf;
+  req->len    = len;
+  req->offset = offset;
+
+  return submit (aio, req);
+} /* End of asyncio_write() */
+
+/*********************************************************************
+ * asyncio_willneed:
+ *
+ * Queue advice that a file range will be read soon so the kernel
+ * reads it into the page cache.  A len of 0 covers the file from the
+ * offset to the end.  Where the advice is not supported the request
+ * completes without effect.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+asyncio_willneed (AsyncIO *aio, AsyncIOReq *req, int fd,
+                  int64_t offset, size_t len)
+{
+  req->fd     = fd;
+  req->op     = ASYNCIO_OPWILLNEED;
+  req->buf    = NULL;
+  req->len    = len;
+  req->offset = offset;
+
+  return submit (aio, req);
+} /* End of asyncio_willneed() */
+
+/*********************************************************************
+ * asyncio_wait:
+ *
+ * Wait for a request to complete, completing a short transfer.
+ *
+ * Returns the number of bytes transferred, less than requested only
+ * for reads at the end of a file, or -errno on error.
+ *********************************************************************/
+long
+asyncio_wait (AsyncIO *aio, AsyncIOReq *req)
+{
+#ifdef ASYNCIO_IOURING
+  int rv;
+
+  if (aio->backend == ASYNCIO_URING)
+  {
+    while (!req->done)
+    {
+      if ((rv = uring_reap (aio, 1)) < 0)
+        return rv;
+    }
+
+    if (req->op != ASYNCIO_OPWILLNEED && req->result > 0 && (size_t)req->result < req->len)
+      req->result = transfer (req, req->result);
+  }
+#endif
+
+#ifdef ASYNCIO_PTHREADS
+  if (aio->backend == ASYNCIO_THREADS)
+  {
+    pthread_mutex_lock (&aio->lock);
+    while (!req->done)
+      pthread_cond_wait (&aio->done, &aio->lock);
+    pthread_mutex_unlock (&aio->lock);
+  }
+#endif
+
+  return req->result;
+} /* End of asyncio_wait() */
+
+/*********************************************************************
+ * asyncio_free:
+ *
+ * Stop the backend and free the AsyncIO.  No requests may be in
+ * flight.
+ *********************************************************************/
+void
+asyncio_free (AsyncIO **paio)
+{
+  AsyncIO *aio;
+#ifdef ASYNCIO_PTHREADS
+  int idx;
+#endif
+
+  if (!paio || !*paio)
+    return;
+
+  aio = *paio;
+
+#ifdef ASYNCIO_IOURING
+  if (aio->backend == ASYNCIO_URING)
+  {
+    munmap (aio->ring.sqes, aio->ring.sqessize);
+    if (aio->ring.cqring != aio->ring.sqring)
+      munmap (aio->ring.cqring, aio->ring.cqringsize);
+    munmap (aio->ring.sqring, aio->ring.sqringsize);
+    close (aio->ring.fd);
+  }
+#endif
+
+#ifdef ASYNCIO_PTHREADS
+  if (aio->backend == ASYNCIO_THREADS)
+  {
+    pthread_mutex_lock (&aio->lock);
+    aio->shutdown = 1;
+    pthread_cond_broadcast (&aio->queued);
+    pthread_mutex_unlock (&aio->lock);
+
+    for (idx = 0; idx < aio->nthreads; idx++)
+      pthread_join (aio->threads[idx], NULL);
+
+    pthread_cond_destroy (&aio->done);
+    pthread_cond_destroy (&aio->queued);
+    pthread_mutex_destroy (&aio->lock);
+  }
+#endif
+
+  free (aio);
+  *paio = NULL;
+} /* End of asyncio_free() */
+
+/*********************************************************************
+ * submit:
+ *
+ * Submit a request to the backend, waiting for earlier requests when
+ * the maximum number are in flight.  The sync backend completes the
+ * request before returning.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+submit (AsyncIO *aio, AsyncIOReq *req)
+{
+#ifdef ASYNCIO_IOURING
+  int rv;
+#endif
+
+  req->result = 0;
+  req->done   = 0;
+  req->next   = NULL;
+
+#ifdef ASYNCIO_IOURING
+  if (aio->backend == ASYNCIO_URING)
+  {
+    while (aio->inflight >= aio->depth)
+    {
+      if ((rv = uring_reap (aio, 1)) < 0)
+      {
+        fprintf (stderr, "Error waiting for I/O completion (%s)\n", strerror (-rv));
+        return -1;
+      }
+    }
+
+    if ((rv = uring_submit (&aio->ring, req)) < 0)
+    {
+      fprintf (stderr, "Error submitting I/O request (%s)\n", strerror (-rv));
+      return -1;
+    }
+
+    aio->inflight++;
+
+    return 0;
+  }
+#endif
+
+#ifdef ASYNCIO_PTHREADS
+  if (aio->backend == ASYNCIO_THREADS)
+  {
+    pthread_mutex_lock (&aio->lock);
+
+    if (aio->tail)
+      aio->tail->next = req;
+    else
+      aio->head = req;
+    aio->tail = req;
+    aio->inflight++;
+
+    pthread_cond_signal (&aio->queued);
+    pthread_mutex_unlock (&aio->lock);
+
+    return 0;
+  }
+#endif
+
+  req->result = transfer (req, 0);
+  req->done   = 1;
+
+  return 0;
+} /* End of submit() */
+
+/*********************************************************************
+ * transfer:
+ *
+ * Complete a request with blocking I/O from count bytes already
+ * transferred, continuing after partial transfers and interrupts.
+ *
+ * Returns the total number of bytes transferred, less than requested
+ * only for reads at the end of a file, or -errno on error.  Advice
+ * requests return 0 on success.
+ *********************************************************************/
+static long
+transfer (AsyncIOReq *req, size_t count)
+{
+  long nbytes;
+
+  if (req->op == ASYNCIO_OPWILLNEED)
+  {
+#if defined(POSIX_FADV_WILLNEED)
+    return -posix_fadvise (req->fd, req->offset, req->len, POSIX_FADV_WILLNEED);
+#else
+    return 0;
+#endif
+  }
+
+  while (count < req->len)
+  {
+#if defined(ASYNCIO_WIN32)
+    if (req->offset >= 0 && _lseeki64 (req->fd, req->offset + count, SEEK_SET) < 0)
+      return -errno;
+
+    if (req->op == ASYNCIO_OPWRITE)
+      nbytes = _write (req->fd, req->buf + count, (unsigned int)(req->len - count));
+    else
+      nbytes = _read (req->fd, req->buf + count, (unsigned int)(req->len - count));
+#else
+    if (req->op == ASYNCIO_OPWRITE && req->offset >= 0)
+      nbytes = (long)pwrite (req->fd, req->buf + count, req->len - count, req->offset + count);
+    else if (req->op == ASYNCIO_OPWRITE)
+      nbytes = (long)write (req->fd, req->buf + count, req->len - count);
+    else if (req->offset >= 0)
+      nbytes = (long)pread (req->fd, req->buf + count, req->len - count, req->offset + count);
+    else
+      nbytes = (long)read (req->fd, req->buf + count, req->len - count);
+#endif
+
+    if (nbytes < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      return -errno;
+    }
+
+    /* End of file */
+    if (nbytes == 0)
+      break;
+
+    count += nbytes;
+  }
+
+  return (long)count;
+} /* End of transfer() */
@@ -0,0 +1,61 @@
+/* Asynchronous file reads and writes with io_uring or I/O threads */
+
+#ifndef ASYNCIO_H
+#define ASYNCIO_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* I/O backends */
+#define ASYNCIO_AUTO    0 /* io_uring when supported, otherwise threads */
+#define ASYNCIO_URING   1 /* Linux io_uring */
+#define ASYNCIO_THREADS 2 /* pread()/write()/posix_fadvise() on I/O threads */
+#define ASYNCIO_SYNC    3 /* Blocking I/O when submitted */
+
+/* Request operations */
+#define ASYNCIO_OPREAD     0 /* Read into a buffer */
+#define ASYNCIO_OPWRITE    1 /* Write from a buffer */
+#define ASYNCIO_OPWILLNEED 2 /* Read a file range into the page cache */
+
+/* Default maximum number of requests in flight */
+#define ASYNCIO_DEFAULTDEPTH 32
+
+typedef struct AsyncIO_s AsyncIO;
+
+/* A read or write request, owned by the caller until complete */
+typedef struct AsyncIOReq_s
+{
+  int fd;                    /* File descriptor */
+  int op;                    /* Operation, ASYNCIO_OP* */
+  char *buf;                 /* Data buffer */
+  size_t len;                /* Bytes to transfer */
+  int64_t offset;            /* File offset, -1 for the current position */
+  long result;               /* Bytes transferred or -errno when done */
+  int done;                  /* Non-zero when complete */
+  struct AsyncIOReq_s *next; /* Queue link of the thread backend */
+} AsyncIOReq;
+
+AsyncIO *asyncio_init (int backend, int depth);
+int asyncio_backend (AsyncIO *aio);
+const char *asyncio_name (int backend);
+int asyncio_parse (const char *name);
+int asyncio_open (const char *path, int write);
+int asyncio_close (int fd);
+int asyncio_read (AsyncIO *aio, AsyncIOReq *req, int fd, void *buf,
+                  size_t len, int64_t offset);
+int asyncio_write (AsyncIO *aio, AsyncIOReq *req, int fd, const void *buf,
+                   size_t len, int64_t offset);
+int asyncio_willneed (AsyncIO *aio, AsyncIOReq *req, int fd,
+                      int64_t offset, size_t len);
+long asyncio_wait (AsyncIO *aio, AsyncIOReq *req);
+void asyncio_free (AsyncIO **paio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASYNCIO_H */
@@ -0,0 +1,365 @@
+/*********************************************************************
+ * checkpoint.c
+ *
+ * Conversion checkpoints of growing SDR files.
+ *
+ * A checkpoint holds the state of a partly converted SDR file: the
+ * last converted info block with a hash of the info blocks up to it,
+ * a hash of the conversion options, the size of the output file and
+ * every trace with its samples not yet packed into a full record,
+ * its packing stream state and the sequence number of its next
+ * record.  It is written next to the SDR file, with the .ckp suffix,
+ * and lets a later conversion continue with the following blocks,
+ * appending the same records to the output a conversion of the whole
+ * file would write.
+ *
+ * Checkpoint files are in the byte order of the host that wrote them
+ * and are not used on hosts with a different byte order or layout.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkpoint.h"
+
+/* Checkpoint file identification and byte order check */
+#define CHECKPOINT_MAGIC     "SDRCKP1"
+#define CHECKPOINT_BYTEORDER 0x01020304
+
+/* Maximum number of traces accepted from a checkpoint file */
+#define CHECKPOINT_MAXTRACES 65536
+
+/* Header of a checkpoint file, followed by the traces */
+struct ckpheader
+{
+  char magic[8];        /* CHECKPOINT_MAGIC */
+  uint32_t byteorder;   /* CHECKPOINT_BYTEORDER in host byte order */
+  int32_t tracesize;    /* Size of each trace entry */
+  int32_t version;      /* SDR header version */
+  int32_t samprate;     /* Sample rate */
+  int32_t numchannels;  /* Number of channels */
+  int32_t lastblock;    /* Last converted info block */
+  uint32_t infohash;    /* Hash of the info blocks up to lastblock */
+  uint32_t optionhash;  /* Hash of the conversion options */
+  int32_t ntraces;      /* Number of traces */
+  int64_t outsize;      /* Size of the output file */
+};
+
+/* Trace entry, followed by its samples */
+struct ckptrace
+{
+  char network[11];       /* Network code */
+  char station[11];       /* Station code */
+  char location[11];      /* Location code */
+  char channel[11];       /* Channel code */
+  char dataquality;       /* Data quality indicator */
+  char sampletype;        /* Sample type code */
+  int64_t starttime;      /* Time of the first sample */
+  int64_t endtime;        /* Time of the last sample */
+  double samprate;        /* Sample rate */
+  int64_t numsamples;     /* Number of samples */
+  int64_t packedrecords;  /* Records packed of the trace */
+  int64_t packedsamples;  /* Samples packed of the trace */
+  int32_t lastintsample;  /* Last integer sample packed */
+  int32_t comphistory;    /* lastintsample is used for compression */
+  int32_t sequence;       /* Record sequence number */
+};
+
+static char *checkpointpath (const char *sdrfile, const char *suffix);
+
+/*********************************************************************
+ * checkpoint_read:
+ *
+ * Read the checkpoint of an SDR file.  The traces are returned in a
+ * new MSTraceGroup with their stream state, the record sequence
+ * number of each trace in the sequence array.
+ *
+ * Returns the Checkpoint on success and NULL if there is no
+ * checkpoint or it cannot be read.
+ *********************************************************************/
+Checkpoint *
+checkpoint_read (const char *sdrfile)
+{
+  struct ckpheader header;
+  struct ckptrace trace;
+  Checkpoint *ckp = NULL;
+  MSTrace *mst;
+  MSTrace **plink;
+  size_t bytes;
+  char *path;
+  FILE *fp;
+  int idx;
+
+  if (!(path = checkpointpath (sdrfile, NULL)))
+    return NULL;
+
+  fp = fopen (path, "rb");
+  free (path);
+
+  if (!fp)
+    return NULL;
+
+  if (fread (&header, sizeof (header), 1, fp) != 1 ||
+      memcmp (header.magic, CHECKPOINT_MAGIC, sizeof (header.magic)) ||
+      header.byteorder != CHECKPOINT_BYTEORDER ||
+      header.tracesize != (int32_t)sizeof (struct ckptrace) ||
+      header.ntraces < 0 || header.ntraces > CHECKPOINT_MAXTRACES)
+  {
+    fclose (fp);
+    return NULL;
+  }
+
+  if (!(ckp = (Checkpoint *)calloc (1, sizeof (Checkpoint))) ||
+      !(ckp->mstg = mst_initgroup (NULL)) ||
+      (header.ntraces > 0 &&
+       !(ckp->sequence = (int32_t *)calloc (header.ntraces, sizeof (int32_t)))))
+  {
+    fprintf (stderr, "checkpoint_read(): Cannot allocate memory\n");
+    fclose (fp);
+    checkpoint_free (&ckp);
+    return NULL;
+  }
+
+  ckp->version     = header.version;
+  ckp->samprate    = header.samprate;
+  ckp->numchannels = header.numchannels;
+  ckp->lastblock   = header.lastblock;
+  ckp->infohash    = header.infohash;
+  ckp->optionhash  = header.optionhash;
+  ckp->outsize     = header.outsize;
+
+  plink = &ckp->mstg->traces;
+
+  for (idx = 0; idx < header.ntraces; idx++)
+  {
+    if (fread (&trace, sizeof (trace), 1, fp) != 1 ||
+        trace.numsamples < 0 || ms_samplesize (trace.sampletype) == 0)
+      break;
+
+    if (!(mst = mst_init (NULL)) ||
+        !(mst->ststate = (StreamState *)calloc (1, sizeof (StreamState))))
+    {
+      fprintf (stderr, "checkpoint_read(): Cannot allocate memory\n");
+      mst_free (&mst);
+      break;
+    }
+
+    /* Link first, the trace is freed with the group */
+    *plink = mst;
+    plink  = &mst->next;
+    ckp->mstg->numtraces++;
+
+    memcpy (mst->network, trace.network, sizeof (mst->network));
+    memcpy (mst->station, trace.station, sizeof (mst->station));
+    memcpy (mst->location, trace.location, sizeof (mst->location));
+    memcpy (mst->channel, trace.channel, sizeof (mst->channel));
+    mst->network[10] = mst->station[10] = mst->location[10] = mst->channel[10] = '\0';
+
+    mst->dataquality = trace.dataquality;
+    mst->sampletype  = trace.sampletype;
+    mst->starttime   = trace.starttime;
+    mst->endtime     = trace.endtime;
+    mst->samprate    = trace.samprate;
+    mst->numsamples  = trace.numsamples;
+    mst->samplecnt   = trace.numsamples;
+
+    mst->ststate->packedrecords = trace.packedrecords;
+    mst->ststate->packedsamples = trace.packedsamples;
+    mst->ststate->lastintsample = trace.lastintsample;
+    mst->ststate->comphistory   = (flag)trace.comphistory;
+
+    ckp->sequence[idx] = trace.sequence;
+
+    if (trace.numsamples > 0)
+    {
+      bytes = (size_t)trace.numsamples * ms_samplesize (trace.sampletype);
+
+      if (!(mst->datasamples = malloc (bytes)) ||
+          fread (mst->datasamples, bytes, 1, fp) != 1)
+        break;
+    }
+  }
+
+  fclose (fp);
+
+  if (idx < header.ntraces)
+  {
+    checkpoint_free (&ckp);
+    return NULL;
+  }
+
+  return ckp;
+} /* End of checkpoint_read() */
+
+/*********************************************************************
+ * checkpoint_write:
+ *
+ * Write the checkpoint of an SDR file with the traces of the
+ * MSTraceGroup and their sequence numbers.  The checkpoint is written
+ * to a temporary file renamed to the checkpoint file, readers never
+ * see a partial checkpoint.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+checkpoint_write (const char *sdrfile, Checkpoint *ckp)
+{
+  struct ckpheader header;
+  struct ckptrace trace;
+  MSTrace *mst;
+  size_t bytes;
+  char *path;
+  char *tmppath;
+  FILE *fp;
+  int idx;
+  int rv = -1;
+
+  if (!ckp || !ckp->mstg)
+    return -1;
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, CHECKPOINT_MAGIC, sizeof (header.magic));
+  header.byteorder   = CHECKPOINT_BYTEORDER;
+  header.tracesize   = sizeof (struct ckptrace);
+  header.version     = ckp->version;
+  header.samprate    = ckp->samprate;
+  header.numchannels = ckp->numchannels;
+  header.lastblock   = ckp->lastblock;
+  header.infohash    = ckp->infohash;
+  header.optionhash  = ckp->optionhash;
+  header.ntraces     = ckp->mstg->numtraces;
+  header.outsize     = ckp->outsize;
+
+  path    = checkpointpath (sdrfile, NULL);
+  tmppath = checkpointpath (sdrfile, ".tmp");
+
+  if (path && tmppath && (fp = fopen (tmppath, "wb")))
+  {
+    if (fwrite (&header, sizeof (header), 1, fp) == 1)
+      rv = 0;
+
+    for (mst = ckp->mstg->traces, idx = 0; mst && rv == 0; mst = mst->next, idx++)
+    {
+      memset (&trace, 0, sizeof (trace));
+      memcpy (trace.network, mst->network, sizeof (trace.network));
+      memcpy (trace.station, mst->station, sizeof (trace.station));
+      memcpy (trace.location, mst->location, sizeof (trace.location));
+      memcpy (trace.channel, mst->channel, sizeof (trace.channel));
+
+      trace.dataquality = mst->dataquality;
+      trace.sampletype  = mst->sampletype;
+      trace.starttime   = mst->starttime;
+      trace.endtime     = mst->endtime;
+      trace.samprate    = mst->samprate;
+      trace.numsamples  = mst->numsamples;
+      trace.sequence    = (ckp->sequence) ? ckp->sequence[idx] : 0;
+
+      if (mst->ststate)
+      {
+        trace.packedrecords = mst->ststate->packedrecords;
+        trace.packedsamples = mst->ststate->packedsamples;
+        trace.lastintsample = mst->ststate->lastintsample;
+        trace.comphistory   = mst->ststate->comphistory;
+      }
+
+      bytes = (size_t)mst->numsamples * ms_samplesize (mst->sampletype);
+
+      if (fwrite (&trace, sizeof (trace), 1, fp) != 1 ||
+          (bytes > 0 && fwrite (mst->datasamples, bytes, 1, fp) != 1))
+        rv = -1;
+    }
+
+    if (fclose (fp))
+      rv = -1;
+
+#if defined(WIN32) || defined(_WIN32)
+    /* rename() does not replace an existing file */
+    if (rv == 0)
+      remove (path);
+#endif
+
+    if (rv == 0 && rename (tmppath, path))
+      rv = -1;
+
+    if (rv)
+      remove (tmppath);
+  }
+
+  if (rv)
+    fprintf (stderr, "Cannot write checkpoint of %s (%s)\n", sdrfile, strerror (errno));
+
+  free (path);
+  free (tmppath);
+
+  return rv;
+} /* End of checkpoint_write() */
+
+/*********************************************************************
+ * checkpoint_remove:
+ *
+ * Remove the checkpoint of an SDR file.
+ *
+ * Returns 0 on success or if there is no checkpoint and -1 on error.
+ *********************************************************************/
+int
+checkpoint_remove (const char *sdrfile)
+{
+  char *path;
+  int rv = 0;
+
+  if (!(path = checkpointpath (sdrfile, NULL)))
+    return -1;
+
+  if (remove (path) && errno != ENOENT)
+  {
+    fprintf (stderr, "Cannot remove checkpoint %s (%s)\n", path, strerror (errno));
+    rv = -1;
+  }
+
+  free (path);
+
+  return rv;
+} /* End of checkpoint_remove() */
+
+/*********************************************************************
+ * checkpoint_free:
+ *
+ * Free a checkpoint and its traces.
+ *********************************************************************/
+void
+checkpoint_free (Checkpoint **pckp)
+{
+  if (!pckp || !*pckp)
+    return;
+
+  mst_freegroup (&(*pckp)->mstg);
+  free ((*pckp)->sequence);
+  free (*pckp);
+  *pckp = NULL;
+} /* End of checkpoint_free() */
+
+/*********************************************************************
+ * checkpointpath:
+ *
+ * Returns a newly allocated checkpoint file path of an SDR file with
+ * an optional further suffix, or NULL on error.
+ *********************************************************************/
+static char *
+checkpointpath (const char *sdrfile, const char *suffix)
+{
+  size_t length;
+  char *path;
+
+  length = strlen (sdrfile) + strlen (CHECKPOINT_SUFFIX) + ((suffix) ? strlen (suffix) : 0) + 1;
+
+  if (!(path = (char *)malloc (length)))
+    return NULL;
+
+  snprintf (path, length, "%s%s%s", sdrfile, CHECKPOINT_SUFFIX, (suffix) ? suffix : "");
+
+  return path;
+} /* End of checkpointpath() */
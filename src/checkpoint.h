@@ -0,0 +1,40 @@
+/* Conversion checkpoints of growing SDR files */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H 1
+
+#include <stdint.h>
+
+#include <libmseed.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Checkpoint file name suffix added to the SDR file name */
+#define CHECKPOINT_SUFFIX ".ckp"
+
+/* State of a partly converted SDR file */
+typedef struct Checkpoint_s
+{
+  int version;         /* SDR header version */
+  int samprate;        /* Sample rate */
+  int numchannels;     /* Number of channels */
+  int lastblock;       /* Last converted info block, -1 if none */
+  uint32_t infohash;   /* Hash of the info blocks up to lastblock */
+  uint32_t optionhash; /* Hash of the conversion options */
+  int64_t outsize;     /* Size of the output file */
+  MSTraceGroup *mstg;  /* Traces with the samples not yet packed */
+  int32_t *sequence;   /* Record sequence number of each trace */
+} Checkpoint;
+
+Checkpoint *checkpoint_read (const char *sdrfile);
+int checkpoint_write (const char *sdrfile, Checkpoint *ckp);
+int checkpoint_remove (const char *sdrfile);
+void checkpoint_free (Checkpoint **pckp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHECKPOINT_H */
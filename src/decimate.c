@@ -7,14 +7,92 @@
  * and are the default filters used in SAC.
  *
  * Three versions: for double, float and 32-bit integer samples.
+ * A fourth, qdecimate(), filters 32-bit integer samples using only
+ * fixed-point integer arithmetic.
  *
- * Modified: 2011.031
+ * A streaming decimator that holds the FIR delay line between calls
+ * is provided by the decim_* routines.  Filters for other decimation
+ * factors are designed as Kaiser windowed-sincs and decim_plan()
+ * splits any decimation ratio into a cascade of stages.
+ *
+ * Long filters are applied with overlap-save FFT convolution when
+ * that is cheaper than the direct form, see decim_fftsize().
+ *
+ * Modified: 2026.292
  *********************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 
 #include "decimate.h"
+#include "fft.h"
+
+/* AVX2 kernels are built with GCC-compatible compilers for x86 and
+ * selected at run time when supported by the CPU */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DECIMATE_AVX2 1
+#include <immintrin.h>
+#endif
+
+/* Round half away from zero to a 32-bit integer */
+#define DROUND(X) ((X) >= 0.0 ? (int32_t) ((X) + 0.5) : (int32_t) ((X)-0.5))
+
+/* Thread-local storage for the per-thread working buffer */
+#if defined(_MSC_VER) || defined(__WATCOMC__)
+#define DECIM_TLS __declspec(thread)
+#else
+#define DECIM_TLS __thread
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Default fractional bits of fixed-point FIR coefficients */
+#define QBITS 30
+
+/* Parameters for designed anti-alias filters: pass band edge as a
+ * fraction of the output Nyquist frequency and stop band attenuation */
+#define DESIGN_PASSBAND 0.8
+#define DESIGN_ATTEN_DB 80.0
+
+/* Maximum number of coefficients of a designed filter, limiting stage
+ * factors to primes up to about 1300 */
+#define DESIGN_MAXNC 32768
+
+/* Cost of an FFT butterfly and of the per-point work of an
+ * overlap-save block relative to a direct form multiply-add,
+ * calibrated with bench/fftcross */
+#define FFT_BUTTERFLY_COST 4.0
+#define FFT_POINT_COST 8.0
+
+/* Arithmetic of streaming decimators */
+#define DECIM_DOUBLE 0
+#define DECIM_FIXED 1
+#define DECIM_FLOAT 2
+
+/* Largest FFT size considered for overlap-save filtering */
+#define FFT_MAXSIZE (1 << 18)
+
+/* FFT filtering mode: -1 = automatic, 0 = never, 1 = always */
+static int fftmode = -1;
+
+/* Cache of designed AA FIR filters, filters are never freed */
+struct designedfir
+{
+  int factor;
+  int firnc;
+  double *fir;
+  struct designedfir *next;
+};
+
+static struct designedfir *designcache = NULL;
+
+/* Per-thread working buffer of [idf]decimate(), grown as needed */
+static DECIM_TLS double *scratchbuf = NULL;
+static DECIM_TLS int scratchsize    = 0;
 
 /* A 2-factor decimation AA FIR filter */
 static int dec2FIRnc      = 48;
@@ -149,6 +227,94 @@ static double dec7FIR[113] = {
     0.14812217E-03, -0.15542324E-03, -0.53318450E-03, -0.62111754E-03, -0.10503677E-02,
     -0.43352076E-03, -0.16600490E-02, -0.79061883E-03};
 
+/*********************************************************************
+ * decim_scratch:
+ *
+ * Return the working buffer of the calling thread with room for at
+ * least count samples, the contents are undefined.
+ *
+ * Returns a pointer to the buffer on success and NULL on error.
+ *********************************************************************/
+static double *
+decim_scratch (int count)
+{
+  double *newbuf;
+
+  if (count > scratchsize)
+  {
+    if (!(newbuf = (double *)realloc (scratchbuf, count * sizeof (double))))
+      return NULL;
+
+    scratchbuf  = newbuf;
+    scratchsize = count;
+  }
+
+  return scratchbuf;
+} /* End of decim_scratch() */
+
+/*********************************************************************
+ * decim_freescratch:
+ *
+ * Free the working buffer of the calling thread used by
+ * [idf]decimate(), threads should call this before exiting.
+ *********************************************************************/
+void
+decim_freescratch (void)
+{
+  if (scratchbuf)
+    free (scratchbuf);
+
+  scratchbuf  = NULL;
+  scratchsize = 0;
+} /* End of decim_freescratch() */
+
+/*********************************************************************
+ * decim_whole:
+ *
+ * Decimate a whole time-series in place with a streaming decimator,
+ * used by [idf]decimate() for filters applied by FFT convolution and
+ * by fdecimate() with a single precision decimator if single is set.
+ *
+ * Returns the number of samples in the output time series on success
+ * and -1 on error.
+ *********************************************************************/
+static int
+decim_whole (void *data, int npts, int factor, double *fir, int firnc,
+             int firsym, char sampletype, int single)
+{
+  DecimState *ds;
+  int size = (sampletype == 'd') ? sizeof (double) : (sampletype == 'f') ? sizeof (float) : sizeof (int32_t);
+  int nout;
+  int nflush;
+
+  if (!data || npts <= 0)
+    return -1;
+
+  if (single)
+    ds = decim_init_float (factor, fir, firnc, firsym);
+  else
+    ds = decim_init (factor, fir, firnc, firsym);
+
+  if (!ds)
+    return -1;
+
+  /* The input is copied to the delay line before any output is
+   * written, so filtering in place is safe */
+  nout = decim_process (ds, data, npts, sampletype, data);
+
+  if (nout >= 0)
+  {
+    if ((nflush = decim_flush (ds, (char *)data + (size_t)nout * size, sampletype)) >= 0)
+      nout += nflush;
+    else
+      nout = -1;
+  }
+
+  decim_free (&ds);
+
+  return nout;
+} /* End of decim_whole() */
+
 /*********************************************************************
  * ddecimate:
  *
@@ -170,6 +336,10 @@ static double dec7FIR[113] = {
  *
  * No testing has been done with oddly symmetric FIR filters (firsym=0).
  *
+ * Long filters, see decim_fftsize(), and filters with fewer
+ * coefficients than the decimation factor are applied with a
+ * streaming decimator.
+ *
  * Returns the number of samples in the output time series on success
  * and -1 on error.
  *********************************************************************/
@@ -239,6 +409,11 @@ ddecimate (double *data, int npts, int factor,
     }
   }
 
+  /* Long filters are cheaper to apply by FFT convolution, filters
+   * shorter than the factor are not supported by the loops below */
+  if (firnc <= factor || decim_fftsize (factor, firnc) > 0)
+    return decim_whole (data, npts, factor, fir, firnc, firsym, 'd', 0);
+
   /* Initializations */
   nch      = firnc - 1;
   nc       = 2 * nch + 1;
@@ -249,8 +424,8 @@ ddecimate (double *data, int npts, int factor,
   in       = 1 - factor;
   out      = 0;
 
-  /* Allocate working buffer */
-  if (!(buf = (double *)calloc (nc, sizeof (double))))
+  /* Per-thread working buffer, every element is set before use */
+  if (!(buf = decim_scratch (nc)))
   {
     fprintf (stderr, "decimate(): Cannot allocate memory\n");
     return -1;
@@ -337,10 +512,6 @@ ddecimate (double *data, int npts, int factor,
     Data[out] = temp;
   } /* end while */
 
-  /* Free working buffer */
-  if (buf)
-    free (buf);
-
   return nptsout;
 } /* End of ddecimate() */
 
@@ -349,7 +520,9 @@ ddecimate (double *data, int npts, int factor,
  *
  * Decimate and low-pass filter a time-series.
  *
- * This routine is a modified version of SAC 2000's decim() routine.
+ * The filter is applied in single precision with the SIMD kernel of
+ * a float streaming decimator, see decim_init_float().  The output
+ * is the same as for ddecimate() within single precision rounding.
  *
  * Arguments:
  *   data       : array of data samples
@@ -365,6 +538,9 @@ ddecimate (double *data, int npts, int factor,
  *
  * No testing has been done with oddly symmetric FIR filters (firsym=0).
  *
+ * Long filters, see decim_fftsize(), are applied by FFT convolution
+ * in double precision.
+ *
  * Returns the number of samples in the output time series on success
  * and -1 on error.
  *********************************************************************/
@@ -372,25 +548,6 @@ int
 fdecimate (float *data, int npts, int factor,
            double *fir, int firnc, int firsym)
 {
-  int i;
-  int in;
-  int ioff;
-  int nbstop;
-  int nc;
-  int nch;
-  int nsave;
-  int nptsstop;
-  int out;
-  int ptr;
-  int nptsout;
-
-  double temp;
-  double *buf;
-
-  float *Data;
-  double *Buf;
-  double *Fir;
-
   /* Determine AA filter to use if using internal filters */
   if (firnc < 0)
   {
@@ -434,109 +591,11 @@ fdecimate (float *data, int npts, int factor,
     }
   }
 
-  /* Initializations */
-  nch      = firnc - 1;
-  nc       = 2 * nch + 1;
-  nptsout  = (npts - 1) / factor + 1;
-  nptsstop = npts - nch - factor;
-  nbstop   = firnc;
-  ptr      = firnc - factor;
-  in       = 1 - factor;
-  out      = 0;
-
-  /* Allocate working buffer */
-  if (!(buf = (double *)calloc (nc, sizeof (double))))
-  {
-    fprintf (stderr, "decimate(): Cannot allocate memory\n");
-    return -1;
-  }
-
-  /* Set crazy historical pointers, vestiges of fortran indexing, blarg. */
-  /* Detangling the indexing logic below proved to be time not well spent */
-  Data = data - 1;
-  Buf  = buf - 1;
-  Fir  = fir - 1;
-
-  /* Initialize buffer, the remaining initial samples are added below */
-  for (i   = 1; i <= nch; i++)
-    Buf[i] = 0.0;
-
-  for (i   = firnc; i <= (nc - factor); i++)
-    Buf[i] = Data[i - nch];
-
-  /* Main loop - filter until end of data reached. */
-  while (in <= nptsstop)
-  {
-    /* Shift buffer, if end of buffer reached. */
-    if (ptr == nbstop)
-    {
-      ptr   = firnc - factor;
-      nsave = nc - factor;
-      for (i   = 1; i <= nsave; i++)
-        Buf[i] = Buf[i + factor];
-    }
-
-    /* Update pointers */
-    out = out + 1;
-    in  = in + factor;
-    ptr = ptr + factor;
-
-    /* Read in new data */
-    for (i = 1; i <= factor; i++)
-    {
-      ioff            = nch + i - factor;
-      Buf[ptr + ioff] = Data[in + ioff];
-    }
-
-    /* Compute output point */
-    temp = Fir[1] * Buf[ptr];
-    for (i = 1; i <= nch; i++)
-      temp = temp + Fir[i + 1] * (Buf[ptr + i] + firsym * Buf[ptr - i]);
-
-    Data[out] = temp;
-  } /* end while */
-
-  /* Loop to handle case where operator runs off of the data */
-  while (in <= npts - factor)
-  {
-    /* Shift buffer, if end of buffer reached. */
-    if (ptr == nbstop)
-    {
-      ptr   = firnc - factor;
-      nsave = nc - factor;
-      for (i   = 1; i <= nsave; i++)
-        Buf[i] = Buf[i + factor];
-    }
-
-    /* Update pointers */
-    out = out + 1;
-    in  = in + factor;
-    ptr = ptr + factor;
-
-    /* Read in new data */
-    for (i = 1; i <= factor; i++)
-    {
-      ioff = nch + i - factor;
-      if (in + ioff > npts)
-        Buf[ptr + ioff] = 0.0;
-
-      else
-        Buf[ptr + ioff] = Data[in + ioff];
-    }
-
-    /* Compute output point */
-    temp = Fir[1] * Buf[ptr];
-    for (i = 1; i <= nch; i++)
-      temp = temp + Fir[i + 1] * (Buf[ptr + i] + firsym * Buf[ptr - i]);
-
-    Data[out] = temp;
-  } /* end while */
-
-  /* Free working buffer */
-  if (buf)
-    free (buf);
+  /* Long filters are cheaper to apply by FFT convolution */
+  if (decim_fftsize (factor, firnc) > 0)
+    return decim_whole (data, npts, factor, fir, firnc, firsym, 'f', 0);
 
-  return nptsout;
+  return decim_whole (data, npts, factor, fir, firnc, firsym, 'f', 1);
 } /* End of fdecimate() */
 
 /*********************************************************************
@@ -560,6 +619,10 @@ fdecimate (float *data, int npts, int factor,
  *
  * No testing has been done with oddly symmetric FIR filters (firsym=0).
  *
+ * Long filters, see decim_fftsize(), and filters with fewer
+ * coefficients than the decimation factor are applied with a
+ * streaming decimator.
+ *
  * Returns the number of samples in the output time series on success
  * and -1 on error.
  *********************************************************************/
@@ -629,6 +692,11 @@ idecimate (int32_t *data, int npts, int factor,
     }
   }
 
+  /* Long filters are cheaper to apply by FFT convolution, filters
+   * shorter than the factor are not supported by the loops below */
+  if (firnc <= factor || decim_fftsize (factor, firnc) > 0)
+    return decim_whole (data, npts, factor, fir, firnc, firsym, 'i', 0);
+
   /* Initializations */
   nch      = firnc - 1;
   nc       = 2 * nch + 1;
@@ -639,8 +707,8 @@ idecimate (int32_t *data, int npts, int factor,
   in       = 1 - factor;
   out      = 0;
 
-  /* Allocate working buffer */
-  if (!(buf = (double *)calloc (nc, sizeof (double))))
+  /* Per-thread working buffer, every element is set before use */
+  if (!(buf = decim_scratch (nc)))
   {
     fprintf (stderr, "decimate(): Cannot allocate memory\n");
     return -1;
@@ -688,8 +756,8 @@ idecimate (int32_t *data, int npts, int factor,
     for (i = 1; i <= nch; i++)
       temp = temp + Fir[i + 1] * (Buf[ptr + i] + firsym * Buf[ptr - i]);
 
-    /* Round the result using truncation back to integer */
-    Data[out] = (int32_t) (temp + 0.5);
+    /* Round the result back to integer, symmetrically about zero */
+    Data[out] = DROUND (temp);
   } /* end while */
 
   /* Loop to handle case where operator runs off of the data */
@@ -725,13 +793,1448 @@ idecimate (int32_t *data, int npts, int factor,
     for (i = 1; i <= nch; i++)
       temp = temp + Fir[i + 1] * (Buf[ptr + i] + firsym * Buf[ptr - i]);
 
-    /* Round the result using truncation back to integer */
-    Data[out] = (int32_t) (temp + 0.5);
+    /* Round the result back to integer, symmetrically about zero */
+    Data[out] = DROUND (temp);
   } /* end while */
 
-  /* Free working buffer */
-  if (buf)
-    free (buf);
-
   return nptsout;
 } /* End of idecimate() */
+
+/*********************************************************************
+ * decim_getfir:
+ *
+ * Look up the AA FIR filter for a decimation factor.  Internal
+ * filters are used for factors 2-7, for other factors a filter is
+ * designed with decim_design() on first use and cached.
+ *
+ * The cache is not locked, filters should be designed (e.g. with
+ * decim_plan()) before decimators are created by multiple threads.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+decim_getfir (int factor, double **fir, int *firnc, int *firsym)
+{
+  struct designedfir *dfir;
+
+  if (!fir || !firnc || !firsym)
+    return -1;
+
+  *firsym = 1;
+
+  switch (factor)
+  {
+  case 2:
+    *fir   = dec2FIR;
+    *firnc = dec2FIRnc;
+    return 0;
+  case 3:
+    *fir   = dec3FIR;
+    *firnc = dec3FIRnc;
+    return 0;
+  case 4:
+    *fir   = dec4FIR;
+    *firnc = dec4FIRnc;
+    return 0;
+  case 5:
+    *fir   = dec5FIR;
+    *firnc = dec5FIRnc;
+    return 0;
+  case 6:
+    *fir   = dec6FIR;
+    *firnc = dec6FIRnc;
+    return 0;
+  case 7:
+    *fir   = dec7FIR;
+    *firnc = dec7FIRnc;
+    return 0;
+  }
+
+  if (factor < 2)
+    return -1;
+
+  for (dfir = designcache; dfir; dfir = dfir->next)
+  {
+    if (dfir->factor == factor)
+    {
+      *fir   = dfir->fir;
+      *firnc = dfir->firnc;
+      return 0;
+    }
+  }
+
+  if (!(dfir = (struct designedfir *)malloc (sizeof (struct designedfir))))
+  {
+    fprintf (stderr, "decim_getfir(): Cannot allocate memory\n");
+    return -1;
+  }
+
+  if (decim_design (factor, &dfir->fir, &dfir->firnc))
+  {
+    free (dfir);
+    return -1;
+  }
+
+  dfir->factor = factor;
+  dfir->next   = designcache;
+  designcache  = dfir;
+
+  *fir   = dfir->fir;
+  *firnc = dfir->firnc;
+
+  return 0;
+} /* End of decim_getfir() */
+
+/*********************************************************************
+ * besseli0:
+ *
+ * Zeroth order modified Bessel function of the first kind, computed
+ * by its power series.
+ *
+ * Returns I0(x).
+ *********************************************************************/
+static double
+besseli0 (double x)
+{
+  double sum  = 1.0;
+  double term = 1.0;
+  double half = x / 2.0;
+  int k;
+
+  for (k = 1; k < 500; k++)
+  {
+    term *= (half / k) * (half / k);
+    sum += term;
+
+    if (term < sum * 1e-17)
+      break;
+  }
+
+  return sum;
+} /* End of besseli0() */
+
+/*********************************************************************
+ * designlength:
+ *
+ * Determine the number of coefficients (1/2 of the symmetric filter)
+ * of a designed AA filter for a decimation factor using the Kaiser
+ * window length estimate.
+ *
+ * Returns number of FIR coefficients.
+ *********************************************************************/
+static int
+designlength (int factor)
+{
+  double transition;
+  double length;
+
+  /* Transition band width in cycles per input sample */
+  transition = (1.0 - DESIGN_PASSBAND) * 0.5 / factor;
+
+  length = (DESIGN_ATTEN_DB - 7.95) / (14.36 * transition) + 1.0;
+
+  return (int)ceil (length / 2.0) + 1;
+} /* End of designlength() */
+
+/*********************************************************************
+ * decim_design:
+ *
+ * Design an AA FIR filter for a decimation factor as a Kaiser
+ * windowed-sinc.  The pass band extends to DESIGN_PASSBAND of the
+ * output Nyquist frequency and the attenuation is DESIGN_ATTEN_DB at
+ * and beyond the output Nyquist frequency.  The filter is normalized
+ * to unity gain at zero frequency.
+ *
+ * The coefficients are returned in the same form as the internal
+ * filters: 1/2 of an even symmetric filter starting with the center
+ * coefficient.  The array is allocated and should be freed by the
+ * caller.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+decim_design (int factor, double **fir, int *firnc)
+{
+  double cutoff;
+  double beta;
+  double sum;
+  double t;
+  double *h;
+  int nch;
+  int nc;
+  int idx;
+
+  if (factor < 2 || !fir || !firnc)
+    return -1;
+
+  nc  = designlength (factor);
+  nch = nc - 1;
+
+  if (nc > DESIGN_MAXNC)
+  {
+    fprintf (stderr, "decim_design(): Filter for factor %d needs %d coefficients, more than %d\n",
+             factor, nc, DESIGN_MAXNC);
+    return -1;
+  }
+
+  if (!(h = (double *)malloc (nc * sizeof (double))))
+  {
+    fprintf (stderr, "decim_design(): Cannot allocate memory\n");
+    return -1;
+  }
+
+  /* Cutoff in the middle of the transition band, cycles per sample */
+  cutoff = (1.0 + DESIGN_PASSBAND) / 2.0 * 0.5 / factor;
+  beta   = 0.1102 * (DESIGN_ATTEN_DB - 8.7);
+
+  h[0] = 2.0 * cutoff;
+  sum  = h[0];
+  for (idx = 1; idx <= nch; idx++)
+  {
+    t      = (double)idx / (nch + 1);
+    h[idx] = sin (2.0 * M_PI * cutoff * idx) / (M_PI * idx) *
+             besseli0 (beta * sqrt (1.0 - t * t)) / besseli0 (beta);
+    sum += 2.0 * h[idx];
+  }
+
+  for (idx = 0; idx <= nch; idx++)
+    h[idx] /= sum;
+
+  *fir   = h;
+  *firnc = nc;
+
+  return 0;
+} /* End of decim_design() */
+
+/*********************************************************************
+ * decim_firlength:
+ *
+ * Determine the number of FIR coefficients (1/2 of the symmetric
+ * filter) used for a decimation factor, without designing it.
+ *
+ * Returns number of FIR coefficients on success and -1 on error.
+ *********************************************************************/
+int
+decim_firlength (int factor)
+{
+  double *fir;
+  int firnc;
+  int firsym;
+  struct designedfir *dfir;
+
+  if (factor < 2)
+    return -1;
+
+  if (factor <= 7)
+  {
+    decim_getfir (factor, &fir, &firnc, &firsym);
+    return firnc;
+  }
+
+  for (dfir = designcache; dfir; dfir = dfir->next)
+    if (dfir->factor == factor)
+      return dfir->firnc;
+
+  return designlength (factor);
+} /* End of decim_firlength() */
+
+/*********************************************************************
+ * planstages:
+ *
+ * Recursively search factorizations of ratio for the stage sequence
+ * with the lowest cost.  Stage factors are taken from the candidates:
+ * 2-7, which have internal filters, or primes greater than 7, which
+ * require designed filters.
+ *
+ * The cost of a sequence is the number of multiply-adds per final
+ * output sample: the filter length of each stage multiplied by the
+ * combined factor of all later stages.
+ *********************************************************************/
+static void
+planstages (int ratio, const int *candidates, int ncandidates, int maxstages,
+            int *stages, int nstages, int *best, int *nbest, double *bestcost)
+{
+  double cost;
+  int later;
+  int factor;
+  int idx;
+
+  if (ratio == 1)
+  {
+    cost  = 0.0;
+    later = 1;
+    for (idx = nstages - 1; idx >= 0; idx--)
+    {
+      cost += (double)(2 * decim_firlength (stages[idx]) - 1) * later;
+      later *= stages[idx];
+    }
+
+    if (*nbest == 0 || cost < *bestcost ||
+        (cost == *bestcost && nstages < *nbest))
+    {
+      memcpy (best, stages, nstages * sizeof (int));
+      *nbest    = nstages;
+      *bestcost = cost;
+    }
+
+    return;
+  }
+
+  if (nstages >= maxstages)
+    return;
+
+  for (idx = 0; idx < ncandidates; idx++)
+  {
+    factor = candidates[idx];
+
+    if (ratio % factor)
+      continue;
+
+    stages[nstages] = factor;
+    planstages (ratio / factor, candidates, ncandidates, maxstages,
+                stages, nstages + 1, best, nbest, bestcost);
+  }
+} /* End of planstages() */
+
+/*********************************************************************
+ * decim_plan:
+ *
+ * Plan a cascade of decimation stages for a total decimation ratio.
+ * The ratio is factored by trial division and the stages ordered to
+ * minimize the number of multiply-adds per output sample.  Filters
+ * for stage factors without an internal filter are designed and
+ * cached, so they are ready for decim_init(), prime factors needing
+ * more than DESIGN_MAXNC coefficients are rejected.
+ *
+ * The factors array must have room for maxstages entries.
+ *
+ * Returns the number of stages on success and -1 on error.
+ *********************************************************************/
+int
+decim_plan (int ratio, int maxstages, int *factors)
+{
+  int stages[32];
+  int candidates[32];
+  double bestcost = 0.0;
+  double *fir;
+  int ncandidates = 0;
+  int remaining;
+  int factor;
+  int firnc;
+  int firsym;
+  int nbest = 0;
+  int idx;
+
+  if (ratio < 1 || maxstages < 1 || !factors)
+    return -1;
+
+  if (ratio == 1)
+    return 0;
+
+  if (maxstages > 32)
+    maxstages = 32;
+
+  /* Stage factors with internal filters dividing the ratio */
+  for (factor = 2; factor <= 7; factor++)
+    if (ratio % factor == 0)
+      candidates[ncandidates++] = factor;
+
+  /* Prime factors greater than 7, a remainder above the square root
+   * of the ratio is a prime */
+  for (remaining = ratio, factor = 2; factor <= remaining / factor; factor++)
+  {
+    if (remaining % factor)
+      continue;
+
+    while (remaining % factor == 0)
+      remaining /= factor;
+
+    if (factor > 7)
+      candidates[ncandidates++] = factor;
+  }
+
+  if (remaining > 7)
+    candidates[ncandidates++] = remaining;
+
+  for (idx = 0; idx < ncandidates; idx++)
+  {
+    if (candidates[idx] > 7 && designlength (candidates[idx]) > DESIGN_MAXNC)
+    {
+      fprintf (stderr, "decim_plan(): Prime factor %d of ratio %d needs a filter of more than %d coefficients\n",
+               candidates[idx], ratio, DESIGN_MAXNC);
+      return -1;
+    }
+  }
+
+  planstages (ratio, candidates, ncandidates, maxstages, stages, 0,
+              factors, &nbest, &bestcost);
+
+  if (nbest == 0)
+  {
+    fprintf (stderr, "decim_plan(): Cannot factor ratio %d into %d or fewer stages\n",
+             ratio, maxstages);
+    return -1;
+  }
+
+  /* Design and cache any missing filters */
+  for (idx = 0; idx < nbest; idx++)
+  {
+    if (decim_getfir (factors[idx], &fir, &firnc, &firsym))
+      return -1;
+  }
+
+  return nbest;
+} /* End of decim_plan() */
+
+/*********************************************************************
+ * decim_fftsize:
+ *
+ * Determine the FFT size for applying a filter with overlap-save
+ * convolution when that is cheaper than the direct form.
+ *
+ * The direct form costs firnc multiply-adds per output sample.  An
+ * overlap-save block of FFT size N computes the full rate filter
+ * output for (N - L) / factor + 1 decimated samples, where L is the
+ * full filter length, and two blocks are transformed together as the
+ * real and imaginary parts of one complex FFT.  The cost per output
+ * of the forward and inverse transforms and the per-point work is
+ * compared to the direct form for each power of two size.
+ *
+ * Returns the FFT size if FFT filtering is cheaper (or forced with
+ * decim_setfft()) and 0 if the direct form should be used.
+ *********************************************************************/
+int
+decim_fftsize (int factor, int firnc)
+{
+  double bestcost = 0.0;
+  double cost;
+  int best = 0;
+  int nc;
+  int log2n;
+  int block;
+  int n;
+
+  if (fftmode == 0 || factor < 1 || firnc < 1)
+    return 0;
+
+  nc = 2 * firnc - 1;
+
+  for (n = fft_size (2 * nc), log2n = 0; (1 << log2n) < n; log2n++)
+    ;
+
+  for (; n > 0 && n <= FFT_MAXSIZE; n <<= 1, log2n++)
+  {
+    block = (n - nc) / factor + 1;
+    cost  = (FFT_BUTTERFLY_COST * n * log2n + FFT_POINT_COST * n) / (2.0 * block);
+
+    if (best == 0 || cost < bestcost)
+    {
+      best     = n;
+      bestcost = cost;
+    }
+  }
+
+  if (fftmode < 0 && bestcost >= firnc)
+    return 0;
+
+  return best;
+} /* End of decim_fftsize() */
+
+/*********************************************************************
+ * decim_setfft:
+ *
+ * Set the FFT filtering mode for decimators created afterwards:
+ * -1 = automatic (default), 0 = always direct form, 1 = always FFT.
+ *********************************************************************/
+void
+decim_setfft (int mode)
+{
+  fftmode = (mode < 0) ? -1 : (mode > 0) ? 1 : 0;
+} /* End of decim_setfft() */
+
+/*********************************************************************
+ * decim_fftinit:
+ *
+ * Set up overlap-save FFT filtering of a streaming decimator: the
+ * plan, the spectrum of the reversed full filter scaled by 1/N for
+ * the unscaled inverse transform, and the work array.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+decim_fftinit (DecimState *ds, int fftn)
+{
+  int nch = ds->firnc - 1;
+  int nc  = 2 * nch + 1;
+  double *h;
+  int t;
+
+  if (!(ds->fftplan = fft_plan (fftn)))
+    return -1;
+
+  ds->ffth    = (double *)calloc (2 * fftn, sizeof (double));
+  ds->fftwork = (double *)malloc (2 * fftn * sizeof (double));
+
+  if (!ds->ffth || !ds->fftwork)
+  {
+    fprintf (stderr, "decim_init(): Cannot allocate memory\n");
+    return -1;
+  }
+
+  ds->fftblock = (fftn - nc) / ds->factor + 1;
+
+  /* Correlation with the filter is convolution with the reversed filter */
+  h = ds->ffth;
+  for (t = 0; t < nc; t++)
+  {
+    if (t < nch)
+      h[2 * t] = ds->fir[nch - t];
+    else if (t == nch)
+      h[2 * t] = ds->fir[0];
+    else
+      h[2 * t] = ds->firsym * ds->fir[t - nch];
+
+    h[2 * t] /= fftn;
+  }
+
+  fft_forward (ds->fftplan, h);
+
+  return 0;
+} /* End of decim_fftinit() */
+
+/*********************************************************************
+ * qdot_scalar:
+ *
+ * Dot product of integer samples and fixed-point coefficients with
+ * 64-bit accumulation.
+ *
+ * Returns the accumulated sum.
+ *********************************************************************/
+static int64_t
+qdot_scalar (const int32_t *x, const int32_t *q, int n)
+{
+  int64_t acc = 0;
+  int i;
+
+  for (i = 0; i < n; i++)
+    acc += (int64_t)x[i] * q[i];
+
+  return acc;
+} /* End of qdot_scalar() */
+
+#if defined(DECIMATE_AVX2)
+/*********************************************************************
+ * qdot_avx2:
+ *
+ * AVX2 version of qdot_scalar().  Signed 32x32->64-bit multiplies
+ * (vpmuldq) are applied to the even and odd lanes separately.  Integer
+ * sums do not depend on order, the result is identical to the scalar
+ * version.
+ *
+ * Returns the accumulated sum.
+ *********************************************************************/
+__attribute__ ((target ("avx2"))) static int64_t
+qdot_avx2 (const int32_t *x, const int32_t *q, int n)
+{
+  __m256i acc0 = _mm256_setzero_si256 ();
+  __m256i acc1 = _mm256_setzero_si256 ();
+  __m256i vx;
+  __m256i vq;
+  int64_t lanes[4];
+  int64_t acc;
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    vx = _mm256_loadu_si256 ((const __m256i *)(x + i));
+    vq = _mm256_loadu_si256 ((const __m256i *)(q + i));
+
+    acc0 = _mm256_add_epi64 (acc0, _mm256_mul_epi32 (vx, vq));
+    acc1 = _mm256_add_epi64 (acc1, _mm256_mul_epi32 (_mm256_srli_epi64 (vx, 32),
+                                                     _mm256_srli_epi64 (vq, 32)));
+  }
+
+  _mm256_storeu_si256 ((__m256i *)lanes, _mm256_add_epi64 (acc0, acc1));
+  acc = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+  for (; i < n; i++)
+    acc += (int64_t)x[i] * q[i];
+
+  return acc;
+} /* End of qdot_avx2() */
+#endif
+
+/*********************************************************************
+ * qdot:
+ *
+ * Dispatch to the fastest fixed-point dot product supported by the
+ * CPU.  The selection is made on first use.
+ *
+ * Returns the accumulated sum.
+ *********************************************************************/
+static int64_t
+qdot (const int32_t *x, const int32_t *q, int n)
+{
+  static int64_t (*qdotfunc) (const int32_t *, const int32_t *, int) = NULL;
+
+  if (!qdotfunc)
+  {
+#if defined(DECIMATE_AVX2)
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+      qdotfunc = qdot_avx2;
+    else
+#endif
+      qdotfunc = qdot_scalar;
+  }
+
+  return qdotfunc (x, q, n);
+} /* End of qdot() */
+
+/*********************************************************************
+ * fdot_scalar:
+ *
+ * Single precision dot product of samples and coefficients.  The
+ * products are summed in 8 lanes, reduced pairwise, followed by the
+ * remaining products, in the same order as fdot_avx2().
+ *
+ * Returns the sum.
+ *********************************************************************/
+static float
+fdot_scalar (const float *x, const float *h, int n)
+{
+  float lanes[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  float acc;
+  int i;
+  int j;
+
+  for (i = 0; i + 8 <= n; i += 8)
+    for (j = 0; j < 8; j++)
+      lanes[j] = lanes[j] + x[i + j] * h[i + j];
+
+  acc = ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) +
+        ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+
+  for (; i < n; i++)
+    acc = acc + x[i] * h[i];
+
+  return acc;
+} /* End of fdot_scalar() */
+
+#if defined(DECIMATE_AVX2)
+/*********************************************************************
+ * fdot_avx2:
+ *
+ * AVX2 version of fdot_scalar().  Separate multiplies and adds (no
+ * fused multiply-add) in the same order give an identical result.
+ *
+ * Returns the sum.
+ *********************************************************************/
+__attribute__ ((target ("avx2"))) static float
+fdot_avx2 (const float *x, const float *h, int n)
+{
+  __m256 acc8 = _mm256_setzero_ps ();
+  float lanes[8];
+  float acc;
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+    acc8 = _mm256_add_ps (acc8, _mm256_mul_ps (_mm256_loadu_ps (x + i),
+                                               _mm256_loadu_ps (h + i)));
+
+  _mm256_storeu_ps (lanes, acc8);
+
+  acc = ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) +
+        ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+
+  for (; i < n; i++)
+    acc = acc + x[i] * h[i];
+
+  return acc;
+} /* End of fdot_avx2() */
+#endif
+
+/*********************************************************************
+ * fdot:
+ *
+ * Dispatch to the fastest single precision dot product supported by
+ * the CPU.  The selection is made on first use.
+ *
+ * Returns the sum.
+ *********************************************************************/
+static float
+fdot (const float *x, const float *h, int n)
+{
+  static float (*fdotfunc) (const float *, const float *, int) = NULL;
+
+  if (!fdotfunc)
+  {
+#if defined(DECIMATE_AVX2)
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+      fdotfunc = fdot_avx2;
+    else
+#endif
+      fdotfunc = fdot_scalar;
+  }
+
+  return fdotfunc (x, h, n);
+} /* End of fdot() */
+
+/*********************************************************************
+ * qround:
+ *
+ * Round a fixed-point value to the nearest integer, half away from
+ * zero, and saturate to the 32-bit integer range.
+ *
+ * Returns the rounded value.
+ *********************************************************************/
+static int32_t
+qround (int64_t acc, int qbits)
+{
+  int64_t half = (int64_t)1 << (qbits - 1);
+  int64_t value;
+
+  if (acc >= 0)
+    value = (acc + half) >> qbits;
+  else
+    value = -((half - acc) >> qbits);
+
+  if (value > INT32_MAX)
+    return INT32_MAX;
+  if (value < INT32_MIN)
+    return INT32_MIN;
+
+  return (int32_t)value;
+} /* End of qround() */
+
+/*********************************************************************
+ * decim_new:
+ *
+ * Allocate and initialize a streaming decimator, see decim_init().
+ *
+ * The mode is one of DECIM_DOUBLE, DECIM_FIXED or DECIM_FLOAT.
+ *
+ * For fixed-point decimation the coefficients of the full, symmetric
+ * filter are quantized to Q format.  The number of fractional bits
+ * is QBITS, reduced if needed so that the accumulated sum cannot
+ * overflow 64 bits for any 32-bit input: sum(|q|) * 2^31 < 2^63.
+ *
+ * For single precision decimation the full filter is converted to
+ * float, long filters are not applied by FFT convolution.
+ *
+ * Returns a new DecimState on success and NULL on error.
+ *********************************************************************/
+static DecimState *
+decim_new (int factor, double *fir, int firnc, int firsym, int mode)
+{
+  DecimState *ds;
+  double sumabs = 0.0;
+  int fftn;
+  int nch;
+  int idx;
+
+  if (firnc < 0)
+  {
+    if (decim_getfir (factor, &fir, &firnc, &firsym))
+    {
+      fprintf (stderr, "decim_init(): Cannot determine filter for decimation factor %d\n",
+               factor);
+      return NULL;
+    }
+  }
+
+  if (factor < 1 || !fir || firnc < 1)
+  {
+    fprintf (stderr, "decim_init(): Invalid decimation factor or filter\n");
+    return NULL;
+  }
+
+  if (!(ds = (DecimState *)calloc (1, sizeof (DecimState))))
+  {
+    fprintf (stderr, "decim_init(): Cannot allocate memory\n");
+    return NULL;
+  }
+
+  ds->factor = factor;
+  ds->fir    = fir;
+  ds->firnc  = firnc;
+  ds->firsym = firsym;
+  nch        = firnc - 1;
+
+  /* Delay line for a full filter plus room for a decimation step */
+  ds->bufsize = 2 * nch + 1 + factor;
+
+  if (mode == DECIM_FIXED)
+  {
+    ds->qbuf = (int32_t *)malloc (ds->bufsize * sizeof (int32_t));
+    ds->qfir = (int32_t *)malloc ((2 * nch + 1) * sizeof (int32_t));
+
+    if (!ds->qbuf || !ds->qfir)
+    {
+      fprintf (stderr, "decim_init(): Cannot allocate memory\n");
+      decim_free (&ds);
+      return NULL;
+    }
+
+    /* Determine fractional bits that guarantee no accumulator overflow */
+    sumabs = fabs (fir[0]);
+    for (idx = 1; idx <= nch; idx++)
+      sumabs += fabs (fir[idx]) * (1 + abs (firsym));
+
+    ds->qbits = QBITS;
+    while (ds->qbits > 1 && ldexp (sumabs, ds->qbits + 31) >= ldexp (1.0, 63))
+      ds->qbits--;
+
+    /* Expand the 1/2 filter to the full filter centered at nch */
+    ds->qfir[nch] = (int32_t)llround (ldexp (fir[0], ds->qbits));
+    for (idx = 1; idx <= nch; idx++)
+    {
+      ds->qfir[nch + idx] = (int32_t)llround (ldexp (fir[idx], ds->qbits));
+      ds->qfir[nch - idx] = (int32_t)llround (ldexp (firsym * fir[idx], ds->qbits));
+    }
+  }
+  else if (mode == DECIM_FLOAT)
+  {
+    ds->fbuf = (float *)malloc (ds->bufsize * sizeof (float));
+    ds->ffir = (float *)malloc ((2 * nch + 1) * sizeof (float));
+
+    if (!ds->fbuf || !ds->ffir)
+    {
+      fprintf (stderr, "decim_init(): Cannot allocate memory\n");
+      decim_free (&ds);
+      return NULL;
+    }
+
+    /* Expand the 1/2 filter to the full filter centered at nch */
+    ds->ffir[nch] = (float)fir[0];
+    for (idx = 1; idx <= nch; idx++)
+    {
+      ds->ffir[nch + idx] = (float)fir[idx];
+      ds->ffir[nch - idx] = (float)(firsym * fir[idx]);
+    }
+  }
+  else if (!(ds->buf = (double *)malloc (ds->bufsize * sizeof (double))))
+  {
+    fprintf (stderr, "decim_init(): Cannot allocate memory\n");
+    free (ds);
+    return NULL;
+  }
+  /* Long filters are applied by FFT convolution when cheaper */
+  else if ((fftn = decim_fftsize (factor, firnc)) > 0 && decim_fftinit (ds, fftn))
+  {
+    decim_free (&ds);
+    return NULL;
+  }
+
+  decim_reset (ds);
+
+  return ds;
+} /* End of decim_new() */
+
+/*********************************************************************
+ * decim_init:
+ *
+ * Initialize a streaming decimator.  The state holds the FIR delay
+ * line and the decimation phase between calls to decim_process() so
+ * that a time-series can be decimated in arbitrary chunks.  The
+ * output, chunk by chunk, is identical to the output of
+ * [idf]decimate() on the concatenated input, including the zero
+ * padding at the start and, via decim_flush(), at the end.
+ *
+ * Arguments are the same as for ddecimate(), if firnc is a negative
+ * number the default FIR filters will be used.
+ *
+ * Returns a new DecimState on success and NULL on error.
+ *********************************************************************/
+DecimState *
+decim_init (int factor, double *fir, int firnc, int firsym)
+{
+  return decim_new (factor, fir, firnc, firsym, DECIM_DOUBLE);
+} /* End of decim_init() */
+
+/*********************************************************************
+ * decim_init_fixed:
+ *
+ * Initialize a fixed-point streaming decimator for 32-bit integer
+ * samples, the output is identical to qdecimate() on the
+ * concatenated input.  See decim_init() for arguments.
+ *
+ * Returns a new DecimState on success and NULL on error.
+ *********************************************************************/
+DecimState *
+decim_init_fixed (int factor, double *fir, int firnc, int firsym)
+{
+  return decim_new (factor, fir, firnc, firsym, DECIM_FIXED);
+} /* End of decim_init_fixed() */
+
+/*********************************************************************
+ * decim_init_float:
+ *
+ * Initialize a single precision streaming decimator, filtering with
+ * float coefficients and sums using SIMD instructions when supported.
+ * The output does not depend on the instruction set and is the same
+ * as for decim_init() within single precision rounding.  Input and
+ * output samples may be of any supported type.  See decim_init() for
+ * arguments.
+ *
+ * Returns a new DecimState on success and NULL on error.
+ *********************************************************************/
+DecimState *
+decim_init_float (int factor, double *fir, int firnc, int firsym)
+{
+  return decim_new (factor, fir, firnc, firsym, DECIM_FLOAT);
+} /* End of decim_init_float() */
+
+/*********************************************************************
+ * decim_reset:
+ *
+ * Reset a streaming decimator to the start of a new time-series,
+ * discarding any pending input.
+ *********************************************************************/
+void
+decim_reset (DecimState *ds)
+{
+  int nch;
+  int i;
+
+  if (!ds)
+    return;
+
+  /* History before the first sample is zero, as in the whole-array routines */
+  nch = ds->firnc - 1;
+  if (ds->qfir)
+    for (i         = 0; i < nch; i++)
+      ds->qbuf[i] = 0;
+  else if (ds->ffir)
+    for (i         = 0; i < nch; i++)
+      ds->fbuf[i] = 0.0f;
+  else
+    for (i        = 0; i < nch; i++)
+      ds->buf[i] = 0.0;
+
+  ds->buflen   = nch;
+  ds->bufstart = -nch;
+  ds->nextout  = 0;
+  ds->ninput   = 0;
+} /* End of decim_reset() */
+
+/*********************************************************************
+ * decim_maxoutput:
+ *
+ * Determine the maximum number of output samples generated by
+ * passing nin more samples to decim_process() or by decim_flush()
+ * (with nin of 0).
+ *
+ * Returns maximum output sample count.
+ *********************************************************************/
+int
+decim_maxoutput (DecimState *ds, int nin)
+{
+  int64_t pending;
+
+  if (!ds)
+    return 0;
+
+  pending = ds->ninput + nin - ds->nextout;
+
+  if (pending <= 0)
+    return 0;
+
+  return (int)((pending + ds->factor - 1) / ds->factor);
+} /* End of decim_maxoutput() */
+
+/*********************************************************************
+ * decim_runfft:
+ *
+ * Generate output samples with overlap-save FFT convolution.  Output
+ * is generated in pairs of blocks of fftblock samples, transformed
+ * together as the real and imaginary parts of the input.  A pair is
+ * only filtered when the complete input window of both blocks is
+ * available, or when final is set, in which case samples past the
+ * end of the delay line are zero.  Pairs always start at the same
+ * stream positions so the output does not depend on how the input
+ * is split into chunks.
+ *
+ * Returns the number of output samples generated.
+ *********************************************************************/
+static int
+decim_runfft (DecimState *ds, void *output, char sampletype, int64_t limit,
+              int final)
+{
+  int nch    = ds->firnc - 1;
+  int nc     = 2 * nch + 1;
+  int fftn   = ds->fftplan->n;
+  int block  = ds->fftblock;
+  int span   = (block - 1) * ds->factor + nc;
+  int64_t bufend = ds->bufstart + ds->buflen;
+  double *work = ds->fftwork;
+  double *h    = ds->ffth;
+  int64_t start;
+  double re;
+  double im;
+  double temp;
+  int nout = 0;
+  int half;
+  int idx;
+  int t;
+
+  while (ds->nextout < limit)
+  {
+    if (!final && ds->nextout + (int64_t) (2 * block - 1) * ds->factor + nch >= bufend)
+      break;
+
+    /* Pack the input windows of the block pair, zero outside of them */
+    for (half = 0; half < 2; half++)
+    {
+      start = ds->nextout + (int64_t)half * block * ds->factor - nch;
+
+      for (t = 0; t < fftn; t++)
+      {
+        if (t < span && start + t < bufend)
+          work[2 * t + half] = ds->buf[start + t - ds->bufstart];
+        else
+          work[2 * t + half] = 0.0;
+      }
+    }
+
+    fft_forward (ds->fftplan, work);
+
+    for (t = 0; t < fftn; t++)
+    {
+      re = work[2 * t] * h[2 * t] - work[2 * t + 1] * h[2 * t + 1];
+      im = work[2 * t] * h[2 * t + 1] + work[2 * t + 1] * h[2 * t];
+
+      work[2 * t]     = re;
+      work[2 * t + 1] = im;
+    }
+
+    fft_inverse (ds->fftplan, work);
+
+    /* Valid output starts after a full filter length */
+    for (half = 0; half < 2; half++)
+    {
+      for (idx = 0; idx < block && ds->nextout < limit; idx++)
+      {
+        temp = work[2 * (nc - 1 + idx * ds->factor) + half];
+
+        if (sampletype == 'i')
+          ((int32_t *)output)[nout] = DROUND (temp);
+        else if (sampletype == 'f')
+          ((float *)output)[nout] = (float)temp;
+        else
+          ((double *)output)[nout] = temp;
+
+        nout++;
+        ds->nextout += ds->factor;
+      }
+    }
+  }
+
+  return nout;
+} /* End of decim_runfft() */
+
+/*********************************************************************
+ * decim_run:
+ *
+ * Generate output samples while the filter window is available in
+ * the delay line and the output center is less than limit.  The
+ * arithmetic matches [idf]decimate() exactly.  Set final when the
+ * end of the time-series has been zero padded.
+ *
+ * Returns the number of output samples generated.
+ *********************************************************************/
+static int
+decim_run (DecimState *ds, void *output, char sampletype, int64_t limit,
+           int final)
+{
+  int nch = ds->firnc - 1;
+  int nout = 0;
+  int i;
+  double temp;
+  float ftemp;
+  double *w;
+  double *fir = ds->fir;
+  int64_t bufend = ds->bufstart + ds->buflen;
+
+  /* Fixed-point filter */
+  if (ds->qfir)
+  {
+    while (ds->nextout < limit && ds->nextout + nch < bufend)
+    {
+      /* Start of filter window */
+      ((int32_t *)output)[nout] = qround (qdot (ds->qbuf + (ds->nextout - nch - ds->bufstart),
+                                                 ds->qfir, 2 * nch + 1),
+                                           ds->qbits);
+
+      nout++;
+      ds->nextout += ds->factor;
+    }
+
+    return nout;
+  }
+
+  /* Single precision filter */
+  if (ds->ffir)
+  {
+    while (ds->nextout < limit && ds->nextout + nch < bufend)
+    {
+      /* Start of filter window */
+      ftemp = fdot (ds->fbuf + (ds->nextout - nch - ds->bufstart), ds->ffir, 2 * nch + 1);
+
+      if (sampletype == 'i')
+        ((int32_t *)output)[nout] = DROUND (ftemp);
+      else if (sampletype == 'f')
+        ((float *)output)[nout] = ftemp;
+      else
+        ((double *)output)[nout] = ftemp;
+
+      nout++;
+      ds->nextout += ds->factor;
+    }
+
+    return nout;
+  }
+
+  /* Overlap-save FFT filter */
+  if (ds->fftplan)
+    return decim_runfft (ds, output, sampletype, limit, final);
+
+  while (ds->nextout < limit && ds->nextout + nch < bufend)
+  {
+    /* Center of filter window */
+    w = ds->buf + (ds->nextout - ds->bufstart);
+
+    /* Compute output point */
+    temp = fir[0] * w[0];
+    for (i = 1; i <= nch; i++)
+      temp = temp + fir[i] * (w[i] + ds->firsym * w[-i]);
+
+    if (sampletype == 'i')
+      ((int32_t *)output)[nout] = DROUND (temp);
+    else if (sampletype == 'f')
+      ((float *)output)[nout] = (float)temp;
+    else
+      ((double *)output)[nout] = temp;
+
+    nout++;
+    ds->nextout += ds->factor;
+  }
+
+  return nout;
+} /* End of decim_run() */
+
+/*********************************************************************
+ * decim_append:
+ *
+ * Append samples to the delay line, first discarding samples no
+ * longer needed for future output and growing the buffer as needed.
+ * If input is NULL zeros are appended.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+decim_append (DecimState *ds, void *input, int nin, char sampletype)
+{
+  int nch = ds->firnc - 1;
+  int64_t discard;
+  int64_t skip = 0;
+  int32_t *qbuf;
+  float *fbuf;
+  double *buf;
+  int i;
+
+  /* Discard samples before the next filter window */
+  discard = ds->nextout - nch - ds->bufstart;
+  if (discard > ds->buflen)
+  {
+    /* Short filters with large factors skip some input entirely */
+    skip    = discard - ds->buflen;
+    discard = ds->buflen;
+  }
+
+  if (discard > 0)
+  {
+    ds->buflen -= (int)discard;
+    if (ds->qfir)
+      memmove (ds->qbuf, ds->qbuf + discard, ds->buflen * sizeof (int32_t));
+    else if (ds->ffir)
+      memmove (ds->fbuf, ds->fbuf + discard, ds->buflen * sizeof (float));
+    else
+      memmove (ds->buf, ds->buf + discard, ds->buflen * sizeof (double));
+    ds->bufstart += discard;
+  }
+
+  if (skip > 0)
+  {
+    if (skip > nin)
+      skip = nin;
+
+    ds->bufstart += skip;
+    nin -= (int)skip;
+
+    if (input && sampletype == 'i')
+      input = (int32_t *)input + skip;
+    else if (input && sampletype == 'f')
+      input = (float *)input + skip;
+    else if (input)
+      input = (double *)input + skip;
+  }
+
+  /* Fixed-point delay line, integer input only */
+  if (ds->qfir)
+  {
+    if (ds->buflen + nin > ds->bufsize)
+    {
+      if (!(qbuf = (int32_t *)realloc (ds->qbuf, (ds->buflen + nin) * sizeof (int32_t))))
+      {
+        fprintf (stderr, "decim_append(): Cannot allocate memory\n");
+        return -1;
+      }
+
+      ds->qbuf    = qbuf;
+      ds->bufsize = ds->buflen + nin;
+    }
+
+    if (input)
+      memcpy (ds->qbuf + ds->buflen, input, nin * sizeof (int32_t));
+    else
+      memset (ds->qbuf + ds->buflen, 0, nin * sizeof (int32_t));
+
+    ds->buflen += nin;
+
+    return 0;
+  }
+
+  /* Single precision delay line */
+  if (ds->ffir)
+  {
+    if (ds->buflen + nin > ds->bufsize)
+    {
+      if (!(fbuf = (float *)realloc (ds->fbuf, (ds->buflen + nin) * sizeof (float))))
+      {
+        fprintf (stderr, "decim_append(): Cannot allocate memory\n");
+        return -1;
+      }
+
+      ds->fbuf    = fbuf;
+      ds->bufsize = ds->buflen + nin;
+    }
+
+    fbuf = ds->fbuf + ds->buflen;
+
+    if (!input)
+      for (i    = 0; i < nin; i++)
+        fbuf[i] = 0.0f;
+    else if (sampletype == 'i')
+      for (i    = 0; i < nin; i++)
+        fbuf[i] = (float)((int32_t *)input)[i];
+    else if (sampletype == 'f')
+      memcpy (fbuf, input, nin * sizeof (float));
+    else
+      for (i    = 0; i < nin; i++)
+        fbuf[i] = (float)((double *)input)[i];
+
+    ds->buflen += nin;
+
+    return 0;
+  }
+
+  if (ds->buflen + nin > ds->bufsize)
+  {
+    if (!(buf = (double *)realloc (ds->buf, (ds->buflen + nin) * sizeof (double))))
+    {
+      fprintf (stderr, "decim_append(): Cannot allocate memory\n");
+      return -1;
+    }
+
+    ds->buf     = buf;
+    ds->bufsize = ds->buflen + nin;
+  }
+
+  buf = ds->buf + ds->buflen;
+
+  if (!input)
+    for (i   = 0; i < nin; i++)
+      buf[i] = 0.0;
+  else if (sampletype == 'i')
+    for (i   = 0; i < nin; i++)
+      buf[i] = ((int32_t *)input)[i];
+  else if (sampletype == 'f')
+    for (i   = 0; i < nin; i++)
+      buf[i] = ((float *)input)[i];
+  else
+    memcpy (buf, input, nin * sizeof (double));
+
+  ds->buflen += nin;
+
+  return 0;
+} /* End of decim_append() */
+
+/*********************************************************************
+ * decim_process:
+ *
+ * Add a chunk of samples to a streaming decimator and generate all
+ * output samples for which the complete filter window is available.
+ * Output samples are delayed by firnc-1 input samples relative to
+ * their centers, the remainder is generated by decim_flush().
+ *
+ * The sampletype is 'i', 'f' or 'd' for int32_t, float or double
+ * and applies to both input and output arrays.  The output array
+ * must have room for decim_maxoutput() samples.
+ *
+ * Returns the number of output samples on success and -1 on error.
+ *********************************************************************/
+int
+decim_process (DecimState *ds, void *input, int nin, char sampletype,
+               void *output)
+{
+  if (!ds || (!input && nin > 0) || nin < 0 || !output)
+    return -1;
+
+  if ((sampletype != 'i' && sampletype != 'f' && sampletype != 'd') ||
+      (ds->qfir && sampletype != 'i'))
+  {
+    fprintf (stderr, "decim_process(): Unsupported sample type: '%c'\n", sampletype);
+    return -1;
+  }
+
+  if (decim_append (ds, input, nin, sampletype))
+    return -1;
+
+  ds->ninput += nin;
+
+  return decim_run (ds, output, sampletype, ds->ninput, 0);
+} /* End of decim_process() */
+
+/*********************************************************************
+ * decim_flush:
+ *
+ * Generate the remaining output samples of a time-series by zero
+ * padding the end of the input, then reset the decimator for a new
+ * time-series.
+ *
+ * Returns the number of output samples on success and -1 on error.
+ *********************************************************************/
+int
+decim_flush (DecimState *ds, void *output, char sampletype)
+{
+  int64_t needed;
+  int nout = 0;
+
+  if (!ds || !output)
+    return -1;
+
+  if (ds->ninput > 0)
+  {
+    /* Zero pad to the end of the window of the last output center */
+    needed = ds->nextout + ds->factor * (decim_maxoutput (ds, 0) - 1) + ds->firnc -
+             (ds->bufstart + ds->buflen);
+
+    if (needed > 0 && decim_append (ds, NULL, (int)needed, sampletype))
+      return -1;
+
+    nout = decim_run (ds, output, sampletype, ds->ninput, 1);
+  }
+
+  decim_reset (ds);
+
+  return nout;
+} /* End of decim_flush() */
+
+/*********************************************************************
+ * decim_free:
+ *
+ * Free all memory associated with a streaming decimator and set the
+ * pointer to NULL.
+ *********************************************************************/
+void
+decim_free (DecimState **ds)
+{
+  if (!ds || !*ds)
+    return;
+
+  if ((*ds)->buf)
+    free ((*ds)->buf);
+
+  if ((*ds)->qbuf)
+    free ((*ds)->qbuf);
+
+  if ((*ds)->qfir)
+    free ((*ds)->qfir);
+
+  if ((*ds)->fbuf)
+    free ((*ds)->fbuf);
+
+  if ((*ds)->ffir)
+    free ((*ds)->ffir);
+
+  if ((*ds)->ffth)
+    free ((*ds)->ffth);
+
+  if ((*ds)->fftwork)
+    free ((*ds)->fftwork);
+
+  fft_free (&(*ds)->fftplan);
+
+  free (*ds);
+  *ds = NULL;
+} /* End of decim_free() */
+
+/*********************************************************************
+ * qdecimate:
+ *
+ * Decimate and low-pass filter a time-series of 32-bit integers
+ * using only fixed-point integer arithmetic.
+ *
+ * The FIR coefficients are quantized to Q30 format (fewer fractional
+ * bits for filters with a sum of absolute coefficients of 2 or more)
+ * and products are accumulated in 64-bit integers, the result is
+ * rounded half away from zero and saturated to the 32-bit range.  The
+ * output does not depend on platform or instruction set, the AVX2
+ * kernel is used when supported.
+ *
+ * Error bounds relative to idecimate(): coefficient quantization
+ * contributes at most 2^-(Q+1) * sum(|x|) over the filter window of N
+ * samples, i.e. at most N * max|x| * 2^-31 for Q30.  For 24-bit data
+ * (|x| < 2^23) and the internal filters (N <= 225) this is less than
+ * 0.9 counts and outputs differ from idecimate() by at most 1 count.
+ * For 16-bit data the bound is less than 0.004 counts, outputs differ
+ * only when the exact result is within that distance of a rounding
+ * boundary.
+ *
+ * Arguments are the same as for idecimate().
+ *
+ * Returns the number of samples in the output time series on success
+ * and -1 on error.
+ *********************************************************************/
+int
+qdecimate (int32_t *data, int npts, int factor,
+           double *fir, int firnc, int firsym)
+{
+  DecimState *ds;
+  int nout;
+  int nflush;
+
+  if (!data || npts <= 0)
+    return -1;
+
+  if (!(ds = decim_init_fixed (factor, fir, firnc, firsym)))
+    return -1;
+
+  /* The input is copied to the delay line before any output is
+   * written, so filtering in place is safe */
+  nout = decim_process (ds, data, npts, 'i', data);
+
+  if (nout >= 0)
+  {
+    if ((nflush = decim_flush (ds, data + nout, 'i')) >= 0)
+      nout += nflush;
+    else
+      nout = -1;
+  }
+
+  decim_free (&ds);
+
+  return nout;
+} /* End of qdecimate() */
@@ -18,6 +18,64 @@ int fdecimate (float *data, int npts, int factor,
 int idecimate (int32_t *data, int npts, int factor,
 	       double *fir, int firc, int firsym);
 
+int qdecimate (int32_t *data, int npts, int factor,
+	       double *fir, int firc, int firsym);
+
+void decim_freescratch (void);
+
+/* Streaming decimator, holds the FIR delay line and phase between calls */
+typedef struct DecimState_s
+{
+  int factor;           /* Decimation factor */
+  double *fir;          /* FIR coefficients, 1/2 of symmetric filter */
+  int firnc;            /* Number of FIR coefficients in array */
+  int firsym;           /* FIR symmetry: 0=odd symmetry, 1=even symmetry */
+  double *buf;          /* Delay line followed by pending input samples */
+  int bufsize;          /* Allocated length of buf in samples */
+  int buflen;           /* Number of samples in buf */
+  int64_t bufstart;     /* Stream index of buf[0], negative for zero history */
+  int64_t nextout;      /* Stream index of the next output sample center */
+  int64_t ninput;       /* Number of input samples in the time-series */
+  int32_t *qfir;        /* Fixed-point coefficients of full filter, or NULL */
+  int qbits;            /* Fractional bits of fixed-point coefficients */
+  int32_t *qbuf;        /* Fixed-point delay line, used instead of buf */
+  float *ffir;          /* Single precision coefficients of full filter, or NULL */
+  float *fbuf;          /* Single precision delay line, used instead of buf */
+  struct FFTPlan_s *fftplan; /* Overlap-save FFT plan, NULL for direct form */
+  double *ffth;         /* Scaled spectrum of the reversed full filter */
+  double *fftwork;      /* FFT work array, interleaved complex */
+  int fftblock;         /* Output samples per overlap-save block */
+} DecimState;
+
+int decim_getfir (int factor, double **fir, int *firnc, int *firsym);
+
+int decim_design (int factor, double **fir, int *firnc);
+
+int decim_firlength (int factor);
+
+int decim_plan (int ratio, int maxstages, int *factors);
+
+int decim_fftsize (int factor, int firnc);
+
+void decim_setfft (int mode);
+
+DecimState *decim_init (int factor, double *fir, int firnc, int firsym);
+
+DecimState *decim_init_fixed (int factor, double *fir, int firnc, int firsym);
+
+DecimState *decim_init_float (int factor, double *fir, int firnc, int firsym);
+
+void decim_reset (DecimState *ds);
+
+int decim_maxoutput (DecimState *ds, int nin);
+
+int decim_process (DecimState *ds, void *input, int nin, char sampletype,
+		   void *output);
+
+int decim_flush (DecimState *ds, void *output, char sampletype);
+
+void decim_free (DecimState **ds);
+
 #ifdef __cplusplus
 }
 #endif
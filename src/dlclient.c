@@ -0,0 +1,698 @@
+/*********************************************************************
+ * dlclient.c
+ *
+ * DataLink client sending records to a ring server.
+ *
+ * Each record is sent in a DataLink WRITE packet with its stream ID,
+ * NET_STA_LOC_CHAN/MSEED, and its start and end time.  Packets are
+ * queued and sent without waiting for the acknowledgement of earlier
+ * packets, a packet stays queued until the server acknowledged it or,
+ * with acknowledgements switched off, until it was sent.  When the
+ * queue is full the writer waits for the server, so a slow server
+ * slows down the conversion instead of records being dropped.
+ *
+ * When the connection fails the client reconnects, waiting longer
+ * after each failed attempt, and sends all queued packets again.
+ * Packets acknowledged, or sent without acknowledgements, before the
+ * failure are not sent again.
+ *
+ * Not supported on Windows.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#define DLCLIENT_WIN32 1
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <libmseed.h>
+
+#include "dlclient.h"
+
+/* Reconnect attempts, the wait doubles after each up to the maximum */
+#define DLCLIENT_RETRIES 10
+#define DLCLIENT_MAXWAIT 30
+
+/* Seconds without progress after which the connection is dropped */
+#define DLCLIENT_TIMEOUT 60
+
+/* Size of the buffer of server responses */
+#define DLCLIENT_RESPONSESIZE 1024
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#ifndef DLCLIENT_WIN32
+/* Queued WRITE packet */
+struct dlpacket
+{
+  char *data; /* Packet header and record */
+  int len;    /* Packet length */
+};
+
+struct DLClient_s
+{
+  char *host;                            /* Server host */
+  char *port;                            /* Server port */
+  char *clientid;                        /* Client ID sent to the server */
+  int ack;                               /* Request acknowledgements */
+  int fd;                                /* Connected socket or -1 */
+  int failed;                            /* Reconnecting failed */
+  int packetsize;                        /* Maximum record size of the server */
+  struct dlpacket queue[DLCLIENT_QUEUE]; /* Queued packets, oldest at head */
+  int head;                              /* Index of the oldest packet */
+  int count;                             /* Queued packets */
+  int nsent;                             /* Queued packets sent, awaiting ack */
+  int offset;                            /* Bytes sent of the next packet */
+  char response[DLCLIENT_RESPONSESIZE];  /* Partial server responses */
+  int rlen;                              /* Bytes in response buffer */
+  MSRecord *msr;                         /* Unpacked record header */
+};
+
+static int dlconnect (DLClient *dl);
+static void dldisconnect (DLClient *dl, const char *reason);
+static int dlpump (DLClient *dl, int wait);
+static int dlsend (DLClient *dl);
+static int dlreceive (DLClient *dl);
+static void dldequeue (DLClient *dl);
+static int sendpacket (int fd, const char *header, const char *data, int datalen);
+static int readpacket (int fd, char *header, size_t headersize, int timeout);
+#endif
+
+/*********************************************************************
+ * dlclient_open:
+ *
+ * Connect to a DataLink server at host[:port], identifying as
+ * clientid, and request acknowledgements of the records if ack is
+ * set.
+ *
+ * Returns a new DLClient on success and NULL on error.
+ *********************************************************************/
+DLClient *
+dlclient_open (const char *address, const char *clientid, int ack)
+{
+#ifndef DLCLIENT_WIN32
+  DLClient *dl;
+  char *sep;
+
+  if (!(dl = (DLClient *)calloc (1, sizeof (DLClient))) ||
+      !(dl->host = strdup (address)) ||
+      !(dl->clientid = strdup (clientid)))
+  {
+    fprintf (stderr, "dlclient_open(): Cannot allocate memory\n");
+    if (dl)
+      free (dl->host);
+    free (dl);
+    return NULL;
+  }
+
+  /* The port follows the last colon */
+  if ((sep = strrchr (dl->host, ':')))
+    *sep = '\0';
+
+  dl->port = strdup ((sep && sep[1]) ? sep + 1 : DLCLIENT_DEFAULTPORT);
+  dl->ack  = ack;
+  dl->fd   = -1;
+
+  /* A closed connection is noticed from send(), not by a signal */
+  if (!MSG_NOSIGNAL)
+    signal (SIGPIPE, SIG_IGN);
+
+  if (!dl->port || dlconnect (dl))
+  {
+    if (dl->port)
+      fprintf (stderr, "Cannot connect to DataLink server %s\n", address);
+    free (dl->host);
+    free (dl->port);
+    free (dl->clientid);
+    free (dl);
+    return NULL;
+  }
+
+  return dl;
+#else
+  fprintf (stderr, "DataLink output is not supported on this platform\n");
+  return NULL;
+#endif
+} /* End of dlclient_open() */
+
+/*********************************************************************
+ * dlclient_write:
+ *
+ * Queue a record for sending to the server, waiting while the queue
+ * is full.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+dlclient_write (DLClient *dl, const char *record, int reclen)
+{
+#ifndef DLCLIENT_WIN32
+  struct dlpacket *packet;
+  char streamid[60];
+  char header[256];
+  int hlen;
+  int retcode;
+
+  if (!dl || dl->failed)
+    return -1;
+
+  if (reclen > dl->packetsize)
+  {
+    fprintf (stderr, "Record length %d exceeds DataLink packet size %d of the server\n",
+             reclen, dl->packetsize);
+    return -1;
+  }
+
+  if ((retcode = msr_unpack ((char *)record, reclen, &dl->msr, 0, 0)) != MS_NOERROR)
+  {
+    fprintf (stderr, "Cannot send record: %s\n", ms_errorstr (retcode));
+    return -1;
+  }
+
+  msr_srcname (dl->msr, streamid, 0);
+  strcat (streamid, "/MSEED");
+
+  hlen = snprintf (header, sizeof (header), "WRITE %s %lld %lld %c %d", streamid,
+                   (long long int)dl->msr->starttime, (long long int)msr_endtime (dl->msr),
+                   (dl->ack) ? 'A' : 'N', reclen);
+
+  if (hlen < 0 || hlen >= (int)sizeof (header))
+    return -1;
+
+  /* Wait for the server while the queue is full */
+  while (dl->count >= DLCLIENT_QUEUE)
+  {
+    if (dlpump (dl, 1))
+      return -1;
+  }
+
+  packet = &dl->queue[(dl->head + dl->count) % DLCLIENT_QUEUE];
+
+  if (!(packet->data = (char *)malloc (3 + hlen + reclen)))
+  {
+    fprintf (stderr, "dlclient_write(): Cannot allocate memory\n");
+    return -1;
+  }
+
+  packet->data[0] = 'D';
+  packet->data[1] = 'L';
+  packet->data[2] = (char)hlen;
+  memcpy (packet->data + 3, header, hlen);
+  memcpy (packet->data + 3 + hlen, record, reclen);
+  packet->len = 3 + hlen + reclen;
+
+  dl->count++;
+
+  /* Send what the connection takes without waiting */
+  return dlpump (dl, 0);
+#else
+  return -1;
+#endif
+} /* End of dlclient_write() */
+
+/*********************************************************************
+ * dlclient_packetsize:
+ *
+ * Returns the maximum record size the server accepts, from its
+ * PACKETSIZE capability, and 0 without a client.
+ *********************************************************************/
+int
+dlclient_packetsize (DLClient *dl)
+{
+#ifndef DLCLIENT_WIN32
+  return (dl) ? dl->packetsize : 0;
+#else
+  return 0;
+#endif
+} /* End of dlclient_packetsize() */
+
+/*********************************************************************
+ * dlclient_close:
+ *
+ * Send all queued packets, wait for their acknowledgements if
+ * requested, disconnect and free the client.
+ *
+ * Returns 0 on success and -1 on error, including records not sent.
+ *********************************************************************/
+int
+dlclient_close (DLClient **pdl)
+{
+#ifndef DLCLIENT_WIN32
+  DLClient *dl;
+  int rv = 0;
+
+  if (!pdl || !*pdl)
+    return -1;
+
+  dl = *pdl;
+
+  while (dl->count > 0 && !dl->failed)
+  {
+    if (dlpump (dl, 1))
+      rv = -1;
+  }
+
+  if (dl->failed)
+  {
+    fprintf (stderr, "%d record(s) not sent to DataLink server %s:%s\n",
+             dl->count, dl->host, dl->port);
+    rv = -1;
+  }
+
+  if (dl->fd >= 0)
+    close (dl->fd);
+
+  while (dl->count > 0)
+    dldequeue (dl);
+
+  msr_free (&dl->msr);
+  free (dl->host);
+  free (dl->port);
+  free (dl->clientid);
+  free (dl);
+  *pdl = NULL;
+
+  return rv;
+#else
+  return -1;
+#endif
+} /* End of dlclient_close() */
+
+#ifndef DLCLIENT_WIN32
+/*********************************************************************
+ * dlconnect:
+ *
+ * Connect to the server and exchange IDs, the server must accept
+ * WRITE packets.  The socket is left non-blocking.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+dlconnect (DLClient *dl)
+{
+  struct addrinfo hints;
+  struct addrinfo *addrs;
+  struct addrinfo *addr;
+  char header[256];
+  char *caps;
+  int fd = -1;
+
+  memset (&hints, 0, sizeof (hints));
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  if (getaddrinfo (dl->host, dl->port, &hints, &addrs))
+    return -1;
+
+  for (addr = addrs; addr; addr = addr->ai_next)
+  {
+    if ((fd = socket (addr->ai_family, addr->ai_socktype, addr->ai_protocol)) < 0)
+      continue;
+
+    if (connect (fd, addr->ai_addr, addr->ai_addrlen) == 0)
+      break;
+
+    close (fd);
+    fd = -1;
+  }
+
+  freeaddrinfo (addrs);
+
+  if (fd < 0)
+    return -1;
+
+  snprintf (header, sizeof (header), "ID %s", dl->clientid);
+
+  if (sendpacket (fd, header, NULL, 0) ||
+      readpacket (fd, header, sizeof (header), DLCLIENT_TIMEOUT) ||
+      strncmp (header, "ID ", 3))
+  {
+    close (fd);
+    return -1;
+  }
+
+  /* Capabilities follow the server ID */
+  caps = strstr (header, "::");
+
+  if (!caps || !strstr (caps, " WRITE"))
+  {
+    fprintf (stderr, "DataLink server %s:%s does not accept records\n", dl->host, dl->port);
+    close (fd);
+    return -1;
+  }
+
+  if ((caps = strstr (caps, "PACKETSIZE:")))
+    dl->packetsize = atoi (caps + 11);
+
+  if (dl->packetsize <= 0)
+    dl->packetsize = 512;
+
+  fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+
+  dl->fd     = fd;
+  dl->nsent  = 0;
+  dl->offset = 0;
+  dl->rlen   = 0;
+
+  return 0;
+} /* End of dlconnect() */
+
+/*********************************************************************
+ * dldisconnect:
+ *
+ * Close a failed connection, all queued packets are sent again after
+ * reconnecting.
+ *********************************************************************/
+static void
+dldisconnect (DLClient *dl, const char *reason)
+{
+  fprintf (stderr, "DataLink connection to %s:%s lost (%s), %d record(s) queued\n",
+           dl->host, dl->port, reason, dl->count);
+
+  close (dl->fd);
+  dl->fd = -1;
+} /* End of dldisconnect() */
+
+/*********************************************************************
+ * dlpump:
+ *
+ * Send queued packets and read acknowledgements as far as possible
+ * without blocking, reconnecting first if needed.  If wait is set
+ * wait until a packet was sent or acknowledged.
+ *
+ * Returns 0 on success and -1 if reconnecting failed.
+ *********************************************************************/
+static int
+dlpump (DLClient *dl, int wait)
+{
+  struct pollfd pfd;
+  int retry;
+  int delay = 1;
+  int count;
+  int nsent;
+
+  if (dl->fd < 0)
+  {
+    for (retry = 0; dl->fd < 0; retry++)
+    {
+      if (retry >= DLCLIENT_RETRIES)
+      {
+        fprintf (stderr, "Cannot reconnect to DataLink server %s:%s\n", dl->host, dl->port);
+        dl->failed = 1;
+        return -1;
+      }
+
+      sleep (delay);
+      delay = (delay * 2 > DLCLIENT_MAXWAIT) ? DLCLIENT_MAXWAIT : delay * 2;
+
+      if (dlconnect (dl) == 0)
+        fprintf (stderr, "Reconnected to DataLink server %s:%s\n", dl->host, dl->port);
+    }
+  }
+
+  count = dl->count;
+  nsent = dl->nsent;
+
+  do
+  {
+    pfd.fd      = dl->fd;
+    pfd.events  = ((dl->nsent < dl->count) ? POLLOUT : 0) | POLLIN;
+    pfd.revents = 0;
+
+    if (poll (&pfd, 1, (wait) ? DLCLIENT_TIMEOUT * 1000 : 0) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      dldisconnect (dl, strerror (errno));
+      return 0;
+    }
+
+    if (pfd.revents == 0)
+    {
+      if (wait)
+        dldisconnect (dl, "timeout");
+      return 0;
+    }
+
+    if (((pfd.revents & (POLLIN | POLLHUP | POLLERR)) && dlreceive (dl)) ||
+        ((pfd.revents & POLLOUT) && dlsend (dl)))
+      return 0;
+
+    /* Progress is a packet acknowledged or sent */
+  } while (wait && dl->count == count && dl->nsent == nsent);
+
+  return 0;
+} /* End of dlpump() */
+
+/*********************************************************************
+ * dlsend:
+ *
+ * Send queued packets until the socket buffer is full.  Without
+ * acknowledgements sent packets are dequeued.
+ *
+ * Returns 0 on success and -1 if the connection was lost.
+ *********************************************************************/
+static int
+dlsend (DLClient *dl)
+{
+  struct dlpacket *packet;
+  ssize_t nsent;
+  int error;
+
+  while (dl->nsent < dl->count)
+  {
+    packet = &dl->queue[(dl->head + dl->nsent) % DLCLIENT_QUEUE];
+
+    nsent = send (dl->fd, packet->data + dl->offset, packet->len - dl->offset, MSG_NOSIGNAL);
+
+    if (nsent < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        return 0;
+
+      /* Take the acknowledgements received before the failure */
+      error = errno;
+      if (dlreceive (dl) == 0)
+        dldisconnect (dl, strerror (error));
+      return -1;
+    }
+
+    dl->offset += (int)nsent;
+
+    if (dl->offset < packet->len)
+      continue;
+
+    dl->offset = 0;
+
+    if (dl->ack)
+      dl->nsent++;
+    else
+      dldequeue (dl);
+  }
+
+  return 0;
+} /* End of dlsend() */
+
+/*********************************************************************
+ * dlreceive:
+ *
+ * Read all available server responses and dequeue the acknowledged
+ * packets.  A packet refused by the server is reported and dequeued,
+ * sending it again would not help.
+ *
+ * Returns 0 on success and -1 if the connection was lost.
+ *********************************************************************/
+static int
+dlreceive (DLClient *dl)
+{
+  char header[256];
+  char message[256];
+  long long int value;
+  ssize_t nread;
+  int hlen;
+  int size;
+  int plen;
+
+  /* Read until no more responses are available */
+  for (;;)
+  {
+    nread = recv (dl->fd, dl->response + dl->rlen, sizeof (dl->response) - dl->rlen, 0);
+
+    if (nread <= 0)
+    {
+      if (nread < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return 0;
+
+      dldisconnect (dl, (nread == 0) ? "closed by server" : strerror (errno));
+      return -1;
+    }
+
+    dl->rlen += (int)nread;
+
+    /* Complete responses: DL, header length, header and message */
+    while (dl->rlen >= 3)
+    {
+      if (dl->response[0] != 'D' || dl->response[1] != 'L')
+      {
+        dldisconnect (dl, "invalid response");
+        return -1;
+      }
+
+      hlen = (unsigned char)dl->response[2];
+
+      if (dl->rlen < 3 + hlen)
+        break;
+
+      memcpy (header, dl->response + 3, hlen);
+      header[hlen] = '\0';
+
+      if (sscanf (header, "%*s %lld %d", &value, &size) != 2 || size < 0)
+        size = 0;
+
+      plen = 3 + hlen + size;
+
+      if (plen > (int)sizeof (dl->response))
+      {
+        dldisconnect (dl, "response too large");
+        return -1;
+      }
+
+      if (dl->rlen < plen)
+        break;
+
+      if (!strncmp (header, "OK ", 3) && dl->nsent > 0)
+      {
+        dldequeue (dl);
+      }
+      else if (!strncmp (header, "ERROR ", 6) && dl->nsent > 0)
+      {
+        if (size >= (int)sizeof (message))
+          size = sizeof (message) - 1;
+
+        memcpy (message, dl->response + 3 + hlen, size);
+        message[size] = '\0';
+
+        fprintf (stderr, "DataLink server refused record: %s\n", message);
+        dldequeue (dl);
+      }
+
+      dl->rlen -= plen;
+      memmove (dl->response, dl->response + plen, dl->rlen);
+    }
+  }
+} /* End of dlreceive() */
+
+/*********************************************************************
+ * dldequeue:
+ *
+ * Remove the oldest queued packet.
+ *********************************************************************/
+static void
+dldequeue (DLClient *dl)
+{
+  free (dl->queue[dl->head].data);
+  dl->queue[dl->head].data = NULL;
+
+  dl->head = (dl->head + 1) % DLCLIENT_QUEUE;
+  dl->count--;
+
+  if (dl->nsent > 0)
+    dl->nsent--;
+} /* End of dldequeue() */
+
+/*********************************************************************
+ * sendpacket:
+ *
+ * Send a packet on a blocking socket.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+sendpacket (int fd, const char *header, const char *data, int datalen)
+{
+  char packet[258];
+  size_t hlen = strlen (header);
+
+  if (hlen > 255)
+    return -1;
+
+  packet[0] = 'D';
+  packet[1] = 'L';
+  packet[2] = (char)hlen;
+  memcpy (packet + 3, header, hlen);
+
+  if (send (fd, packet, 3 + hlen, MSG_NOSIGNAL) != (ssize_t)(3 + hlen) ||
+      (datalen > 0 && send (fd, data, datalen, MSG_NOSIGNAL) != datalen))
+    return -1;
+
+  return 0;
+} /* End of sendpacket() */
+
+/*********************************************************************
+ * readpacket:
+ *
+ * Read the header of a packet without data from a blocking socket,
+ * waiting at most timeout seconds.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+readpacket (int fd, char *header, size_t headersize, int timeout)
+{
+  struct pollfd pfd;
+  unsigned char preamble[3];
+  size_t want = 3;
+  size_t have = 0;
+  char *buf   = (char *)preamble;
+  ssize_t nread;
+  int stage = 0;
+
+  while (stage < 2)
+  {
+    pfd.fd     = fd;
+    pfd.events = POLLIN;
+
+    if (poll (&pfd, 1, timeout * 1000) <= 0)
+      return -1;
+
+    if ((nread = recv (fd, buf + have, want - have, 0)) <= 0)
+      return -1;
+
+    if ((have += nread) < want)
+      continue;
+
+    if (stage++ == 0)
+    {
+      if (preamble[0] != 'D' || preamble[1] != 'L' || preamble[2] >= headersize)
+        return -1;
+
+      buf  = header;
+      want = preamble[2];
+      have = 0;
+
+      if (want == 0)
+        break;
+    }
+  }
+
+  header[want] = '\0';
+
+  return 0;
+} /* End of readpacket() */
+#endif
@@ -0,0 +1,27 @@
+/* DataLink client sending records to a ring server */
+
+#ifndef DLCLIENT_H
+#define DLCLIENT_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default DataLink server port */
+#define DLCLIENT_DEFAULTPORT "16000"
+
+/* Packets queued, sent but not acknowledged or not sent yet */
+#define DLCLIENT_QUEUE 256
+
+typedef struct DLClient_s DLClient;
+
+DLClient *dlclient_open (const char *address, const char *clientid, int ack);
+int dlclient_write (DLClient *dl, const char *record, int reclen);
+int dlclient_packetsize (DLClient *dl);
+int dlclient_close (DLClient **pdl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DLCLIENT_H */
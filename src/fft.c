@@ -0,0 +1,213 @@
+/*********************************************************************
+ * fft.c
+ *
+ * A self-contained, iterative radix-2 complex FFT.
+ *
+ * Data arrays are interleaved complex values (real, imaginary) of the
+ * plan size.  Transforms are done in place and are not scaled, a
+ * forward transform followed by an inverse transform multiplies the
+ * data by the size.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "fft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/*********************************************************************
+ * fft_size:
+ *
+ * Returns the smallest power of two greater than or equal to n, or
+ * -1 if too large.
+ *********************************************************************/
+int
+fft_size (int n)
+{
+  int size = 1;
+
+  while (size < n)
+  {
+    if (size > (1 << 29))
+      return -1;
+
+    size <<= 1;
+  }
+
+  return size;
+} /* End of fft_size() */
+
+/*********************************************************************
+ * fft_plan:
+ *
+ * Create a plan for transforms of size n, which must be a power of
+ * two.
+ *
+ * Returns a new FFTPlan on success and NULL on error.
+ *********************************************************************/
+FFTPlan *
+fft_plan (int n)
+{
+  FFTPlan *plan;
+  int bits = 0;
+  int idx;
+  int rev;
+  int bit;
+
+  if (n < 2 || fft_size (n) != n)
+  {
+    fprintf (stderr, "fft_plan(): Size must be a power of two, not %d\n", n);
+    return NULL;
+  }
+
+  while ((1 << bits) < n)
+    bits++;
+
+  if (!(plan = (FFTPlan *)calloc (1, sizeof (FFTPlan))))
+  {
+    fprintf (stderr, "fft_plan(): Cannot allocate memory\n");
+    return NULL;
+  }
+
+  plan->n       = n;
+  plan->twiddle = (double *)malloc (n * sizeof (double));
+  plan->bitrev  = (int *)malloc (n * sizeof (int));
+
+  if (!plan->twiddle || !plan->bitrev)
+  {
+    fprintf (stderr, "fft_plan(): Cannot allocate memory\n");
+    fft_free (&plan);
+    return NULL;
+  }
+
+  for (idx = 0; idx < n / 2; idx++)
+  {
+    plan->twiddle[2 * idx]     = cos (2.0 * M_PI * idx / n);
+    plan->twiddle[2 * idx + 1] = -sin (2.0 * M_PI * idx / n);
+  }
+
+  for (idx = 0; idx < n; idx++)
+  {
+    for (rev = 0, bit = 0; bit < bits; bit++)
+      rev |= ((idx >> bit) & 1) << (bits - 1 - bit);
+
+    plan->bitrev[idx] = rev;
+  }
+
+  return plan;
+} /* End of fft_plan() */
+
+/*********************************************************************
+ * fft_transform:
+ *
+ * In place decimation-in-time transform, conjugating the twiddle
+ * factors for the inverse.
+ *********************************************************************/
+static void
+fft_transform (FFTPlan *plan, double *data, int inverse)
+{
+  int n = plan->n;
+  double *tw = plan->twiddle;
+  double wr, wi;
+  double tr, ti;
+  double *a, *b;
+  int half;
+  int step;
+  int start;
+  int idx;
+  int rev;
+
+  /* Reorder into bit-reversed order */
+  for (idx = 0; idx < n; idx++)
+  {
+    rev = plan->bitrev[idx];
+
+    if (rev > idx)
+    {
+      tr                = data[2 * idx];
+      ti                = data[2 * idx + 1];
+      data[2 * idx]     = data[2 * rev];
+      data[2 * idx + 1] = data[2 * rev + 1];
+      data[2 * rev]     = tr;
+      data[2 * rev + 1] = ti;
+    }
+  }
+
+  /* Butterflies of increasing span */
+  for (half = 1; half < n; half <<= 1)
+  {
+    step = n / (2 * half);
+
+    for (start = 0; start < n; start += 2 * half)
+    {
+      a = data + 2 * start;
+      b = a + 2 * half;
+
+      for (idx = 0; idx < half; idx++)
+      {
+        wr = tw[2 * idx * step];
+        wi = (inverse) ? -tw[2 * idx * step + 1] : tw[2 * idx * step + 1];
+
+        tr = wr * b[2 * idx] - wi * b[2 * idx + 1];
+        ti = wr * b[2 * idx + 1] + wi * b[2 * idx];
+
+        b[2 * idx]     = a[2 * idx] - tr;
+        b[2 * idx + 1] = a[2 * idx + 1] - ti;
+        a[2 * idx] += tr;
+        a[2 * idx + 1] += ti;
+      }
+    }
+  }
+} /* End of fft_transform() */
+
+/*********************************************************************
+ * fft_forward:
+ *
+ * In place forward transform of interleaved complex data.
+ *********************************************************************/
+void
+fft_forward (FFTPlan *plan, double *data)
+{
+  if (plan && data)
+    fft_transform (plan, data, 0);
+} /* End of fft_forward() */
+
+/*********************************************************************
+ * fft_inverse:
+ *
+ * In place inverse transform of interleaved complex data, the result
+ * is not scaled by 1/n.
+ *********************************************************************/
+void
+fft_inverse (FFTPlan *plan, double *data)
+{
+  if (plan && data)
+    fft_transform (plan, data, 1);
+} /* End of fft_inverse() */
+
+/*********************************************************************
+ * fft_free:
+ *
+ * Free all memory associated with a plan and set the pointer to NULL.
+ *********************************************************************/
+void
+fft_free (FFTPlan **plan)
+{
+  if (!plan || !*plan)
+    return;
+
+  if ((*plan)->twiddle)
+    free ((*plan)->twiddle);
+
+  if ((*plan)->bitrev)
+    free ((*plan)->bitrev);
+
+  free (*plan);
+  *plan = NULL;
+} /* End of fft_free() */
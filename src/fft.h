@@ -0,0 +1,29 @@
+/* Self-contained radix-2 complex FFT */
+
+#ifndef FFT_H
+#define FFT_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* FFT plan for a power of two size, holds twiddle factors and the
+ * bit-reversal permutation */
+typedef struct FFTPlan_s
+{
+  int n;                /* Transform size, a power of two */
+  double *twiddle;      /* cos/sin pairs of exp(-2*pi*i*k/n), k < n/2 */
+  int *bitrev;          /* Bit-reversal permutation of indexes */
+} FFTPlan;
+
+FFTPlan *fft_plan (int n);
+void fft_forward (FFTPlan *plan, double *data);
+void fft_inverse (FFTPlan *plan, double *data);
+void fft_free (FFTPlan **plan);
+int fft_size (int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_H */
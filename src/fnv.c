@@ -0,0 +1,49 @@
+/*********************************************************************
+ * fnv.c
+ *
+ * 32-bit FNV-1a hashes, used for hash tables of paths and to detect
+ * changed file headers and options.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include "fnv.h"
+
+/*********************************************************************
+ * fnv_hash:
+ *
+ * Returns the FNV-1a hash of data continuing from a previous hash,
+ * FNV_INIT to start.
+ *********************************************************************/
+uint32_t
+fnv_hash (const void *data, size_t length, uint32_t hash)
+{
+  const unsigned char *ptr = (const unsigned char *)data;
+
+  while (length-- > 0)
+  {
+    hash ^= *ptr++;
+    hash *= 16777619U;
+  }
+
+  return hash;
+} /* End of fnv_hash() */
+
+/*********************************************************************
+ * fnv_hashstr:
+ *
+ * Returns the FNV-1a hash of a NULL terminated string.
+ *********************************************************************/
+uint32_t
+fnv_hashstr (const char *str)
+{
+  uint32_t hash = FNV_INIT;
+
+  while (*str)
+  {
+    hash ^= (unsigned char)*str++;
+    hash *= 16777619U;
+  }
+
+  return hash;
+} /* End of fnv_hashstr() */
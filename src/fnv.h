@@ -0,0 +1,23 @@
+/* FNV-1a hashes of data and strings */
+
+#ifndef FNV_H
+#define FNV_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Offset basis, the hash to start with */
+#define FNV_INIT 2166136261U
+
+uint32_t fnv_hash (const void *data, size_t length, uint32_t hash);
+uint32_t fnv_hashstr (const char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FNV_H */
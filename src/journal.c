@@ -0,0 +1,449 @@
+/*********************************************************************
+ * journal.c
+ *
+ * State journal of processed files.
+ *
+ * The journal records, for each processed file, its size and
+ * modification time when processed, its content hash, 0 until hashed,
+ * a hash of the options it was processed with, the result and the
+ * output file written, one line per file:
+ *
+ *   <status> <size> <mtime> <hash> <options> <path>[<tab><output>]
+ *
+ * Records are appended and flushed as files are processed, a later
+ * record of a file replaces earlier ones.  When opened the journal is
+ * read and rewritten with the last record of each file still
+ * existing, through a temporary file renamed to the journal.
+ *
+ * The hash is a 64-bit FNV-1a variant over 8-byte words of the file
+ * in host byte order, journals are not portable between hosts of
+ * different byte order.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "fnv.h"
+#include "journal.h"
+
+/* Number of hash buckets */
+#define JOURNAL_BUCKETS 4096
+
+/* Bytes read at once when hashing a file */
+#define JOURNAL_HASHBUFSIZE (1024 * 1024)
+
+/* Record of a file */
+struct entry
+{
+  char *path;          /* File path */
+  int64_t size;        /* File size when processed */
+  int64_t mtime;       /* Modification time when processed */
+  uint64_t hash;       /* Content hash when processed, 0 if unknown */
+  uint32_t options;    /* Hash of the options used for processing */
+  int status;          /* JOURNAL_* state */
+  char *output;        /* Output file written, NULL if none */
+  struct entry *next;  /* Next entry in the bucket */
+};
+
+struct Journal_s
+{
+  char *path;                              /* Journal file path */
+  FILE *fp;                                /* Journal opened for appending */
+  struct entry *buckets[JOURNAL_BUCKETS];  /* Records by path hash */
+};
+
+static struct entry *findentry (Journal *journal, const char *path, int add);
+static int setentry (struct entry *entry, int64_t size, int64_t mtime,
+                     uint64_t hash, uint32_t options, int status,
+                     const char *output);
+static int writeentries (Journal *journal, FILE *fp);
+
+/*********************************************************************
+ * journal_open:
+ *
+ * Open a journal, creating it if it does not exist.  The records of
+ * files that no longer exist are dropped.
+ *
+ * Returns a new Journal on success and NULL on error.
+ *********************************************************************/
+Journal *
+journal_open (const char *path)
+{
+  Journal *journal;
+  struct entry *entry;
+  struct stat st;
+  char line[2200];
+  char name[2048];
+  char *tmppath;
+  char *output;
+  long long int size;
+  long long int mtime;
+  unsigned long long int hash;
+  unsigned int options;
+  char status;
+  FILE *fp;
+  size_t length;
+  int idx;
+  int rv = 0;
+
+  if (!(journal = (Journal *)calloc (1, sizeof (Journal))) ||
+      !(journal->path = strdup (path)))
+  {
+    fprintf (stderr, "journal_open(): Cannot allocate memory\n");
+    free (journal);
+    return NULL;
+  }
+
+  /* Read the records, later records replace earlier ones */
+  if ((fp = fopen (path, "r")))
+  {
+    while (fgets (line, sizeof (line), fp))
+    {
+      length = strlen (line);
+
+      if (length > 0 && line[length - 1] == '\n')
+        line[length - 1] = '\0';
+
+      if (sscanf (line, "%c %lld %lld %llx %x %2047[^\n]", &status, &size, &mtime, &hash, &options, name) != 6 ||
+          (status != JOURNAL_CONVERTED && status != JOURNAL_FAILED))
+        continue;
+
+      if ((output = strchr (name, '\t')))
+        *output++ = '\0';
+
+      if (!(entry = findentry (journal, name, 1)) ||
+          setentry (entry, size, mtime, hash, options, status, output))
+      {
+        fclose (fp);
+        journal_close (&journal);
+        return NULL;
+      }
+    }
+
+    fclose (fp);
+  }
+  else if (errno != ENOENT)
+  {
+    fprintf (stderr, "Cannot open journal %s (%s)\n", path, strerror (errno));
+    journal_close (&journal);
+    return NULL;
+  }
+
+  /* Drop the records of files that no longer exist */
+  for (idx = 0; idx < JOURNAL_BUCKETS; idx++)
+  {
+    for (entry = journal->buckets[idx]; entry; entry = entry->next)
+    {
+      if (stat (entry->path, &st))
+        entry->status = 0;
+    }
+  }
+
+  /* Rewrite the journal compacted */
+  length = strlen (path) + 5;
+
+  if (!(tmppath = (char *)malloc (length)))
+  {
+    fprintf (stderr, "journal_open(): Cannot allocate memory\n");
+    journal_close (&journal);
+    return NULL;
+  }
+
+  snprintf (tmppath, length, "%s.tmp", path);
+
+  if (!(fp = fopen (tmppath, "w")))
+  {
+    rv = -1;
+  }
+  else
+  {
+    rv = writeentries (journal, fp);
+
+    if (fclose (fp))
+      rv = -1;
+
+#if defined(WIN32) || defined(_WIN32)
+    /* rename() does not replace an existing file */
+    if (rv == 0)
+      remove (path);
+#endif
+
+    if (rv == 0 && rename (tmppath, path))
+      rv = -1;
+
+    if (rv)
+      remove (tmppath);
+  }
+
+  free (tmppath);
+
+  if (rv || !(journal->fp = fopen (path, "a")))
+  {
+    fprintf (stderr, "Cannot write journal %s (%s)\n", path, strerror (errno));
+    journal_close (&journal);
+    return NULL;
+  }
+
+  return journal;
+} /* End of journal_open() */
+
+/*********************************************************************
+ * journal_lookup:
+ *
+ * Look up the record of a file.  Any of the returned values may be
+ * skipped with a NULL pointer.  The output path, NULL if none was
+ * recorded, is valid until the file is recorded again.
+ *
+ * Returns 1 and the size, modification time, hash, options hash,
+ * status and output recorded if the file is in the journal, otherwise
+ * 0.
+ *********************************************************************/
+int
+journal_lookup (Journal *journal, const char *path, int64_t *size,
+                int64_t *mtime, uint64_t *hash, uint32_t *options,
+                int *status, const char **output)
+{
+  struct entry *entry;
+
+  if (!(entry = findentry (journal, path, 0)) || !entry->status)
+    return 0;
+
+  if (size)
+    *size = entry->size;
+  if (mtime)
+    *mtime = entry->mtime;
+  if (hash)
+    *hash = entry->hash;
+  if (options)
+    *options = entry->options;
+  if (status)
+    *status = entry->status;
+  if (output)
+    *output = entry->output;
+
+  return 1;
+} /* End of journal_lookup() */
+
+/*********************************************************************
+ * journal_record:
+ *
+ * Record the state of a file, with its content hash, 0 if unknown,
+ * the hash of the options it was processed with and the output file
+ * written, NULL if none, and append the record to the journal.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+journal_record (Journal *journal, const char *path, int64_t size,
+                int64_t mtime, uint64_t hash, uint32_t options,
+                int status, const char *output)
+{
+  struct entry *entry;
+
+  if (!(entry = findentry (journal, path, 1)) ||
+      setentry (entry, size, mtime, hash, options, status, output))
+    return -1;
+
+  if (fprintf (journal->fp, "%c %lld %lld %016llx %08x %s%s%s\n", status,
+               (long long int)size, (long long int)mtime,
+               (unsigned long long int)hash, (unsigned int)options, path,
+               (output) ? "\t" : "", (output) ? output : "") < 0 ||
+      fflush (journal->fp))
+  {
+    fprintf (stderr, "Cannot write journal %s (%s)\n", journal->path, strerror (errno));
+    return -1;
+  }
+
+  return 0;
+} /* End of journal_record() */
+
+/*********************************************************************
+ * journal_hashfile:
+ *
+ * Compute the content hash of a file, never 0.
+ *
+ * Returns 0 on success and -1 on error with errno set.
+ *********************************************************************/
+int
+journal_hashfile (const char *path, uint64_t *hash)
+{
+  unsigned char *buf;
+  uint64_t word;
+  uint64_t h = 14695981039346656037ULL;
+  size_t nread;
+  size_t idx;
+  FILE *fp;
+  int rv = 0;
+
+  if (!(buf = (unsigned char *)malloc (JOURNAL_HASHBUFSIZE)))
+    return -1;
+
+  if (!(fp = fopen (path, "rb")))
+  {
+    free (buf);
+    return -1;
+  }
+
+  /* Whole words of each buffer, the bytes of a short last read */
+  while ((nread = fread (buf, 1, JOURNAL_HASHBUFSIZE, fp)) > 0)
+  {
+    for (idx = 0; idx + 8 <= nread; idx += 8)
+    {
+      memcpy (&word, buf + idx, 8);
+      h ^= word;
+      h *= 1099511628211ULL;
+    }
+
+    for (; idx < nread; idx++)
+    {
+      h ^= buf[idx];
+      h *= 1099511628211ULL;
+    }
+  }
+
+  if (ferror (fp))
+    rv = -1;
+
+  fclose (fp);
+  free (buf);
+
+  *hash = (h) ? h : 1;
+
+  return rv;
+} /* End of journal_hashfile() */
+
+/*********************************************************************
+ * journal_close:
+ *
+ * Close and free a journal.
+ *********************************************************************/
+void
+journal_close (Journal **pjournal)
+{
+  struct entry *entry;
+  struct entry *next;
+  int idx;
+
+  if (!pjournal || !*pjournal)
+    return;
+
+  for (idx = 0; idx < JOURNAL_BUCKETS; idx++)
+  {
+    for (entry = (*pjournal)->buckets[idx]; entry; entry = next)
+    {
+      next = entry->next;
+      free (entry->path);
+      free (entry->output);
+      free (entry);
+    }
+  }
+
+  if ((*pjournal)->fp)
+    fclose ((*pjournal)->fp);
+
+  free ((*pjournal)->path);
+  free (*pjournal);
+  *pjournal = NULL;
+} /* End of journal_close() */
+
+/*********************************************************************
+ * findentry:
+ *
+ * Find the record of a file, optionally adding an empty record.
+ *
+ * Returns the record, or NULL if not found or on error.
+ *********************************************************************/
+static struct entry *
+findentry (Journal *journal, const char *path, int add)
+{
+  struct entry *entry;
+  unsigned int bucket = fnv_hashstr (path) % JOURNAL_BUCKETS;
+
+  for (entry = journal->buckets[bucket]; entry; entry = entry->next)
+  {
+    if (!strcmp (entry->path, path))
+      return entry;
+  }
+
+  if (!add)
+    return NULL;
+
+  if (!(entry = (struct entry *)calloc (1, sizeof (struct entry))) ||
+      !(entry->path = strdup (path)))
+  {
+    fprintf (stderr, "findentry(): Cannot allocate memory\n");
+    free (entry);
+    return NULL;
+  }
+
+  entry->next              = journal->buckets[bucket];
+  journal->buckets[bucket] = entry;
+
+  return entry;
+} /* End of findentry() */
+
+/*********************************************************************
+ * setentry:
+ *
+ * Set the recorded state of a file.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+setentry (struct entry *entry, int64_t size, int64_t mtime,
+          uint64_t hash, uint32_t options, int status, const char *output)
+{
+  char *copy = NULL;
+
+  if (output && !(copy = strdup (output)))
+  {
+    fprintf (stderr, "setentry(): Cannot allocate memory\n");
+    return -1;
+  }
+
+  free (entry->output);
+
+  entry->size   = size;
+  entry->mtime  = mtime;
+  entry->hash    = hash;
+  entry->options = options;
+  entry->status  = status;
+  entry->output  = copy;
+
+  return 0;
+} /* End of setentry() */
+
+/*********************************************************************
+ * writeentries:
+ *
+ * Write all records with a state to a file.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+writeentries (Journal *journal, FILE *fp)
+{
+  struct entry *entry;
+  int idx;
+
+  for (idx = 0; idx < JOURNAL_BUCKETS; idx++)
+  {
+    for (entry = journal->buckets[idx]; entry; entry = entry->next)
+    {
+      if (entry->status &&
+          fprintf (fp, "%c %lld %lld %016llx %08x %s%s%s\n", entry->status,
+                   (long long int)entry->size, (long long int)entry->mtime,
+                   (unsigned long long int)entry->hash,
+                   (unsigned int)entry->options, entry->path,
+                   (entry->output) ? "\t" : "", (entry->output) ? entry->output : "") < 0)
+        return -1;
+    }
+  }
+
+  return 0;
+} /* End of writeentries() */
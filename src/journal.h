@@ -0,0 +1,32 @@
+/* State journal of processed files */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* File states */
+#define JOURNAL_CONVERTED 'C' /* File was converted */
+#define JOURNAL_FAILED    'F' /* File conversion failed */
+
+typedef struct Journal_s Journal;
+
+Journal *journal_open (const char *path);
+int journal_lookup (Journal *journal, const char *path, int64_t *size,
+                    int64_t *mtime, uint64_t *hash, uint32_t *options,
+                    int *status, const char **output);
+int journal_record (Journal *journal, const char *path, int64_t size,
+                    int64_t mtime, uint64_t hash, uint32_t options,
+                    int status, const char *output);
+int journal_hashfile (const char *path, uint64_t *hash);
+void journal_close (Journal **pjournal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JOURNAL_H */
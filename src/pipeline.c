@@ -0,0 +1,328 @@
+/*********************************************************************
+ * pipeline.c
+ *
+ * Stage threads connected by bounded single producer, single
+ * consumer queues.
+ *
+ * A queue is a ring of item pointers with the producer owning the
+ * tail and the consumer owning the head, items are passed without
+ * locking.  Only when the ring is full, or empty, does the producer,
+ * or consumer, sleep on a condition variable until the other side
+ * makes progress, which bounds the items in flight between stages.
+ *
+ * Each queue counts the items passed, the occupancy seen by the
+ * producer and the waits on either side, reported with the stage
+ * statistics when the queue is freed.
+ *
+ * On platforms without POSIX threads no queues or threads are
+ * created and callers run the stages serially.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#define PIPELINE_PTHREADS 1
+#include <pthread.h>
+#endif
+
+#include "pipeline.h"
+#include "stats.h"
+
+#ifdef PIPELINE_PTHREADS
+struct PipeQueue_s
+{
+  const char *name;          /* Queue name for statistics */
+  unsigned size;             /* Ring size, a power of 2 */
+  unsigned mask;             /* Ring index mask */
+  int depth;                 /* Maximum items in the queue */
+  void **items;              /* Ring of item pointers */
+  char pad0[64];
+  unsigned head;             /* Next item to pop, consumer owned */
+  int consumerwait;          /* Consumer is waiting for an item */
+  int64_t emptywaits;        /* Pops that waited for an item */
+  char pad1[64];
+  unsigned tail;             /* Next item to push, producer owned */
+  int producerwait;          /* Producer is waiting for space */
+  int64_t pushes;            /* Items pushed */
+  int64_t occupancy;         /* Sum of occupancy after each push */
+  int maxoccupancy;          /* Maximum occupancy after a push */
+  int64_t fullwaits;         /* Pushes that waited for space */
+  char pad2[64];
+  pthread_mutex_t lock;      /* Protects sleeping and waking only */
+  pthread_cond_t notempty;   /* Signaled when an item is pushed */
+  pthread_cond_t notfull;    /* Signaled when an item is popped */
+};
+
+struct PipeThread_s
+{
+  pthread_t thread;
+  pipe_func func;
+  void *arg;
+};
+#endif
+
+/*********************************************************************
+ * pipequeue_init:
+ *
+ * Create a queue holding at most depth items.
+ *
+ * Returns a new PipeQueue on success and NULL on error or when
+ * threads are not supported.
+ *********************************************************************/
+PipeQueue *
+pipequeue_init (const char *name, int depth)
+{
+#ifdef PIPELINE_PTHREADS
+  PipeQueue *queue;
+  unsigned size = 1;
+
+  if (depth < 1)
+    return NULL;
+
+  while (size < (unsigned)depth)
+    size <<= 1;
+
+  if (!(queue = (PipeQueue *)calloc (1, sizeof (PipeQueue))) ||
+      !(queue->items = (void **)calloc (size, sizeof (void *))))
+  {
+    fprintf (stderr, "pipequeue_init(): Cannot allocate memory\n");
+    free (queue);
+    return NULL;
+  }
+
+  queue->name  = name;
+  queue->size  = size;
+  queue->mask  = size - 1;
+  queue->depth = depth;
+
+  pthread_mutex_init (&queue->lock, NULL);
+  pthread_cond_init (&queue->notempty, NULL);
+  pthread_cond_init (&queue->notfull, NULL);
+
+  return queue;
+#else
+  return NULL;
+#endif
+} /* End of pipequeue_init() */
+
+/*********************************************************************
+ * pipequeue_push:
+ *
+ * Add an item to the queue, waiting while the queue is full.  Only
+ * one thread may push to a queue.
+ *********************************************************************/
+void
+pipequeue_push (PipeQueue *queue, void *item)
+{
+#ifdef PIPELINE_PTHREADS
+  unsigned tail = queue->tail;
+  unsigned head = __atomic_load_n (&queue->head, __ATOMIC_ACQUIRE);
+  int occupancy;
+
+  if (tail - head >= (unsigned)queue->depth)
+  {
+    queue->fullwaits++;
+
+    /* The consumer sees the wait flag or this thread sees its pop */
+    pthread_mutex_lock (&queue->lock);
+    __atomic_store_n (&queue->producerwait, 1, __ATOMIC_SEQ_CST);
+
+    while (tail - __atomic_load_n (&queue->head, __ATOMIC_SEQ_CST) >= (unsigned)queue->depth)
+      pthread_cond_wait (&queue->notfull, &queue->lock);
+
+    __atomic_store_n (&queue->producerwait, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock (&queue->lock);
+  }
+
+  queue->items[tail & queue->mask] = item;
+
+  /* Publish the item before the tail */
+  __atomic_store_n (&queue->tail, tail + 1, __ATOMIC_SEQ_CST);
+
+  occupancy = (int)(tail + 1 - __atomic_load_n (&queue->head, __ATOMIC_RELAXED));
+  queue->pushes++;
+  queue->occupancy += occupancy;
+  if (occupancy > queue->maxoccupancy)
+    queue->maxoccupancy = occupancy;
+
+  if (__atomic_load_n (&queue->consumerwait, __ATOMIC_SEQ_CST))
+  {
+    pthread_mutex_lock (&queue->lock);
+    pthread_cond_signal (&queue->notempty);
+    pthread_mutex_unlock (&queue->lock);
+  }
+#endif
+} /* End of pipequeue_push() */
+
+/*********************************************************************
+ * pipequeue_pop:
+ *
+ * Remove the oldest item from the queue, waiting while the queue is
+ * empty.  Only one thread may pop from a queue.
+ *
+ * Returns the item.
+ *********************************************************************/
+void *
+pipequeue_pop (PipeQueue *queue)
+{
+#ifdef PIPELINE_PTHREADS
+  unsigned head = queue->head;
+  void *item;
+
+  if (__atomic_load_n (&queue->tail, __ATOMIC_ACQUIRE) == head)
+  {
+    queue->emptywaits++;
+
+    /* The producer sees the wait flag or this thread sees its push */
+    pthread_mutex_lock (&queue->lock);
+    __atomic_store_n (&queue->consumerwait, 1, __ATOMIC_SEQ_CST);
+
+    while (__atomic_load_n (&queue->tail, __ATOMIC_SEQ_CST) == head)
+      pthread_cond_wait (&queue->notempty, &queue->lock);
+
+    __atomic_store_n (&queue->consumerwait, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock (&queue->lock);
+  }
+
+  item = queue->items[head & queue->mask];
+
+  /* Release the slot after the item is read */
+  __atomic_store_n (&queue->head, head + 1, __ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n (&queue->producerwait, __ATOMIC_SEQ_CST))
+  {
+    pthread_mutex_lock (&queue->lock);
+    pthread_cond_signal (&queue->notfull);
+    pthread_mutex_unlock (&queue->lock);
+  }
+
+  return item;
+#else
+  return NULL;
+#endif
+} /* End of pipequeue_pop() */
+
+/*********************************************************************
+ * pipequeue_count:
+ *
+ * Returns the number of items in the queue, exact only when called
+ * by the producer or consumer.
+ *********************************************************************/
+int
+pipequeue_count (PipeQueue *queue)
+{
+#ifdef PIPELINE_PTHREADS
+  return (int)(__atomic_load_n (&queue->tail, __ATOMIC_ACQUIRE) -
+               __atomic_load_n (&queue->head, __ATOMIC_ACQUIRE));
+#else
+  return 0;
+#endif
+} /* End of pipequeue_count() */
+
+/*********************************************************************
+ * pipequeue_free:
+ *
+ * Report the queue counters when statistics are collected and free
+ * the queue.  No threads may be using the queue.
+ *********************************************************************/
+void
+pipequeue_free (PipeQueue **pqueue)
+{
+#ifdef PIPELINE_PTHREADS
+  PipeQueue *queue;
+
+  if (!pqueue || !*pqueue)
+    return;
+
+  queue = *pqueue;
+
+  if (stats_enabled)
+    stats_queue (queue->name, queue->depth, queue->pushes,
+                 (queue->pushes) ? (double)queue->occupancy / queue->pushes : 0.0,
+                 queue->maxoccupancy, queue->fullwaits, queue->emptywaits);
+
+  pthread_cond_destroy (&queue->notfull);
+  pthread_cond_destroy (&queue->notempty);
+  pthread_mutex_destroy (&queue->lock);
+
+  free (queue->items);
+  free (queue);
+  *pqueue = NULL;
+#endif
+} /* End of pipequeue_free() */
+
+#ifdef PIPELINE_PTHREADS
+/*********************************************************************
+ * pipethread_main:
+ *
+ * Run a stage function in a new thread.
+ *********************************************************************/
+static void *
+pipethread_main (void *arg)
+{
+  PipeThread *thread = (PipeThread *)arg;
+
+  thread->func (thread->arg);
+
+  return NULL;
+} /* End of pipethread_main() */
+#endif
+
+/*********************************************************************
+ * pipethread_start:
+ *
+ * Start a thread running a stage function.
+ *
+ * Returns a new PipeThread on success and NULL on error or when
+ * threads are not supported.
+ *********************************************************************/
+PipeThread *
+pipethread_start (pipe_func func, void *arg)
+{
+#ifdef PIPELINE_PTHREADS
+  PipeThread *thread;
+
+  if (!(thread = (PipeThread *)calloc (1, sizeof (PipeThread))))
+  {
+    fprintf (stderr, "pipethread_start(): Cannot allocate memory\n");
+    return NULL;
+  }
+
+  thread->func = func;
+  thread->arg  = arg;
+
+  if (pthread_create (&thread->thread, NULL, pipethread_main, thread))
+  {
+    fprintf (stderr, "pipethread_start(): Cannot create thread\n");
+    free (thread);
+    return NULL;
+  }
+
+  return thread;
+#else
+  return NULL;
+#endif
+} /* End of pipethread_start() */
+
+/*********************************************************************
+ * pipethread_join:
+ *
+ * Wait for a stage thread to finish and free it.
+ *********************************************************************/
+void
+pipethread_join (PipeThread **pthread)
+{
+#ifdef PIPELINE_PTHREADS
+  if (!pthread || !*pthread)
+    return;
+
+  pthread_join ((*pthread)->thread, NULL);
+
+  free (*pthread);
+  *pthread = NULL;
+#endif
+} /* End of pipethread_join() */
@@ -0,0 +1,28 @@
+/* Stage threads connected by single producer, single consumer queues */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PipeQueue_s PipeQueue;
+typedef struct PipeThread_s PipeThread;
+
+/* Stage thread function */
+typedef void (*pipe_func) (void *arg);
+
+PipeQueue *pipequeue_init (const char *name, int depth);
+void pipequeue_push (PipeQueue *queue, void *item);
+void *pipequeue_pop (PipeQueue *queue);
+int pipequeue_count (PipeQueue *queue);
+void pipequeue_free (PipeQueue **pqueue);
+PipeThread *pipethread_start (pipe_func func, void *arg);
+void pipethread_join (PipeThread **pthread);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIPELINE_H */
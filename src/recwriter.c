@@ -0,0 +1,405 @@
+/*********************************************************************
+ * recwriter.c
+ *
+ * Buffered output of packed records.
+ *
+ * Records are gathered in a large, page aligned buffer and written
+ * with a single write() when the buffer is full, instead of a stdio
+ * call for each record.  The buffer is always flushed when the
+ * writer is closed.
+ *
+ * With asynchronous I/O two buffers are used: a full buffer is
+ * queued for writing while records are gathered in the other, so
+ * writing overlaps with packing.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#define RECWRITER_WIN32 1
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "recwriter.h"
+
+/* Alignment of the buffer, a memory page */
+#define RECWRITER_ALIGN 4096
+
+struct RecWriter_s
+{
+  int fd;           /* Output file descriptor */
+  int closefd;      /* Close fd when closing, not for stdout */
+  char *path;       /* Output path for messages */
+  char *buf;        /* Gathered records */
+  size_t len;       /* Bytes in buffer */
+  size_t size;      /* Buffer size, bytes written at once */
+  AsyncIO *aio;     /* Asynchronous I/O, NULL for blocking writes */
+  char *spare;      /* Second buffer, written while buf is filled */
+  AsyncIOReq req;   /* Write of the spare buffer */
+  int pending;      /* Non-zero while the spare buffer is written */
+};
+
+static RecWriter *openwriter (const char *path, int64_t offset, size_t bufsize,
+                              AsyncIO *aio);
+static int openappend (const char *path, int64_t offset);
+static char *allocbuffer (size_t size);
+static int waitwrite (RecWriter *rw);
+static int writeall (RecWriter *rw, const char *data, size_t len);
+
+/*********************************************************************
+ * recwriter_open:
+ *
+ * Open an output file for writing records, gathering up to bufsize
+ * bytes before each write.  If the path is "-" records are written
+ * to stdout.  If aio is not NULL buffers are written asynchronously.
+ *
+ * Returns a new RecWriter on success and NULL on error.
+ *********************************************************************/
+RecWriter *
+recwriter_open (const char *path, size_t bufsize, AsyncIO *aio)
+{
+  return openwriter (path, -1, bufsize, aio);
+} /* End of recwriter_open() */
+
+/*********************************************************************
+ * recwriter_append:
+ *
+ * Open an existing output file for appending records at offset, as
+ * recwriter_open().  The file is truncated to offset first, anything
+ * written after it is dropped.  With offset RECWRITER_END records are
+ * appended at the end of the file, created if it does not exist, also
+ * when other writers append to it.
+ *
+ * Returns a new RecWriter on success and NULL on error.
+ *********************************************************************/
+RecWriter *
+recwriter_append (const char *path, int64_t offset, size_t bufsize, AsyncIO *aio)
+{
+  if (offset < 0 && offset != RECWRITER_END)
+    return NULL;
+
+  return openwriter (path, offset, bufsize, aio);
+} /* End of recwriter_append() */
+
+/*********************************************************************
+ * openwriter:
+ *
+ * Open a RecWriter, creating the output file if offset is -1 and
+ * otherwise appending at offset or RECWRITER_END.
+ *
+ * Returns a new RecWriter on success and NULL on error.
+ *********************************************************************/
+static RecWriter *
+openwriter (const char *path, int64_t offset, size_t bufsize, AsyncIO *aio)
+{
+  RecWriter *rw;
+
+  if (!path)
+    return NULL;
+
+  if (bufsize < RECWRITER_ALIGN)
+    bufsize = RECWRITER_ALIGN;
+
+  if (!(rw = (RecWriter *)calloc (1, sizeof (RecWriter))) ||
+      !(rw->path = strdup (path)))
+  {
+    fprintf (stderr, "openwriter(): Cannot allocate memory\n");
+    free (rw);
+    return NULL;
+  }
+
+  rw->size = bufsize;
+  rw->aio  = aio;
+  rw->buf  = allocbuffer (bufsize);
+
+  if (aio)
+    rw->spare = allocbuffer (bufsize);
+
+  if (!rw->buf || (aio && !rw->spare))
+  {
+    fprintf (stderr, "openwriter(): Cannot allocate buffer of %lu bytes\n",
+             (unsigned long)bufsize);
+    free (rw->buf);
+    free (rw->spare);
+    free (rw->path);
+    free (rw);
+    return NULL;
+  }
+
+  if (strcmp (path, "-") == 0)
+  {
+#if defined(RECWRITER_WIN32)
+    _setmode (_fileno (stdout), _O_BINARY);
+#endif
+    fflush (stdout);
+    rw->fd      = fileno (stdout);
+    rw->closefd = 0;
+  }
+  else
+  {
+    rw->fd      = (offset == -1) ? asyncio_open (path, 1) : openappend (path, offset);
+    rw->closefd = 1;
+  }
+
+  if (rw->fd < 0)
+  {
+    fprintf (stderr, "Cannot open output file: %s (%s)\n", path, strerror (errno));
+    free (rw->buf);
+    free (rw->spare);
+    free (rw->path);
+    free (rw);
+    return NULL;
+  }
+
+  return rw;
+} /* End of openwriter() */
+
+/*********************************************************************
+ * recwriter_write:
+ *
+ * Add a record to the buffer, writing the buffer first if the record
+ * does not fit.  Records larger than the buffer are written directly.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+recwriter_write (RecWriter *rw, const char *record, int reclen)
+{
+  if (!rw || !record || reclen < 0)
+    return -1;
+
+  if (rw->len + reclen > rw->size && recwriter_flush (rw))
+    return -1;
+
+  if ((size_t)reclen > rw->size)
+  {
+    if (waitwrite (rw))
+      return -1;
+
+    return writeall (rw, record, reclen);
+  }
+
+  memcpy (rw->buf + rw->len, record, reclen);
+  rw->len += reclen;
+
+  return 0;
+} /* End of recwriter_write() */
+
+/*********************************************************************
+ * recwriter_flush:
+ *
+ * Write all buffered records.  With asynchronous I/O the buffer is
+ * queued for writing after the previous write completes, the records
+ * are written when this returns only after recwriter_close().
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+recwriter_flush (RecWriter *rw)
+{
+  char *buf;
+  int rv;
+
+  if (!rw)
+    return -1;
+
+  if (rw->len == 0)
+    return 0;
+
+  if (!rw->aio)
+  {
+    rv      = writeall (rw, rw->buf, rw->len);
+    rw->len = 0;
+
+    return rv;
+  }
+
+  /* Writes are at the current position, only one is queued at a time */
+  if (waitwrite (rw))
+    return -1;
+
+  if (asyncio_write (rw->aio, &rw->req, rw->fd, rw->buf, rw->len, -1))
+    return -1;
+
+  rw->pending = 1;
+
+  /* Gather records in the other buffer while this one is written */
+  buf       = rw->spare;
+  rw->spare = rw->buf;
+  rw->buf   = buf;
+  rw->len   = 0;
+
+  return 0;
+} /* End of recwriter_flush() */
+
+/*********************************************************************
+ * recwriter_close:
+ *
+ * Flush the buffered records, wait for queued writes to complete,
+ * close the output file and free the writer.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+recwriter_close (RecWriter **prw)
+{
+  RecWriter *rw;
+  int rv;
+
+  if (!prw || !*prw)
+    return -1;
+
+  rw = *prw;
+  rv = recwriter_flush (rw);
+
+  if (waitwrite (rw))
+    rv = -1;
+
+  if (rw->closefd && asyncio_close (rw->fd))
+  {
+    fprintf (stderr, "Error closing output file: %s (%s)\n", rw->path, strerror (errno));
+    rv = -1;
+  }
+
+  free (rw->buf);
+  free (rw->spare);
+  free (rw->path);
+  free (rw);
+  *prw = NULL;
+
+  return rv;
+} /* End of recwriter_close() */
+
+/*********************************************************************
+ * openappend:
+ *
+ * Open an existing file for writing at offset, truncated to offset,
+ * or with a negative offset for appending at its end, created if it
+ * does not exist.
+ *
+ * Returns the file descriptor on success and -1 on error with errno
+ * set.
+ *********************************************************************/
+static int
+openappend (const char *path, int64_t offset)
+{
+  int fd;
+
+#if defined(RECWRITER_WIN32)
+  if (offset < 0)
+    return _open (path, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+
+  if ((fd = _open (path, _O_WRONLY | _O_BINARY)) < 0)
+    return -1;
+
+  if (_chsize_s (fd, offset) || _lseeki64 (fd, offset, SEEK_SET) < 0)
+#else
+  if (offset < 0)
+    return open (path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+
+  if ((fd = open (path, O_WRONLY)) < 0)
+    return -1;
+
+  if (ftruncate (fd, (off_t)offset) || lseek (fd, (off_t)offset, SEEK_SET) < 0)
+#endif
+  {
+    asyncio_close (fd);
+    return -1;
+  }
+
+  return fd;
+} /* End of openappend() */
+
+/*********************************************************************
+ * allocbuffer:
+ *
+ * Returns a page aligned buffer on success and NULL on error.
+ *********************************************************************/
+static char *
+allocbuffer (size_t size)
+{
+  char *buf;
+
+#if defined(RECWRITER_WIN32)
+  buf = (char *)malloc (size);
+#else
+  if (posix_memalign ((void **)&buf, RECWRITER_ALIGN, size))
+    buf = NULL;
+#endif
+
+  return buf;
+} /* End of allocbuffer() */
+
+/*********************************************************************
+ * waitwrite:
+ *
+ * Wait for a queued write to complete.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+waitwrite (RecWriter *rw)
+{
+  long nwritten;
+
+  if (!rw->pending)
+    return 0;
+
+  rw->pending = 0;
+  nwritten    = asyncio_wait (rw->aio, &rw->req);
+
+  if (nwritten < 0 || (size_t)nwritten != rw->req.len)
+  {
+    fprintf (stderr, "Error writing to output file: %s (%s)\n", rw->path,
+             strerror ((nwritten < 0) ? (int)-nwritten : EIO));
+    return -1;
+  }
+
+  return 0;
+} /* End of waitwrite() */
+
+/*********************************************************************
+ * writeall:
+ *
+ * Write all bytes, continuing after partial writes and interrupts.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+writeall (RecWriter *rw, const char *data, size_t len)
+{
+  long nwritten;
+
+  while (len > 0)
+  {
+#if defined(RECWRITER_WIN32)
+    nwritten = _write (rw->fd, data, (unsigned int)len);
+#else
+    nwritten = (long)write (rw->fd, data, len);
+#endif
+
+    if (nwritten < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      fprintf (stderr, "Error writing to output file: %s (%s)\n", rw->path, strerror (errno));
+      return -1;
+    }
+
+    data += nwritten;
+    len -= nwritten;
+  }
+
+  return 0;
+} /* End of writeall() */
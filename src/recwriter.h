@@ -0,0 +1,34 @@
+/* Buffered output of packed records with batched writes */
+
+#ifndef RECWRITER_H
+#define RECWRITER_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "asyncio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default number of bytes gathered before writing */
+#define RECWRITER_DEFAULTSIZE (1024 * 1024)
+
+/* Offset of recwriter_append() appending at the end of the file */
+#define RECWRITER_END -2
+
+typedef struct RecWriter_s RecWriter;
+
+RecWriter *recwriter_open (const char *path, size_t bufsize, AsyncIO *aio);
+RecWriter *recwriter_append (const char *path, int64_t offset, size_t bufsize,
+                             AsyncIO *aio);
+int recwriter_write (RecWriter *rw, const char *record, int reclen);
+int recwriter_flush (RecWriter *rw);
+int recwriter_close (RecWriter **prw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RECWRITER_H */
@@ -5,22 +5,38 @@
  *
  * Written by Chad Trabant, IRIS Data Management Center
  *
- * modified 2016.341
+ * modified 2026.292
  ***************************************************************************/
 
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <time.h>
 
 #include <libmseed.h>
 
+#include "archive.h"
+#include "asyncio.h"
+#include "checkpoint.h"
 #include "decimate.h"
-#include "sdrformat.h"
-
-#define VERSION "0.4"
+#include "dlclient.h"
+#include "fnv.h"
+#include "journal.h"
+#include "pipeline.h"
+#include "sdrdecode.h"
+#include "sdrindex.h"
+#include "recwriter.h"
+#include "stats.h"
+#include "tpool.h"
+#include "watch.h"
+
+#define VERSION "0.5"
 #define PACKAGE "sdr2mseed"
 
 struct listnode
@@ -30,791 +46,3870 @@ struct listnode
   struct listnode *next;
 };
 
-static int parseSDR (char *sdrfile, MSTraceGroup *mstg);
-static int sdr2group (FILE *ifp, MSTraceGroup *mstg, int format, char *sdrfile, int verbose);
-static int decompressSDR (HeaderBlock *sh, InfoBlock *iblock, int blocknum, int16_t *i16data);
-static int normalizeSDR24 (HeaderBlock *hblock, InfoBlock *iblock, int blocknum, int32_t *i32data);
-static int decimate (MSTrace *mst, int factor);
+/* Maximum number of decimation operations per product */
+#define MAX_DECIMATION 8
+
+/* Maximum number of output rate products */
+#define MAX_PRODUCTS 8
+
+/* Maximum number of decimation tree nodes, node 0 is the input */
+#define MAX_NODES (MAX_PRODUCTS * MAX_DECIMATION + 1)
+
+/* Output rate product, a decimation ratio with its own channel codes */
+struct product
+{
+  int ratio;                   /* Decimation ratio from the input rate */
+  double rate;                 /* Target sample rate, ratio planned per input */
+  int factors[MAX_DECIMATION]; /* Explicit decimation factors */
+  int nfactors;                /* Number of explicit factors, 0 to plan */
+  char *channel[MAX_CHANNELS]; /* SEED channel codes */
+  int node;                    /* Decimation tree node producing the output */
+};
+
+/* Decimation tree node, a stage applied to the output of the parent
+ * node.  Products with common leading stages share the nodes. */
+struct decimnode
+{
+  int parent; /* Parent node, always a lower index */
+  int factor; /* Stage decimation factor */
+  int ratio;  /* Total decimation ratio from the input */
+};
+
+/* Per-channel decimation stream, the filter state is carried across
+ * blocks and, when writing to a single output, across input files */
+struct decimstream
+{
+  DecimState *stage[MAX_NODES];  /* Decimator for each tree node */
+  void *work[MAX_NODES];         /* Node output buffers of sampletype */
+  int worksize[MAX_NODES];       /* Allocated sample counts of work buffers */
+  int nout[MAX_NODES];           /* Node output samples of the last run */
+  int64_t outsamples[MAX_NODES]; /* Node output samples in segment */
+  hptime_t starttime;            /* Time of first input sample in segment */
+  double samprate;               /* Input sample rate */
+  int64_t insamples;             /* Input samples in segment */
+};
+
+/* Decimation job for a channel block, run on the thread pool */
+struct decimjob
+{
+  struct decimstream *dstream; /* Channel decimation stream */
+  void *input;                 /* Channel block samples */
+  int nin;                     /* Number of samples in block */
+  int rv;                      /* Result of runtree() */
+};
+
+/* Number of data block reads queued ahead of the block being converted */
+#define READAHEAD 4
+
+/* Queued read of a data block */
+struct blockread
+{
+  AsyncIOReq req; /* Read request */
+  char *buf;      /* Data block buffer */
+  int size;       /* Allocated buffer size */
+};
+
+/* Input file with queued reads of the header and the following data
+ * blocks.  The next input file is opened, its header read and the
+ * kernel advised to read it into the page cache while the current
+ * file is converted, and its first blocks are queued when all blocks
+ * of the current file are. */
+struct sdrinput
+{
+  char *path;                        /* Input file path, NULL when closed */
+  int fd;                            /* File descriptor */
+  HeaderBlock hblock;                /* Header block */
+  AsyncIOReq hreq;                   /* Header block read */
+  int hpending;                      /* Header block read not waited for */
+  int hvalid;                        /* Complete header block was read */
+  AsyncIOReq areq;                   /* Page cache read-ahead advice */
+  int apending;                      /* Advice not waited for */
+  struct blockread reads[READAHEAD]; /* Data block reads, a ring */
+  int head;                          /* Oldest queued data block read */
+  int nqueued;                       /* Number of queued data block reads */
+  int first;                         /* First info block in the time window */
+  int end;                           /* Info block after the time window */
+  int next;                          /* Next info block to queue */
+  int64_t size;                      /* File size when opened */
+  int64_t mtime;                     /* Modification time when opened */
+  struct sdrinput *following;        /* Next input file or NULL */
+  Checkpoint *checkpoint;            /* Checkpoint to resume from or NULL */
+};
+
+/* Input file being converted */
+struct sdrfile
+{
+  char *path;             /* Input file path */
+  HeaderBlock hblock;     /* Header block */
+  int version;            /* Header version */
+  int failed;             /* Conversion failed, nothing is packed */
+  int first;              /* First info block in the time window */
+  int end;                /* Info block after the time window */
+  int converted;          /* Number of blocks converted */
+  MSRecord *msr;          /* Holder of channel blocks added to the group */
+  SDRIndex *index;        /* Index built while converting, NULL if none */
+  Checkpoint *checkpoint; /* Checkpoint resumed from, NULL if none */
+  int lastblock;          /* Last converted info block, -1 if none */
+  int64_t size;           /* File size when opened */
+  int64_t mtime;          /* Modification time when opened */
+};
+
+/* Block types passed through the pipeline */
+#define BLOCK_DATA  0 /* Data block of a file */
+#define BLOCK_START 1 /* Start of a file, before its data blocks */
+#define BLOCK_END   2 /* End of a file, after its data blocks */
+#define BLOCK_STOP  3 /* End of all files */
+
+/* Data block read, decoded and converted, the buffers only grow and
+ * are reused for following blocks */
+struct sdrblock
+{
+  int type;                      /* Block type, BLOCK_* */
+  struct sdrfile *file;          /* Input file of the block */
+  int idx;                       /* File info block index */
+  int valid;                     /* Block was decoded */
+  char *raw;                     /* Data block as read */
+  int rawsize;                   /* Allocated size of raw */
+  void *muxed;                   /* Multiplexed samples */
+  int muxedsize;                 /* Allocated size of muxed */
+  int32_t *cdata;                /* Demultiplexed channel samples */
+  int cdatasize;                 /* Allocated size of cdata */
+  void *chandata[MAX_CHANNELS];  /* Channel samples in cdata, NULL if not requested */
+  int chansamples[MAX_CHANNELS]; /* Channel sample counts */
+  hptime_t starttime;            /* Time of first sample */
+};
+
+/* Maximum number of blocks queued between pipeline stages */
+#define PIPEDEPTH 4
+
+/* Statistics thread indexes of the pipeline reader and decoder */
+#define READTHREAD   (STATS_MAXTHREADS - 3)
+#define DECODETHREAD (STATS_MAXTHREADS - 2)
+
+/* Number of packed records queued for the writer thread */
+#define WRITEDEPTH 64
+
+/* Statistics thread index of the writer */
+#define WRITETHREAD (STATS_MAXTHREADS - 4)
+
+/* Packed record in a buffer of the record pool */
+struct recbuf
+{
+  char *record; /* Record buffer */
+  int reclen;   /* Record length, 0 stops the writer */
+};
+
+/* Writer thread of the output file and a fixed pool of record
+ * buffers, filled by the packer and returned by the writer */
+struct recpool
+{
+  PipeQueue *recq;     /* Packed records, packer to writer */
+  PipeQueue *freeq;    /* Written records, writer to packer */
+  PipeThread *writer;  /* Writer thread, NULL when writing inline */
+  struct recbuf *bufs; /* Record buffers */
+  char *data;          /* Memory of all record buffers */
+  int nbufs;           /* Number of record buffers */
+  int reclen;          /* Size of each record buffer */
+  int error;           /* First write error, -1 after a failed write */
+};
+
+/* Number of files scanned in each batch of inventory jobs */
+#define INVENTORYBATCH 256
+
+/* Default number of inventory threads, scanning mostly waits for I/O */
+#define INVENTORYTHREADS 16
+
+/* Inventory of an input file, scanned by a job on the thread pool */
+struct invfile
+{
+  char *path;        /* Input file path */
+  int version;       /* Header version, 0 if the file was not scanned */
+  int samprate;      /* Sample rate */
+  int numchannels;   /* Number of channels */
+  int numblocks;     /* Number of data blocks in the header */
+  hptime_t *starts;  /* Start times of the used data blocks */
+  int *nsamples;     /* Samples per channel of each block, NULL if unknown */
+  int nstarts;       /* Number of start times */
+  int badblocks;     /* Data blocks without a valid info block */
+  char error[300];   /* Error message if the file was not scanned */
+};
+
+/* Queues between the pipeline stages and the blocks passed */
+struct pipeline
+{
+  PipeQueue *readq;        /* Read blocks, reader to decoder */
+  PipeQueue *decodeq;      /* Decoded blocks, decoder to converter */
+  PipeQueue *freeq;        /* Converted blocks, converter to reader */
+  struct sdrblock *blocks; /* All blocks */
+  int nblocks;             /* Number of blocks */
+};
+
+static void convertfiles (MSTraceGroup *mstg);
+static int watchdaemon (MSTraceGroup *mstg);
+static int watchfilter (const char *name);
+static void stopdaemon (int sig);
+static void resetgroup (MSTraceGroup *mstg);
+static int parseSDR (char *sdrfile, char *nextfile, MSTraceGroup *mstg);
+static int runpipeline (MSTraceGroup *mstg);
+static void readstage (void *arg);
+static void decodestage (void *arg);
+static struct sdrinput *selectinput (char *sdrfile, char *nextfile);
+static struct sdrfile *startfile (struct sdrinput *input, char *sdrfile, int thread);
+static int readnext (struct sdrinput *input, struct sdrfile *file, int *idx,
+                     struct sdrblock *block, int thread);
+static int decodeblock (struct sdrblock *block, int thread);
+static void freeblock (struct sdrblock *block);
+static int beginfile (struct sdrfile *file, MSTraceGroup *mstg);
+static int convertblock (struct sdrblock *block, MSTraceGroup *mstg);
+static int endfile (struct sdrfile *file, MSTraceGroup *mstg);
+static int openinput (struct sdrinput *input, char *sdrfile);
+static int waitheader (struct sdrinput *input);
+static int queueblocks (struct sdrinput *input, int depth, char *sdrfile);
+static struct blockread *readblock (struct sdrinput *input, int idx, char *sdrfile);
+static int emptyinfo (FileInfo *finfo);
+static hptime_t blocktime (InfoBlock *iblock);
+static int inventory (void);
+static hptime_t blockspan (struct invfile *inv, int idx);
+static void inventoryjob (void *arg, int thread);
+static void windowblocks (HeaderBlock *hblock, int *first, int *end);
+static int trimblock (struct sdrblock *block, int samprate);
+static hptime_t parsetime (char *timestr);
+static Checkpoint *loadcheckpoint (struct sdrinput *input);
+static int restorecheckpoint (struct sdrfile *file, MSTraceGroup *mstg);
+static int savecheckpoint (struct sdrfile *file, MSTraceGroup *mstg, char *mseedfile);
+static uint32_t infohash (HeaderBlock *hblock, int lastblock);
+static uint32_t optionhash (void);
+static SDRIndex *startindex (struct sdrfile *file);
+static void indexblock (struct sdrblock *block, int mssamples);
+static void writeindex (struct sdrfile *file);
+static void skipindexed (void);
+static int skipunchanged (void);
+static int unchanged (const char *path, int64_t size, int64_t mtime, int *status);
+static int recordfile (const char *path, int64_t size, int64_t mtime, int status,
+                       const char *output);
+static void closeinput (struct sdrinput *input);
+static void freeinput (struct sdrinput *input);
+static int addtogroup (MSTraceGroup *mstg, MSRecord *msr, char *sdrfile);
+static MSRecord *maketemplate (MSRecord *msr);
+static void setchannel (MSRecord *msr, int cidx, struct product *prod);
+static int decimateblock (MSTraceGroup *mstg, MSRecord *msr, void **chandata,
+                          int *chansamples, char *sdrfile);
+static int checkstream (MSTraceGroup *mstg, MSRecord *msr, int cidx, char *sdrfile);
+static void decimatejob (void *arg, int thread);
+static int addproducts (MSTraceGroup *mstg, MSRecord *msr, int cidx, char *sdrfile);
+static int flushstreams (MSTraceGroup *mstg, char *sdrfile);
+static int flushstream (MSTraceGroup *mstg, int cidx, char *sdrfile);
+static int runtree (struct decimstream *dstream, void *input, int nin, flag flush);
+static int planproducts (MSTraceGroup *mstg, double samprate, char *sdrfile);
+static void reportplan (void);
+static int parseproduct (char *spec, struct product *prod);
+static int parsefactors (char *str, struct product *prod);
+static int parsechannels (char *str, char **chanarr);
 static void packtraces (MSTraceGroup *mstg, flag flush);
+static void packlatency (MSTraceGroup *mstg, hptime_t span);
+static void packtrace (MSTrace *mst, flag flush);
 static void record_handler (char *record, int reclen, void *handlerdata);
+static void indexrecord (char *record, int reclen);
+static int writerecord (char *record, int reclen);
+static int openoutput (char *path, int64_t offset);
+static int datalinkreclen (void);
+static int closeoutput (void);
+static int initrecpool (void);
+static void freerecpool (void);
+static void writestage (void *arg);
 static int parameter_proc (int argcount, char **argvec);
 static char *getoptval (int argcount, char **argvec, int argopt);
 static int readlistfile (char *listfile);
 static void addnode (struct listnode **listroot, char *key, char *data);
 static void usage (void);
 
-static int verbose      = 0;
-static int packreclen   = -1;
-static int encoding     = 11;
-static int byteorder    = -1;
-static int sdrformat    = 0;
-static char srateblkt   = 0;
-static char *network    = "XX";
-static char *station    = "SDR";
-static char *location   = "  ";
-static char *channel[MAX_CHANNELS];
-static char *outputfile = 0;
-static FILE *ofp        = 0;
-
-/* Maximum number of decimation operations */
-#define MAX_DECIMATION 8
+static int verbose         = 0;
+static int packreclen      = -1;
+static int encoding        = 11;
+static int byteorder       = -1;
+static char srateblkt      = 0;
+static char *network       = "XX";
+static char *station       = "SDR";
+static char *location      = "  ";
+static char *outputfile    = 0;
+static char *archivedir    = 0;
+static int archivelayout   = 0;
+static int archiveopen     = ARCHIVE_DEFAULTOPEN;
+static double latency      = -1.0;
+static Archive *archive    = 0;
+static char *datalinkaddr  = 0;
+static int datalinkack     = 1;
+static DLClient *datalink  = 0;
+static char *sharedoutput  = 0;
+static hptime_t winstart   = HPTERROR;
+static hptime_t winend     = HPTERROR;
+static int printstats      = 0;
+static char *statsjson     = 0;
+static RecWriter *ofp      = 0;
+static size_t writesize    = RECWRITER_DEFAULTSIZE;
+static int iobackend       = ASYNCIO_AUTO;
+static AsyncIO *inaio      = 0;
+static AsyncIO *outaio     = 0;
+static int pipelined       = -1;
+static int inventorymode   = 0;
+static int inventoryblocks = 0;
+static int invthreads      = 0;
+static int indexing        = 0;
+static int recindex        = 0;
+static FILE *recindexfp    = 0;
+static int64_t outoffset   = 0;
+static MSRecord *indexmsr  = 0;
+static int checkpointing   = 0;
+static int finalckp        = 0;
+static int settle          = 60;
+static char *journalfile   = 0;
+static char *manifestfile  = 0;
+static Journal *journal    = 0;
+static volatile sig_atomic_t stopping = 0;
+static struct sdrinput inputs[2];
+static struct sdrblock serialblock;
+static struct recpool recpool;
 
 static int chanlist[MAX_CHANNELS];
-static int decilist[MAX_DECIMATION];
+static int fixedpoint = 0;
+static char sampletype = 'i';
+static int threads    = 0;
+static TPool *pool    = 0;
+static struct product products[MAX_PRODUCTS];
+static int numproducts = 0;
+static struct decimnode decinodes[MAX_NODES];
+static int numnodes = 0;
+static struct decimstream decistreams[MAX_CHANNELS];
 
 /* A list of input files */
 struct listnode *filelist = 0;
 
+/* A list of directories to watch */
+struct listnode *watchlist = 0;
+
 static int packedtraces      = 0;
 static int64_t packedsamples = 0;
 static int packedrecords     = 0;
+static int convertedfiles    = 0;
+static int failedoutputs     = 0;
 
 int
 main (int argc, char **argv)
 {
   MSTraceGroup *mstg = 0;
-  struct listnode *flp;
 
   /* Process given parameters (command line and parameter file) */
   if (parameter_proc (argc, argv) < 0)
     return -1;
 
+  /* Report coverage from the file headers without converting */
+  if (inventorymode)
+    return inventory ();
+
+  /* Skip files without data in the time window by their index */
+  if (!watchlist && indexing && (winstart != HPTERROR || winend != HPTERROR))
+    skipindexed ();
+
+  /* Skip files converted before and not changed since */
+  if (manifestfile && skipunchanged ())
+    return -1;
+
+  /* Collect statistics only when requested */
+  if (printstats || statsjson)
+    stats_init ();
+
+  /* Initialize asynchronous I/O, separately for reading and writing
+   * as they may be done by different threads */
+  if (!(inaio = asyncio_init (iobackend, ASYNCIO_DEFAULTDEPTH)) ||
+      !(outaio = asyncio_init (iobackend, ASYNCIO_DEFAULTDEPTH)))
+    return -1;
+
+  if (verbose)
+    fprintf (stderr, "I/O backend: %s\n", asyncio_name (asyncio_backend (inaio)));
+
   /* Init MSTraceGroup */
   mstg = mst_initgroup (mstg);
 
-  /* Open the output file if specified */
-  if (outputfile)
+  /* Convert in stage threads by default with more than one CPU */
+  if (pipelined < 0)
+    pipelined = (tpool_cpucount () > 1);
+
+  /* Open the output file if specified, '-' is stdout, the archive or
+   * the DataLink connection */
+  if (sharedoutput)
   {
-    if (strcmp (outputfile, "-") == 0)
-    {
-      ofp = stdout;
-    }
-    else if ((ofp = fopen (outputfile, "wb")) == NULL)
-    {
-      fprintf (stderr, "Cannot open output file: %s (%s)\n",
-               outputfile, strerror (errno));
+    if (openoutput (outputfile, -1))
       return -1;
-    }
   }
 
-  /* Read input files into MSTraceGroup */
-  flp = filelist;
-  while (flp != 0)
+  /* Convert files as they are completed in the watched directories */
+  if (watchlist)
   {
-    if (verbose)
-      fprintf (stderr, "Reading %s\n", flp->data);
-
-    parseSDR (flp->data, mstg);
+    if (watchdaemon (mstg))
+      return -1;
+  }
+  else
+  {
+    convertfiles (mstg);
+  }
 
-    flp = flp->next;
+  /* Flush decimation streams carried across input files */
+  if (sharedoutput && numnodes > 1)
+  {
+    flushstreams (mstg, sharedoutput);
+    packtraces (mstg, 1);
+    packedtraces += mstg->numtraces;
   }
 
+  /* Write remaining records and close the output */
+  if ((ofp || archive || datalink) && closeoutput ())
+    return -1;
+
+  freerecpool ();
+
+  journal_close (&journal);
+
   fprintf (stderr, "Packed %d trace(s) of %lld samples into %d records\n",
            packedtraces, (long long int)packedsamples, packedrecords);
 
-  /* Make sure everything is cleaned up */
-  if (ofp)
-    fclose (ofp);
+  if (printstats)
+    stats_print (stderr);
 
-  return 0;
+  if (statsjson && stats_writejson (statsjson))
+    return -1;
+
+  freeinput (&inputs[0]);
+  freeinput (&inputs[1]);
+  freeblock (&serialblock);
+  resetgroup (mstg);
+  free (mstg);
+  msr_free (&indexmsr);
+  asyncio_free (&inaio);
+  asyncio_free (&outaio);
+  tpool_free (&pool);
+
+  /* Output files of single input files not written completely */
+  return (failedoutputs) ? -1 : 0;
 } /* End of main() */
 
 /***************************************************************************
- * parseSDR:
- *
- * Read an SDR file and add data samples to a MSTraceGroup.  When
- * finshed reading the file write output miniSEED.
+ * convertfiles:
  *
- * Returns 0 on success, and -1 on failure
+ * Convert the input files of the file list into the MSTraceGroup, in
+ * stage threads if possible.
  ***************************************************************************/
-static int
-parseSDR (char *sdrfile, MSTraceGroup *mstg)
+static void
+convertfiles (MSTraceGroup *mstg)
 {
-  FILE *ifp = 0;
-  int datacnt;
-  int idx;
+  struct listnode *flp;
 
-  /* Open input file */
-  if ((ifp = fopen (sdrfile, "rb")) == NULL)
+  if (!pipelined || runpipeline (mstg))
   {
-    fprintf (stderr, "Cannot open input file: %s (%s)\n",
-             sdrfile, strerror (errno));
-    return -1;
+    flp = filelist;
+    while (flp != 0)
+    {
+      parseSDR (flp->data, (flp->next) ? flp->next->data : NULL, mstg);
+
+      flp = flp->next;
+    }
   }
+} /* End of convertfiles() */
 
-  /* Parse input SDR file and add data to MSTraceGroup */
-  if ((datacnt = sdr2group (ifp, mstg, sdrformat, sdrfile, verbose)) < 0)
+/***************************************************************************
+ * watchdaemon:
+ *
+ * Watch the directories of the watch list and convert each file when
+ * it is complete, until interrupted by SIGINT or SIGTERM.  Files are
+ * converted one at a time with the thread pool, I/O contexts, block
+ * buffers and decimators of the process, which are reused for all
+ * files.
+ *
+ * Converted and failed files are recorded in the journal, a file in
+ * the journal is converted again only if it changed, also after a
+ * restart.
+ *
+ * Returns 0 when stopped, and -1 on failure.
+ ***************************************************************************/
+static int
+watchdaemon (MSTraceGroup *mstg)
+{
+  struct listnode node;
+  struct listnode *flp;
+  Watcher *watcher = NULL;
+  char defjournal[1024];
+  char path[1024];
+  int64_t size;
+  int64_t mtime;
+  int status;
+  int converted;
+  int rv = 0;
+
+  /* Keep the journal in the first watched directory by default */
+  if (!journalfile)
   {
-    fprintf (stderr, "Error parsing %s\n", sdrfile);
+    snprintf (defjournal, sizeof (defjournal), "%s/.%s.journal", watchlist->data, PACKAGE);
+    journalfile = defjournal;
+  }
 
+  if (!(journal = journal_open (journalfile)) ||
+      !(watcher = watcher_init (settle, watchfilter)))
     return -1;
-  }
 
-  /* Perform decimation steps requested */
-  for (idx = 0; idx < MAX_DECIMATION && decilist[idx]; idx++)
+  for (flp = watchlist; flp; flp = flp->next)
   {
-    MSTrace *mst;
+    if (watcher_add (watcher, flp->data))
+    {
+      watcher_free (&watcher);
+      return -1;
+    }
+  }
 
-    if (!mstg)
-      continue;
+  signal (SIGINT, stopdaemon);
+  signal (SIGTERM, stopdaemon);
+
+  if (verbose)
+    fprintf (stderr, "Watching directories with %s, journal %s\n",
+             watcher_method (watcher), journalfile);
 
-    mst = mstg->traces;
-    while (mst)
+  while (!stopping)
+  {
+    /* Returns after changes or a signal without a complete file */
+    if ((rv = watcher_next (watcher, path, sizeof (path), &size, &mtime)) <= 0)
     {
-      if (decimate (mst, decilist[idx]))
+      if (rv < 0)
         break;
+      continue;
+    }
 
-      mst = mst->next;
+    /* Skip files processed before and not changed since */
+    if (unchanged (path, size, mtime, &status))
+    {
+      if (verbose)
+        fprintf (stderr, "%s: Not changed since %s\n", path,
+                 (status == JOURNAL_CONVERTED) ? "converted" : "failed");
+      continue;
     }
-  }
 
-  /* Open output file if needed */
-  if (!ofp)
-  {
-    char mseedoutputfile[1024];
+    node.key  = NULL;
+    node.data = path;
+    node.next = NULL;
+    filelist  = &node;
+    converted = convertedfiles;
 
-    strncpy (mseedoutputfile, sdrfile, sizeof (mseedoutputfile) - 6);
+    convertfiles (mstg);
 
-    /* Add .mseed to the file name */
-    strcat (mseedoutputfile, ".mseed");
+    filelist = NULL;
 
-    if ((ofp = fopen (mseedoutputfile, "wb")) == NULL)
-    {
-      fprintf (stderr, "Cannot open output file: %s (%s)\n",
-               mseedoutputfile, strerror (errno));
-      return -1;
-    }
-  }
+    /* Drop the traces of this file, nothing is carried to the next */
+    resetgroup (mstg);
 
-  packtraces (mstg, 1);
-  packedtraces += mstg->numtraces;
+    status = (convertedfiles > converted) ? JOURNAL_CONVERTED : JOURNAL_FAILED;
 
-  /* Cleanup */
-  fclose (ifp);
+    fprintf (stderr, "%s: %s\n", path,
+             (status == JOURNAL_CONVERTED) ? "Converted" : "Conversion failed");
 
-  if (ofp && !outputfile)
-  {
-    fclose (ofp);
-    ofp = 0;
+    /* Converted files are recorded with their output when finished */
+    if (status == JOURNAL_FAILED)
+      recordfile (path, size, mtime, status, NULL);
   }
 
-  return 0;
-} /* End of parseSDR() */
+  signal (SIGINT, SIG_DFL);
+  signal (SIGTERM, SIG_DFL);
+
+  watcher_free (&watcher);
+
+  return (rv < 0) ? -1 : 0;
+} /* End of watchdaemon() */
 
 /***************************************************************************
- * sdr2group:
+ * watchfilter:
  *
- * Parse a SDR "seisdata" file, populate an MSRecord structure as a
- * temporary holder and add each channel block to a MSTraceGroup.
+ * Select the files to convert in watched directories, skipping the
+ * output, index, checkpoint and temporary files written there.
  *
- * The format argument is interpreted as:
- * 0 : SDR format
- *   ( this functionality is unused at the momemnt, perhaps forever )
- *
- * Returns number of data samples in file or -1 on failure.
+ * Returns 1 for files to convert, and 0 otherwise.
  ***************************************************************************/
 static int
-sdr2group (FILE *ifp, MSTraceGroup *mstg, int format, char *sdrfile, int verbose)
+watchfilter (const char *name)
 {
-  MSRecord *msr = 0;
-  MSTrace *mst;
-  struct blkt_1000_s Blkt1000;
-  struct blkt_1001_s Blkt1001;
-  struct blkt_100_s Blkt100;
-
-  hptime_t daytime;
-  BTime btime;
+  static const char *suffixes[] = {".mseed", SDRINDEX_SUFFIX, CHECKPOINT_SUFFIX, ".tmp", NULL};
+  size_t length = strlen (name);
+  size_t slength;
+  int idx;
 
-  HeaderBlock hblock;
-  FileInfo *finfo;
-  InfoBlock *iblock;
-  char stime[50];
-  char ltime[50];
+  for (idx = 0; suffixes[idx]; idx++)
+  {
+    slength = strlen (suffixes[idx]);
 
-  char *datablock     = NULL;
-  int datablocklength = 0;
+    if (length >= slength && !strcmp (name + length - slength, suffixes[idx]))
+      return 0;
+  }
 
-  int16_t *i16muxed = NULL;
-  int32_t *i32muxed = NULL;
-  int32_t *cdata    = NULL;
-  int mssamples;
-  int headerversion;
+  return 1;
+} /* End of watchfilter() */
 
-  char chanstr[4];
-  int totalsamples = 0;
-  int idx;
-  int cidx;
-  int sidx;
-  int midx;
+/***************************************************************************
+ * stopdaemon:
+ * Signal handler stopping the watch daemon after the current file.
+ ***************************************************************************/
+static void
+stopdaemon (int sig)
+{
+  stopping = 1;
+} /* End of stopdaemon() */
 
-  /* Argument sanity */
-  if (!ifp || !mstg)
-    return -1;
+/***************************************************************************
+ * resetgroup:
+ *
+ * Remove all traces from a MSTraceGroup, freeing the record templates
+ * with their blockettes.
+ ***************************************************************************/
+static void
+resetgroup (MSTraceGroup *mstg)
+{
+  MSTrace *mst;
+  MSRecord *msr;
 
-  if (!(msr = msr_init (msr)))
+  for (mst = mstg->traces; mst; mst = mst->next)
   {
-    fprintf (stderr, "Cannot initialize MSRecord strcture\n");
-    return -1;
+    msr          = (MSRecord *)mst->prvtptr;
+    mst->prvtptr = NULL;
+    msr_free (&msr);
   }
 
-  /* Read the header block */
-  if (fread (&hblock, sizeof (HeaderBlock), 1, ifp) < 1)
-    return -1;
+  mst_initgroup (mstg);
+} /* End of resetgroup() */
+
+/***************************************************************************
+ * parseSDR:
+ *
+ * Read an SDR file and add data samples to a MSTraceGroup.  When
+ * finshed reading the file write output miniSEED.
+ *
+ * If a next file is given it is opened and its header block read
+ * while this file is converted.
+ *
+ * Returns 0 on success, and -1 on failure
+ ***************************************************************************/
+static int
+parseSDR (char *sdrfile, char *nextfile, MSTraceGroup *mstg)
+{
+  struct sdrinput *input;
+  struct sdrfile *file;
+  int idx = 0;
 
-  headerversion = hblock.fileVersionFlags & 0xFF;
+  if (verbose)
+    fprintf (stderr, "Reading %s\n", sdrfile);
 
-  /* Sanity check header version and sample count */
-  if (headerversion != HDR_VERSION1 && headerversion != HDR_VERSION2)
+  if (!(input = selectinput (sdrfile, nextfile)))
+    return -1;
+
+  if (!(file = startfile (input, sdrfile, 0)))
   {
-    fprintf (stderr, "%s: Unrecognized file type (invalid header version %d), skipping\n",
-             sdrfile, headerversion);
+    fprintf (stderr, "Error parsing %s\n", sdrfile);
+    closeinput (input);
+
     return -1;
   }
-  if ((hblock.numSamples != (hblock.sampleRate * hblock.numChannels)))
+
+  if (beginfile (file, mstg))
   {
-    fprintf (stderr, "%s: Unrecognized file type (sample count inconsistent), skipping\n",
-             sdrfile);
-    return -1;
+    fprintf (stderr, "Error parsing %s\n", sdrfile);
+    file->failed = 1;
   }
 
-  /* Report header details */
-  if (verbose)
+  /* Read, decode and convert each data block */
+  while (!file->failed && readnext (input, file, &idx, &serialblock, 0))
   {
-    ms_hptime2mdtimestr (MS_EPOCH2HPTIME (hblock.startTime), stime, 0);
-    ms_hptime2mdtimestr (MS_EPOCH2HPTIME (hblock.lastTime), ltime, 0);
+    if (decodeblock (&serialblock, 0))
+      continue;
 
-    if (verbose < 2)
-    {
-      fprintf (stderr, "%s: version %d, samps/sec: %d, %s - %s\n",
-               sdrfile, headerversion, hblock.sampleRate,
-               stime, ltime);
-    }
-    else
+    if (convertblock (&serialblock, mstg))
     {
-      fprintf (stderr, "  fileVersionFlags: %d\n", hblock.fileVersionFlags);
-      fprintf (stderr, "  sampleRate:      %d (samples/second)\n", hblock.sampleRate);
-      fprintf (stderr, "  numSamples:      %d\n", hblock.numSamples);
-      fprintf (stderr, "  numChannels:     %d\n", hblock.numChannels);
-      fprintf (stderr, "  numBlocks:       %d\n", hblock.numBlocks);
-      fprintf (stderr, "  lastBlockSize:   %d\n", hblock.lastBlockSize);
-      fprintf (stderr, "  startTime:       %d (%s)\n", hblock.startTime, stime);
-      fprintf (stderr, "  lastTime:        %d (%s)\n", hblock.lastTime, ltime);
-      fprintf (stderr, "  lastBlockOffset: %d\n", hblock.lastBlockOffset);
+      fprintf (stderr, "Error parsing %s\n", sdrfile);
+      file->failed = 1;
     }
   }
 
-  /* Allocate 1-minute multiplexed "blocked" data buffer depending on data encoding */
-  if (headerversion == HDR_VERSION1)
+  /* Cleanup */
+  closeinput (input);
+
+  return endfile (file, mstg);
+} /* End of parseSDR() */
+
+/***************************************************************************
+ * runpipeline:
+ *
+ * Convert all input files with the read, decode and convert stages
+ * running concurrently: a reader thread reads data blocks, a decoder
+ * thread decodes and demultiplexes them and the calling thread adds
+ * them to the MSTraceGroup, decimates, packs and writes output.
+ *
+ * Blocks are passed between the stages through bounded queues and
+ * returned to the reader for reuse, their buffers are only allocated
+ * until they are large enough for the input.  Blocks are converted in
+ * file order, the output is identical to converting serially.
+ *
+ * Returns 0 on success, and -1 if the pipeline could not be started
+ * and no files were converted.
+ ***************************************************************************/
+static int
+runpipeline (MSTraceGroup *mstg)
+{
+  struct pipeline pipe;
+  PipeThread *reader  = NULL;
+  PipeThread *decoder = NULL;
+  struct sdrblock *block;
+  struct sdrfile *file;
+  int started = 0;
+  int stop    = 0;
+  int idx;
+
+  memset (&pipe, 0, sizeof (pipe));
+  pipe.nblocks = 2 * PIPEDEPTH + 3;
+
+  if (!(pipe.readq = pipequeue_init ("read", PIPEDEPTH)) ||
+      !(pipe.decodeq = pipequeue_init ("decode", PIPEDEPTH)) ||
+      !(pipe.freeq = pipequeue_init ("readfree", pipe.nblocks)) ||
+      !(pipe.blocks = (struct sdrblock *)calloc (pipe.nblocks, sizeof (struct sdrblock))))
   {
-    if (!(i16muxed = (int16_t *)malloc (60 * hblock.numSamples * sizeof (int16_t))))
-    {
-      fprintf (stderr, "%s: Error allocating muxed data buffer of %d bytes\n",
-               sdrfile, (int)(60 * hblock.numSamples * sizeof (int16_t)));
-      return -1;
-    }
+    stop = 1;
   }
   else
   {
-    if (!(i32muxed = (int32_t *)malloc (60 * hblock.numSamples * sizeof (int32_t))))
-    {
-      fprintf (stderr, "%s: Error allocating muxed data buffer of %d bytes\n",
-               sdrfile, (int)(60 * hblock.numSamples * sizeof (int32_t)));
-      return -1;
-    }
+    for (idx = 0; idx < pipe.nblocks; idx++)
+      pipequeue_push (pipe.freeq, &pipe.blocks[idx]);
+
+    if (!(decoder = pipethread_start (decodestage, &pipe)))
+      stop = 1;
   }
 
-  /* Allocate 1-minute demultiplexed "unblocked" channel buffer */
-  if (!(cdata = (int32_t *)malloc (60 * hblock.sampleRate * sizeof (int32_t))))
+  if (stop)
   {
-    fprintf (stderr, "%s: Error allocating channel data buffer of %d bytes\n",
-             sdrfile, (int)(60 * hblock.numSamples * sizeof (int32_t)));
+    pipequeue_free (&pipe.readq);
+    pipequeue_free (&pipe.decodeq);
+    pipequeue_free (&pipe.freeq);
+    free (pipe.blocks);
+
     return -1;
   }
 
-  /* Populate MSRecord structure with header details */
-  ms_strncpclean (msr->network, network, 2);
-  ms_strncpclean (msr->station, station, 5);
-  ms_strncpclean (msr->location, location, 2);
-
-  msr->samprate   = hblock.sampleRate;
-  msr->sampletype = 'i';
-
-  /* Loop through file info blocks */
-  for (idx = 0; idx < hblock.numBlocks; idx++)
+  /* Without a reader no file is read, stop the decoder */
+  if ((reader = pipethread_start (readstage, &pipe)))
+  {
+    started = 1;
+  }
+  else
   {
-    finfo = &(hblock.fileInfo[idx]);
+    block       = (struct sdrblock *)pipequeue_pop (pipe.freeq);
+    block->type = BLOCK_STOP;
+    pipequeue_push (pipe.readq, block);
+  }
 
-    if (!finfo->startTime && !finfo->filePosition && !finfo->blockSize && !finfo->julian)
-      continue;
+  /* Convert the decoded blocks in order */
+  while (!stop)
+  {
+    block = (struct sdrblock *)pipequeue_pop (pipe.decodeq);
+    file  = block->file;
 
-    /* Report details */
-    if (verbose > 1)
+    switch (block->type)
     {
-      ms_hptime2mdtimestr (MS_EPOCH2HPTIME (finfo->startTime), stime, 0);
-
-      if (verbose == 2)
+    case BLOCK_START:
+      if (beginfile (file, mstg))
       {
-        fprintf (stderr, "  Data block (%d): %s, offset: %d, size: %d, julian: %d\n",
-                 idx + 1, stime, finfo->filePosition, finfo->blockSize, finfo->julian);
+        fprintf (stderr, "Error parsing %s\n", file->path);
+        file->failed = 1;
       }
-      else
+      break;
+    case BLOCK_DATA:
+      if (!file->failed && block->valid && convertblock (block, mstg))
       {
-        fprintf (stderr, "  Data block (%d):\n", idx + 1);
-        fprintf (stderr, "    startTime:     %d (%s)\n", finfo->startTime, stime);
-        fprintf (stderr, "    filePosition:  %d\n", finfo->filePosition);
-        fprintf (stderr, "    blockSize:     %d\n", finfo->blockSize);
-        fprintf (stderr, "    julian:        %d\n", finfo->julian);
+        fprintf (stderr, "Error parsing %s\n", file->path);
+        file->failed = 1;
       }
-    }
-
-    /* Seek to data block position in file */
-    if (fseek (ifp, finfo->filePosition, SEEK_SET))
-    {
-      fprintf (stderr, "%s: Error seeking to offset %d\n",
-               sdrfile, finfo->filePosition);
+      break;
+    case BLOCK_END:
+      endfile (file, mstg);
+      break;
+    case BLOCK_STOP:
+      stop = 1;
       break;
     }
 
-    /* (Re)allocate data buffer if needed */
-    if (!datablock || datablocklength < finfo->blockSize)
-    {
-      if (!(datablock = (char *)realloc (datablock, finfo->blockSize)))
-      {
-        fprintf (stderr, "%s: Error (re)allocating data buffer of %d bytes\n",
-                 sdrfile, finfo->blockSize);
-        break;
-      }
+    block->file = NULL;
+    pipequeue_push (pipe.freeq, block);
+  }
 
-      datablocklength = finfo->blockSize;
+  pipethread_join (&reader);
+  pipethread_join (&decoder);
+
+  pipequeue_free (&pipe.readq);
+  pipequeue_free (&pipe.decodeq);
+  pipequeue_free (&pipe.freeq);
+
+  for (idx = 0; idx < pipe.nblocks; idx++)
+    freeblock (&pipe.blocks[idx]);
+
+  free (pipe.blocks);
+
+  return (started) ? 0 : -1;
+} /* End of runpipeline() */
+
+/***************************************************************************
+ * readstage:
+ *
+ * Pipeline reader thread, read the data blocks of all input files
+ * into blocks taken from the free queue, each file between start and
+ * end blocks, followed by a stop block.
+ ***************************************************************************/
+static void
+readstage (void *arg)
+{
+  struct pipeline *pipe = (struct pipeline *)arg;
+  struct listnode *flp;
+  struct sdrinput *input;
+  struct sdrfile *file;
+  struct sdrblock *block;
+  int idx;
+
+  for (flp = filelist; flp; flp = flp->next)
+  {
+    if (verbose)
+      fprintf (stderr, "Reading %s\n", flp->data);
+
+    if (!(input = selectinput (flp->data, (flp->next) ? flp->next->data : NULL)))
+      continue;
+
+    if (!(file = startfile (input, flp->data, READTHREAD)))
+    {
+      fprintf (stderr, "Error parsing %s\n", flp->data);
+      closeinput (input);
+      continue;
+    }
+
+    block       = (struct sdrblock *)pipequeue_pop (pipe->freeq);
+    block->type = BLOCK_START;
+    block->file = file;
+    pipequeue_push (pipe->readq, block);
+
+    /* The block left after the last data block ends the file */
+    idx   = 0;
+    block = (struct sdrblock *)pipequeue_pop (pipe->freeq);
+
+    while (readnext (input, file, &idx, block, READTHREAD))
+    {
+      pipequeue_push (pipe->readq, block);
+      block = (struct sdrblock *)pipequeue_pop (pipe->freeq);
+    }
+
+    closeinput (input);
+
+    block->type = BLOCK_END;
+    block->file = file;
+    pipequeue_push (pipe->readq, block);
+  }
+
+  block       = (struct sdrblock *)pipequeue_pop (pipe->freeq);
+  block->type = BLOCK_STOP;
+  block->file = NULL;
+  pipequeue_push (pipe->readq, block);
+} /* End of readstage() */
+
+/***************************************************************************
+ * decodestage:
+ *
+ * Pipeline decoder thread, decode the data blocks from the reader
+ * and pass all blocks on to the converter until a stop block.
+ ***************************************************************************/
+static void
+decodestage (void *arg)
+{
+  struct pipeline *pipe = (struct pipeline *)arg;
+  struct sdrblock *block;
+  int type;
+
+  do
+  {
+    block = (struct sdrblock *)pipequeue_pop (pipe->readq);
+    type  = block->type;
+
+    if (type == BLOCK_DATA)
+      block->valid = (decodeblock (block, DECODETHREAD) == 0);
+
+    pipequeue_push (pipe->decodeq, block);
+  } while (type != BLOCK_STOP);
+} /* End of decodestage() */
+
+/***************************************************************************
+ * selectinput:
+ *
+ * Get the input of a file, opened while reading the previous file or
+ * opened now, and open the next file so its header block is read
+ * while this file is.
+ *
+ * Returns the input on success, and NULL on failure.
+ ***************************************************************************/
+static struct sdrinput *
+selectinput (char *sdrfile, char *nextfile)
+{
+  struct sdrinput *input;
+  struct sdrinput *next;
+
+  /* Use the input opened while reading the previous file */
+  if (inputs[0].path == sdrfile)
+  {
+    input = &inputs[0];
+  }
+  else if (inputs[1].path == sdrfile)
+  {
+    input = &inputs[1];
+  }
+  else
+  {
+    input = &inputs[0];
+    closeinput (input);
+
+    /* Open input file */
+    if (openinput (input, sdrfile))
+    {
+      fprintf (stderr, "Cannot open input file: %s (%s)\n",
+               sdrfile, strerror (errno));
+      return NULL;
+    }
+  }
+
+  /* Queue the header read of the next file, errors are reported when
+   * the next file is converted */
+  next = (input == &inputs[0]) ? &inputs[1] : &inputs[0];
+  closeinput (next);
+
+  if (nextfile)
+    openinput (next, nextfile);
+
+  input->following = (next->path) ? next : NULL;
+
+  return input;
+} /* End of selectinput() */
+
+/***************************************************************************
+ * startfile:
+ *
+ * Wait for the header block of an input file, check it and report
+ * its details.
+ *
+ * Returns a new sdrfile on success, and NULL on failure.
+ ***************************************************************************/
+static struct sdrfile *
+startfile (struct sdrinput *input, char *sdrfile, int thread)
+{
+  struct sdrfile *file;
+  HeaderBlock *hblock = &input->hblock;
+  char stime[50];
+  char ltime[50];
+  StatsTimer timer;
+  int headerversion;
+
+  /* Wait for the header block read */
+  STATS_START (&timer, thread);
+
+  if (waitheader (input))
+    return NULL;
+
+  STATS_STOP (&timer, thread, STAT_READ, sizeof (HeaderBlock), 0, 0);
+
+  headerversion = hblock->fileVersionFlags & 0xFF;
+
+  /* Sanity check header version and sample count */
+  if (headerversion != HDR_VERSION1 && headerversion != HDR_VERSION2)
+  {
+    fprintf (stderr, "%s: Unrecognized file type (invalid header version %d), skipping\n",
+             sdrfile, headerversion);
+    return NULL;
+  }
+  if ((hblock->numSamples != (hblock->sampleRate * hblock->numChannels)))
+  {
+    fprintf (stderr, "%s: Unrecognized file type (sample count inconsistent), skipping\n",
+             sdrfile);
+    return NULL;
+  }
+
+  /* Report header details */
+  if (verbose)
+  {
+    ms_hptime2mdtimestr (MS_EPOCH2HPTIME (hblock->startTime), stime, 0);
+    ms_hptime2mdtimestr (MS_EPOCH2HPTIME (hblock->lastTime), ltime, 0);
+
+    if (verbose < 2)
+    {
+      fprintf (stderr, "%s: version %d, samps/sec: %d, %s - %s\n",
+               sdrfile, headerversion, hblock->sampleRate,
+               stime, ltime);
+    }
+    else
+    {
+      fprintf (stderr, "  fileVersionFlags: %d\n", hblock->fileVersionFlags);
+      fprintf (stderr, "  sampleRate:      %d (samples/second)\n", hblock->sampleRate);
+      fprintf (stderr, "  numSamples:      %d\n", hblock->numSamples);
+      fprintf (stderr, "  numChannels:     %d\n", hblock->numChannels);
+      fprintf (stderr, "  numBlocks:       %d\n", hblock->numBlocks);
+      fprintf (stderr, "  lastBlockSize:   %d\n", hblock->lastBlockSize);
+      fprintf (stderr, "  startTime:       %d (%s)\n", hblock->startTime, stime);
+      fprintf (stderr, "  lastTime:        %d (%s)\n", hblock->lastTime, ltime);
+      fprintf (stderr, "  lastBlockOffset: %d\n", hblock->lastBlockOffset);
+    }
+  }
+
+  if (!(file = (struct sdrfile *)calloc (1, sizeof (struct sdrfile))))
+  {
+    fprintf (stderr, "%s: Cannot allocate memory\n", sdrfile);
+    return NULL;
+  }
+
+  file->path       = sdrfile;
+  file->version    = headerversion;
+  file->first      = input->first;
+  file->end        = input->end;
+  file->checkpoint = input->checkpoint;
+  file->lastblock  = (file->checkpoint) ? file->checkpoint->lastblock : -1;
+  file->size       = input->size;
+  file->mtime      = input->mtime;
+  memcpy (&file->hblock, hblock, sizeof (HeaderBlock));
+
+  input->checkpoint = NULL;
+
+  if (verbose && (winstart != HPTERROR || winend != HPTERROR))
+    fprintf (stderr, "%s: %d of %d data blocks in time window\n",
+             sdrfile, file->end - file->first, hblock->numBlocks);
+
+  if (verbose && file->checkpoint)
+    fprintf (stderr, "%s: Resuming after data block %d of %d from checkpoint\n",
+             sdrfile, file->checkpoint->lastblock + 1, hblock->numBlocks);
+
+  /* Build an index of the whole file unless a valid one exists */
+  if (indexing && winstart == HPTERROR && winend == HPTERROR && !file->checkpoint)
+    file->index = startindex (file);
+
+  return file;
+} /* End of startfile() */
+
+/***************************************************************************
+ * readnext:
+ *
+ * Read the next data block of an input file, starting at info block
+ * *idx, into a block and advance *idx past it.  The block takes the
+ * read buffer and gives its previous buffer for a later read.
+ *
+ * Returns 1 if a block was read, and 0 at the end of the file or on
+ * failure.
+ ***************************************************************************/
+static int
+readnext (struct sdrinput *input, struct sdrfile *file, int *idx,
+          struct sdrblock *block, int thread)
+{
+  HeaderBlock *hblock = &file->hblock;
+  struct blockread *br;
+  FileInfo *finfo;
+  StatsTimer timer;
+  char stime[50];
+  char *buf;
+  int size;
+
+  /* Start at the time window, skip unused file info blocks */
+  if (*idx < file->first)
+    *idx = file->first;
+
+  while (*idx < file->end && emptyinfo (&(hblock->fileInfo[*idx])))
+    (*idx)++;
+
+  if (*idx >= file->end)
+    return 0;
+
+  finfo = &(hblock->fileInfo[*idx]);
+
+  /* Report details */
+  if (verbose > 1)
+  {
+    ms_hptime2mdtimestr (MS_EPOCH2HPTIME (finfo->startTime), stime, 0);
+
+    if (verbose == 2)
+    {
+      fprintf (stderr, "  Data block (%d): %s, offset: %d, size: %d, julian: %d\n",
+               *idx + 1, stime, finfo->filePosition, finfo->blockSize, finfo->julian);
+    }
+    else
+    {
+      fprintf (stderr, "  Data block (%d):\n", *idx + 1);
+      fprintf (stderr, "    startTime:     %d (%s)\n", finfo->startTime, stime);
+      fprintf (stderr, "    filePosition:  %d\n", finfo->filePosition);
+      fprintf (stderr, "    blockSize:     %d\n", finfo->blockSize);
+      fprintf (stderr, "    julian:        %d\n", finfo->julian);
+    }
+  }
+
+  /* Wait for the data block read, following blocks are read meanwhile */
+  STATS_START (&timer, thread);
+
+  if (!(br = readblock (input, *idx, file->path)))
+    return 0;
+
+  STATS_STOP (&timer, thread, STAT_READ, finfo->blockSize, 0, 0);
+
+  /* Swap buffers with the read */
+  buf            = block->raw;
+  size           = block->rawsize;
+  block->raw     = br->buf;
+  block->rawsize = br->size;
+  br->buf        = buf;
+  br->size       = size;
+
+  block->type = BLOCK_DATA;
+  block->file = file;
+  block->idx  = (*idx)++;
+
+  return 1;
+} /* End of readnext() */
+
+/***************************************************************************
+ * decodeblock:
+ *
+ * Decompress or unpack a data block and demultiplex the samples of
+ * the requested channels.
+ *
+ * Returns 0 on success, and -1 if the block is invalid or has no
+ * samples in the time window.
+ ***************************************************************************/
+static int
+decodeblock (struct sdrblock *block, int thread)
+{
+  struct sdrfile *file = block->file;
+  HeaderBlock *hblock  = &file->hblock;
+  InfoBlock *iblock    = (InfoBlock *)block->raw;
+  StatsTimer timer;
+  char stime[50];
+  int16_t *i16muxed;
+  int32_t *i32muxed;
+  int32_t sample;
+  int mssamples;
+  int size;
+  int cidx;
+  int sidx;
+  int midx;
+
+  /* Sanity check ID */
+  if (iblock->goodID != GOOD_BLK_ID)
+  {
+    fprintf (stderr, "%s: Error reading data block, good ID not found at offset %d\n",
+             file->path, hblock->fileInfo[block->idx].filePosition);
+
+    if (file->index)
+      indexblock (block, -1);
+
+    return -1;
+  }
+
+  /* Report details */
+  if (verbose > 1)
+  {
+    ms_hptime2mdtimestr (MS_EPOCH2HPTIME (iblock->startTime), stime, 0);
+
+    fprintf (stderr, "    Info block: %s, mstick: %d, size: %d\n",
+             stime, iblock->startTimeTick, iblock->blockSize);
+  }
+
+  /* (Re)allocate 1-minute multiplexed "blocked" data buffer depending on data encoding */
+  size = 60 * hblock->numSamples *
+         ((file->version == HDR_VERSION1) ? sizeof (int16_t) : sizeof (int32_t));
+
+  if (block->muxedsize < size)
+  {
+    free (block->muxed);
+
+    if (!(block->muxed = malloc (size)))
+    {
+      fprintf (stderr, "%s: Error allocating muxed data buffer of %d bytes\n",
+               file->path, size);
+      block->muxedsize = 0;
+      return -1;
+    }
+
+    block->muxedsize = size;
+  }
+
+  /* (Re)allocate 1-minute demultiplexed "unblocked" channel buffers, also used for floats */
+  size = 60 * hblock->numSamples * sizeof (int32_t);
+
+  if (block->cdatasize < size)
+  {
+    free (block->cdata);
+
+    if (!(block->cdata = (int32_t *)malloc (size)))
+    {
+      fprintf (stderr, "%s: Error allocating channel data buffer of %d bytes\n",
+               file->path, size);
+      block->cdatasize = 0;
+      return -1;
+    }
+
+    block->cdatasize = size;
+  }
+
+  i16muxed = (int16_t *)block->muxed;
+  i32muxed = (int32_t *)block->muxed;
+
+  /* Decompress or unpack data block */
+  STATS_START (&timer, thread);
+
+  if (file->version == HDR_VERSION1)
+    mssamples = decompressSDR (hblock, iblock, block->idx + 1, i16muxed, verbose);
+  else
+    mssamples = normalizeSDR24 (hblock, iblock, block->idx + 1, i32muxed, verbose);
+
+  STATS_STOP (&timer, thread, STAT_DECODE, iblock->blockSize, mssamples, 0);
+
+  block->starttime = blocktime (iblock);
+
+  if (file->index)
+    indexblock (block, mssamples);
+
+  /* Demultiplex data samples into channels */
+  STATS_START (&timer, thread);
+
+  for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+  {
+    block->chandata[cidx]    = NULL;
+    block->chansamples[cidx] = 0;
+
+    /* Skip channel if not requested */
+    if (cidx >= hblock->numChannels || chanlist[cidx] == 0)
+      continue;
+
+    block->chandata[cidx] = block->cdata + (cidx * 60 * hblock->sampleRate);
+
+    /* Extract channel samples from multiplexed array */
+    for (sidx = 0, midx = cidx; midx < mssamples; sidx++, midx += hblock->numChannels)
+    {
+      if (file->version == HDR_VERSION1)
+        sample = i16muxed[midx];
+      else
+        sample = i32muxed[midx];
+
+      if (sampletype == 'f')
+        ((float *)block->chandata[cidx])[sidx] = (float)sample;
+      else
+        ((int32_t *)block->chandata[cidx])[sidx] = sample;
+    }
+
+    block->chansamples[cidx] = sidx;
+  }
+
+  STATS_STOP (&timer, thread, STAT_DEMUX, (int64_t)mssamples * sizeof (int32_t), mssamples, 0);
+
+  /* Trim the first and last blocks to the time window */
+  if ((winstart != HPTERROR || winend != HPTERROR) &&
+      trimblock (block, hblock->sampleRate))
+    return -1;
+
+  return 0;
+} /* End of decodeblock() */
+
+/***************************************************************************
+ * freeblock:
+ *
+ * Free the buffers of a block.
+ ***************************************************************************/
+static void
+freeblock (struct sdrblock *block)
+{
+  free (block->raw);
+  free (block->muxed);
+  free (block->cdata);
+
+  block->raw       = NULL;
+  block->muxed     = NULL;
+  block->cdata     = NULL;
+  block->rawsize   = 0;
+  block->muxedsize = 0;
+  block->cdatasize = 0;
+} /* End of freeblock() */
+
+/***************************************************************************
+ * beginfile:
+ *
+ * Plan decimation for an input file and populate an MSRecord
+ * structure as a temporary holder of the channel blocks.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+beginfile (struct sdrfile *file, MSTraceGroup *mstg)
+{
+  /* Plan decimation of the products for the input sample rate */
+  if (planproducts (mstg, file->hblock.sampleRate, file->path))
+    return -1;
+
+  if (!(file->msr = msr_init (NULL)))
+  {
+    fprintf (stderr, "Cannot initialize MSRecord strcture\n");
+    return -1;
+  }
+
+  /* Populate MSRecord structure with header details */
+  ms_strncpclean (file->msr->network, network, 2);
+  ms_strncpclean (file->msr->station, station, 5);
+  ms_strncpclean (file->msr->location, location, 2);
+
+  file->msr->samprate   = file->hblock.sampleRate;
+  file->msr->sampletype = sampletype;
+
+  /* Files with checkpoints are converted on their own, continuing the
+   * traces of the checkpoint */
+  if (checkpointing)
+  {
+    resetgroup (mstg);
+
+    if (file->checkpoint && restorecheckpoint (file, mstg))
+      return -1;
+  }
+
+  return 0;
+} /* End of beginfile() */
+
+/***************************************************************************
+ * convertblock:
+ *
+ * Add the channel blocks of a decoded data block to a MSTraceGroup
+ * for products at the input rate and decimate them for the others.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+convertblock (struct sdrblock *block, MSTraceGroup *mstg)
+{
+  struct sdrfile *file = block->file;
+  MSRecord *msr        = file->msr;
+  StatsTimer timer;
+  int pidx;
+  int cidx;
+
+  msr->starttime = block->starttime;
+
+  /* Add data to Group for products at the input rate */
+  STATS_START (&timer, 0);
+
+  for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+  {
+    if (!block->chandata[cidx])
+      continue;
+
+    /* Set data array and sample count */
+    msr->samprate    = file->hblock.sampleRate;
+    msr->datasamples = block->chandata[cidx];
+    msr->samplecnt = msr->numsamples = block->chansamples[cidx];
+
+    for (pidx = 0; pidx < numproducts; pidx++)
+    {
+      if (products[pidx].node != 0)
+        continue;
+
+      setchannel (msr, cidx, &products[pidx]);
+
+      if (addtogroup (mstg, msr, file->path))
+        return -1;
+    }
+  }
+
+  STATS_STOP (&timer, 0, STAT_DEMUX, 0, 0, 0);
+
+  /* Decimate the block of all channels, output is added to the group as available */
+  if (numnodes > 1 &&
+      decimateblock (mstg, msr, block->chandata, block->chansamples, file->path))
+    return -1;
+
+  file->converted++;
+  file->lastblock = block->idx;
+
+  /* Write the records of each block as it is converted */
+  if (latency >= 0.0)
+    packlatency (mstg, (hptime_t)((double)msr->numsamples / msr->samprate * HPTMODULUS));
+
+  return 0;
+} /* End of convertblock() */
+
+/***************************************************************************
+ * endfile:
+ *
+ * Finish an input file: unless converting it failed flush decimation
+ * streams for per-file output, pack the traces and write the output
+ * file.  The sdrfile is freed.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+endfile (struct sdrfile *file, MSTraceGroup *mstg)
+{
+  char mseedoutputfile[1024];
+  int rv = -1;
+
+  /* No per-file output for files without data in the time window */
+  if (!file->failed && !file->converted && !sharedoutput &&
+      (winstart != HPTERROR || winend != HPTERROR))
+  {
+    if (verbose)
+      fprintf (stderr, "%s: No data in time window\n", file->path);
+
+    rv = 0;
+  }
+  else if (!file->failed)
+  {
+    /* Flush decimation streams at the end of each file for per-file output */
+    if (!sharedoutput && numnodes > 1)
+      flushstreams (mstg, file->path);
+
+    /* Open output file if needed, appending after a checkpoint */
+    if (!ofp && !archive && !datalink)
+    {
+      strncpy (mseedoutputfile, file->path, sizeof (mseedoutputfile) - 6);
+
+      /* Add .mseed to the file name */
+      strcat (mseedoutputfile, ".mseed");
+
+      openoutput (mseedoutputfile, (file->checkpoint) ? file->checkpoint->outsize : -1);
+    }
+
+    if (ofp || archive || datalink)
+    {
+      /* Decimation streams continuing into the next file are not
+       * flushed, samples not filling a record are kept in a checkpoint */
+      packtraces (mstg, ((sharedoutput && numnodes > 1) ||
+                         (checkpointing && !finalckp)) ? 0 : 1);
+
+      /* Traces continuing into the next file are counted when flushed */
+      if (!sharedoutput || numnodes <= 1)
+        packedtraces += mstg->numtraces;
+
+      rv = 0;
+
+      if (!sharedoutput && closeoutput ())
+      {
+        failedoutputs++;
+        rv = -1;
+      }
+
+      if (rv == 0 && checkpointing && savecheckpoint (file, mstg, mseedoutputfile))
+        rv = -1;
+    }
+  }
+
+  if (rv == 0)
+  {
+    convertedfiles++;
+
+    /* Record the file converted to its own output */
+    if (journal && !sharedoutput)
+      recordfile (file->path, file->size, file->mtime, JOURNAL_CONVERTED, mseedoutputfile);
+  }
+
+  if (file->index && !file->failed)
+    writeindex (file);
+
+  sdrindex_free (&file->index);
+  checkpoint_free (&file->checkpoint);
+
+  if (file->msr)
+  {
+    file->msr->datasamples = 0;
+    msr_free (&file->msr);
+  }
+
+  free (file);
+
+  return rv;
+} /* End of endfile() */
+
+/***************************************************************************
+ * openinput:
+ *
+ * Open an input file, queue the read of its header block and advise
+ * the kernel to read the file into the page cache.
+ *
+ * Returns 0 on success, and -1 on failure with errno set.
+ ***************************************************************************/
+static int
+openinput (struct sdrinput *input, char *sdrfile)
+{
+  struct stat st;
+
+  input->path      = NULL;
+  input->hvalid    = 0;
+  input->apending  = 0;
+  input->head      = 0;
+  input->nqueued   = 0;
+  input->first     = 0;
+  input->end       = 0;
+  input->next      = 0;
+  input->following = NULL;
+
+  if ((input->fd = asyncio_open (sdrfile, 0)) < 0)
+    return -1;
+
+  /* The file as converted, blocks added later are not */
+  if (fstat (input->fd, &st))
+  {
+    asyncio_close (input->fd);
+    return -1;
+  }
+
+  input->size  = st.st_size;
+  input->mtime = st.st_mtime;
+
+  if (asyncio_read (inaio, &input->hreq, input->fd, &input->hblock, sizeof (HeaderBlock), 0))
+  {
+    asyncio_close (input->fd);
+    errno = EIO;
+    return -1;
+  }
+
+  input->path     = sdrfile;
+  input->hpending = 1;
+
+  /* Read-ahead is only advice, failure is not an error.  With a time
+   * window only the blocks in it are read. */
+  if (winstart == HPTERROR && winend == HPTERROR &&
+      asyncio_willneed (inaio, &input->areq, input->fd, 0, 0) == 0)
+    input->apending = 1;
+
+  return 0;
+} /* End of openinput() */
+
+/***************************************************************************
+ * waitheader:
+ *
+ * Wait for the header block read of an input file and find the data
+ * blocks in the time window.
+ *
+ * Returns 0 if a complete header block was read, and -1 otherwise.
+ ***************************************************************************/
+static int
+waitheader (struct sdrinput *input)
+{
+  if (input->hpending)
+  {
+    input->hvalid   = (asyncio_wait (inaio, &input->hreq) == sizeof (HeaderBlock));
+    input->hpending = 0;
+
+    /* Find the blocks to read */
+    if (input->hvalid)
+    {
+      windowblocks (&input->hblock, &input->first, &input->end);
+
+      /* Continue after the blocks converted before */
+      if (checkpointing && (input->checkpoint = loadcheckpoint (input)))
+        input->first = input->checkpoint->lastblock + 1;
+
+      input->next = input->first;
+    }
+  }
+
+  return (input->hvalid) ? 0 : -1;
+} /* End of waitheader() */
+
+/***************************************************************************
+ * queueblocks:
+ *
+ * Queue reads of the following data blocks of an input file until
+ * depth reads are queued or all blocks in the time window are.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+queueblocks (struct sdrinput *input, int depth, char *sdrfile)
+{
+  HeaderBlock *hblock = &input->hblock;
+  struct blockread *br;
+  FileInfo *finfo;
+  int size;
+
+  while (input->nqueued < depth && input->next < input->end)
+  {
+    finfo = &(hblock->fileInfo[input->next++]);
+
+    if (emptyinfo (finfo))
+      continue;
+
+    br = &input->reads[(input->head + input->nqueued) % READAHEAD];
+
+    /* Blocks without room for an info block read nothing and are
+     * rejected by readblock() */
+    size = (finfo->blockSize >= (int)sizeof (InfoBlock)) ? finfo->blockSize : 0;
+
+    /* (Re)allocate data buffer if needed */
+    if (!br->buf || br->size < size)
+    {
+      free (br->buf);
+
+      if (!(br->buf = (char *)malloc ((size > 0) ? size : sizeof (InfoBlock))))
+      {
+        fprintf (stderr, "%s: Error (re)allocating data buffer of %d bytes\n",
+                 sdrfile, finfo->blockSize);
+        br->size = 0;
+        return -1;
+      }
+
+      br->size = (size > 0) ? size : (int)sizeof (InfoBlock);
+    }
+
+    if (asyncio_read (inaio, &br->req, input->fd, br->buf, size, finfo->filePosition))
+      return -1;
+
+    input->nqueued++;
+  }
+
+  return 0;
+} /* End of queueblocks() */
+
+/***************************************************************************
+ * readblock:
+ *
+ * Wait for the read of a data block after queueing reads of the
+ * following blocks, up to READAHEAD blocks are read while a block is
+ * converted.  When all blocks of the file are queued the remaining
+ * depth is used for the first blocks of the following file, so
+ * reading continues across files.  Blocks must be requested in order.
+ *
+ * The returned read, with the data block in its buffer, is valid
+ * until the next call.
+ *
+ * Returns the read on success, and NULL on failure.
+ ***************************************************************************/
+static struct blockread *
+readblock (struct sdrinput *input, int idx, char *sdrfile)
+{
+  HeaderBlock *hblock        = &input->hblock;
+  struct sdrinput *following = input->following;
+  struct blockread *br;
+  FileInfo *finfo;
+  long nread;
+  int version;
+
+  /* Queue reads of the following blocks into the free buffers */
+  if (queueblocks (input, READAHEAD, sdrfile))
+    return NULL;
+
+  if (input->nqueued == 0)
+    return NULL;
+
+  /* Queue the first blocks of a valid following file, errors are
+   * reported when that file is converted */
+  if (following && following->path && input->nqueued < READAHEAD &&
+      input->next >= input->end &&
+      waitheader (following) == 0)
+  {
+    version = following->hblock.fileVersionFlags & 0xFF;
+
+    if (version == HDR_VERSION1 || version == HDR_VERSION2)
+      queueblocks (following, READAHEAD - input->nqueued, following->path);
+  }
+
+  /* The oldest queued read is the requested block */
+  br          = &input->reads[input->head];
+  input->head = (input->head + 1) % READAHEAD;
+  input->nqueued--;
+
+  finfo = &(hblock->fileInfo[idx]);
+  nread = asyncio_wait (inaio, &br->req);
+
+  if (finfo->blockSize < (int)sizeof (InfoBlock) || nread != finfo->blockSize)
+  {
+    fprintf (stderr, "%s: Error reading data block, %d bytes from offset %d\n",
+             sdrfile, finfo->blockSize, finfo->filePosition);
+    return NULL;
+  }
+
+  return br;
+} /* End of readblock() */
+
+/***************************************************************************
+ * emptyinfo:
+ *
+ * Returns 1 if a file info block is unused, otherwise 0.
+ ***************************************************************************/
+static int
+emptyinfo (FileInfo *finfo)
+{
+  return (!finfo->startTime && !finfo->filePosition && !finfo->blockSize && !finfo->julian);
+} /* End of emptyinfo() */
+
+/***************************************************************************
+ * blocktime:
+ *
+ * Returns the start time of a data block, the day boundary of the
+ * block start time plus the tick in milliseconds.
+ ***************************************************************************/
+static hptime_t
+blocktime (InfoBlock *iblock)
+{
+  hptime_t daytime;
+  BTime btime;
+
+  /* Determine time at day boundary */
+  ms_hptime2btime (MS_EPOCH2HPTIME (iblock->startTime), &btime);
+  btime.hour = btime.min = btime.sec = btime.fract = 0;
+  daytime                                          = ms_btime2hptime (&btime);
+
+  return daytime + ((hptime_t)iblock->startTimeTick * (HPTMODULUS / 1000));
+} /* End of blocktime() */
+
+/***************************************************************************
+ * inventory:
+ *
+ * Report the coverage of all input files from their header blocks
+ * without decoding any data.  Files are scanned in parallel on a
+ * thread pool, in batches, and reported in order: the version,
+ * channels, sample rate, blocks and time range of each file followed
+ * by a trace list with the gaps between blocks and files and a gap
+ * list.  Each data block is assumed to cover one minute.  With
+ * --inventory-blocks the start time of each block is read from its
+ * info block instead of the header.  With --index the block times and
+ * sample counts of files with a valid index are taken from the index,
+ * also with --inventory-blocks as the index holds the info block
+ * times.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+inventory (void)
+{
+  MSTraceGroup *mstg   = NULL;
+  MSRecord *msr        = NULL;
+  TPool *invpool       = NULL;
+  struct invfile *invs = NULL;
+  struct invfile *inv;
+  struct listnode *flp;
+  struct product numbered;
+  struct product *prod = &numbered;
+  void **args = NULL;
+  char stime[30];
+  char etime[30];
+  hptime_t tolerance;
+  hptime_t gap;
+  int64_t samplecnt;
+  int rv = -1;
+  int count;
+  int idx;
+  int bidx;
+  int next;
+  int cidx;
+
+  /* Channel codes of the first product at the input rate */
+  memset (&numbered, 0, sizeof (numbered));
+
+  for (idx = 0; idx < numproducts; idx++)
+  {
+    if (products[idx].ratio == 1 && products[idx].rate == 0.0)
+    {
+      prod = &products[idx];
+      break;
+    }
+  }
+
+  invs = (struct invfile *)calloc (INVENTORYBATCH, sizeof (struct invfile));
+  args = (void **)calloc (INVENTORYBATCH, sizeof (void *));
+
+  if (!invs || !args || !(mstg = mst_initgroup (NULL)) || !(msr = msr_init (NULL)))
+  {
+    fprintf (stderr, "Cannot allocate memory\n");
+    goto cleanup;
+  }
+
+  if (invthreads > 1 && !(invpool = tpool_init (invthreads)))
+    goto cleanup;
+
+  ms_strncpclean (msr->network, network, 2);
+  ms_strncpclean (msr->station, station, 5);
+  ms_strncpclean (msr->location, location, 2);
+
+  flp = filelist;
+  while (flp)
+  {
+    /* Scan a batch of files in parallel */
+    for (count = 0; flp && count < INVENTORYBATCH; flp = flp->next, count++)
+    {
+      memset (&invs[count], 0, sizeof (struct invfile));
+      invs[count].path = flp->data;
+      args[count]      = &invs[count];
+    }
+
+    if (tpool_run (invpool, inventoryjob, args, count))
+      goto cleanup;
+
+    /* Report the files and add their blocks to the coverage in order */
+    for (idx = 0; idx < count; idx++)
+    {
+      inv = &invs[idx];
+
+      if (!inv->version)
+      {
+        fprintf (stderr, "%s\n", inv->error);
+        continue;
+      }
+
+      if (inv->badblocks)
+        fprintf (stderr, "%s: %d data block(s) without a valid info block, skipped\n",
+                 inv->path, inv->badblocks);
+
+      if (inv->nstarts > 0)
+      {
+        ms_hptime2isotimestr (inv->starts[0], stime, 1);
+        ms_hptime2isotimestr (inv->starts[inv->nstarts - 1] + blockspan (inv, inv->nstarts - 1),
+                              etime, 1);
+      }
+      else
+      {
+        strcpy (stime, "-");
+        strcpy (etime, "-");
+      }
+
+      ms_log (0, "%s: version %d, %d channels, %d samps/sec, %d blocks, %s - %s\n",
+              inv->path, inv->version, inv->numchannels, inv->samprate,
+              inv->nstarts, stime, etime);
+
+      msr->samprate = inv->samprate;
+      tolerance     = (inv->samprate > 0) ? HPTMODULUS / (2 * inv->samprate) : 0;
+
+      /* Add the coverage of each run of contiguous blocks */
+      for (bidx = 0; bidx < inv->nstarts; bidx = next)
+      {
+        samplecnt = (inv->nsamples) ? inv->nsamples[bidx] : 60 * inv->samprate;
+
+        for (next = bidx + 1; next < inv->nstarts; next++)
+        {
+          gap = inv->starts[next] - inv->starts[next - 1] - blockspan (inv, next - 1);
+
+          if (gap > tolerance || gap < -tolerance)
+            break;
+
+          samplecnt += (inv->nsamples) ? inv->nsamples[next] : 60 * inv->samprate;
+        }
+
+        msr->starttime = inv->starts[bidx];
+        msr->samplecnt = samplecnt;
+
+        for (cidx = 0; cidx < inv->numchannels && cidx < MAX_CHANNELS; cidx++)
+        {
+          if (chanlist[cidx] == 0)
+            continue;
+
+          setchannel (msr, cidx, prod);
+
+          if (!mst_addmsrtogroup (mstg, msr, 0, -1.0, -1.0))
+          {
+            fprintf (stderr, "%s: Error adding coverage\n", inv->path);
+            goto cleanup;
+          }
+        }
+      }
+
+      free (inv->starts);
+      free (inv->nsamples);
+      inv->starts   = NULL;
+      inv->nsamples = NULL;
+    }
+  }
+
+  /* Join coverage of files given out of order */
+  mst_groupheal (mstg, -1.0, -1.0);
+  mst_groupsort (mstg, 0);
+
+  ms_log (0, "\n");
+  mst_printtracelist (mstg, 1, 1, 1);
+  ms_log (0, "\n");
+  mst_printgaplist (mstg, 1, NULL, NULL);
+
+  rv = 0;
+
+cleanup:
+  /* Block times of files not reported after a failure */
+  for (idx = 0; invs && idx < INVENTORYBATCH; idx++)
+  {
+    free (invs[idx].starts);
+    free (invs[idx].nsamples);
+  }
+
+  tpool_free (&invpool);
+  mst_freegroup (&mstg);
+  msr_free (&msr);
+  free (invs);
+  free (args);
+
+  return rv;
+} /* End of inventory() */
+
+/***************************************************************************
+ * blockspan:
+ *
+ * Returns the time covered by a data block of an inventory file, from
+ * the samples of the block when known and one minute otherwise.
+ ***************************************************************************/
+static hptime_t
+blockspan (struct invfile *inv, int idx)
+{
+  if (inv->nsamples && inv->samprate > 0)
+    return (hptime_t)inv->nsamples[idx] * HPTMODULUS / inv->samprate;
+
+  return (hptime_t)60 * HPTMODULUS;
+} /* End of blockspan() */
+
+/***************************************************************************
+ * inventoryjob:
+ *
+ * Read the header block of an input file and the start times of its
+ * data blocks, from the header or, with --inventory-blocks, from the
+ * info block of each data block.  With --index a valid index is read
+ * instead of the file, with the samples of each block.  Run on the
+ * thread pool.
+ ***************************************************************************/
+static void
+inventoryjob (void *arg, int thread)
+{
+  struct invfile *inv = (struct invfile *)arg;
+  HeaderBlock *hblock;
+  FileInfo *finfo;
+  InfoBlock iblock;
+  SDRIndex *index;
+  FILE *fp;
+  int numblocks;
+  int version;
+  int idx;
+
+  /* Use the block times of a valid index without opening the file */
+  if (indexing && (index = sdrindex_read (inv->path)))
+  {
+    if (index->nblocks > 0 &&
+        (!(inv->starts = (hptime_t *)malloc (index->nblocks * sizeof (hptime_t))) ||
+         !(inv->nsamples = (int *)malloc (index->nblocks * sizeof (int)))))
+    {
+      snprintf (inv->error, sizeof (inv->error), "%s: Cannot allocate memory", inv->path);
+      free (inv->starts);
+      inv->starts = NULL;
+      sdrindex_free (&index);
+      return;
+    }
+
+    for (idx = 0; idx < index->nblocks; idx++)
+    {
+      if (index->blocks[idx].flags & SDRINDEX_VALID)
+      {
+        inv->nsamples[inv->nstarts] = index->blocks[idx].nsamples;
+        inv->starts[inv->nstarts++] = index->blocks[idx].starttime;
+      }
+      else
+      {
+        inv->badblocks++;
+      }
+    }
+
+    inv->version     = index->version;
+    inv->samprate    = index->samprate;
+    inv->numchannels = index->numchannels;
+    inv->numblocks   = index->nblocks;
+
+    sdrindex_free (&index);
+    return;
+  }
+
+  if (!(hblock = (HeaderBlock *)malloc (sizeof (HeaderBlock))))
+  {
+    snprintf (inv->error, sizeof (inv->error), "%s: Cannot allocate memory", inv->path);
+    return;
+  }
+
+  if (!(fp = fopen (inv->path, "rb")))
+  {
+    snprintf (inv->error, sizeof (inv->error), "Cannot open input file: %s (%s)",
+              inv->path, strerror (errno));
+    free (hblock);
+    return;
+  }
+
+  if (fread (hblock, sizeof (HeaderBlock), 1, fp) != 1)
+  {
+    snprintf (inv->error, sizeof (inv->error), "%s: Error reading header block", inv->path);
+    fclose (fp);
+    free (hblock);
+    return;
+  }
+
+  version = hblock->fileVersionFlags & 0xFF;
+
+  /* Sanity check header version and sample count */
+  if (version != HDR_VERSION1 && version != HDR_VERSION2)
+  {
+    snprintf (inv->error, sizeof (inv->error),
+              "%s: Unrecognized file type (invalid header version %d), skipping",
+              inv->path, version);
+  }
+  else if ((hblock->numSamples != (hblock->sampleRate * hblock->numChannels)))
+  {
+    snprintf (inv->error, sizeof (inv->error),
+              "%s: Unrecognized file type (sample count inconsistent), skipping", inv->path);
+  }
+  else
+  {
+    numblocks = hblock->numBlocks;
+
+    if (numblocks < 0)
+      numblocks = 0;
+    if (numblocks > MAX_FILE_INFO)
+      numblocks = MAX_FILE_INFO;
+
+    if (numblocks > 0 && !(inv->starts = (hptime_t *)malloc (numblocks * sizeof (hptime_t))))
+    {
+      snprintf (inv->error, sizeof (inv->error), "%s: Cannot allocate memory", inv->path);
+      fclose (fp);
+      free (hblock);
+      return;
+    }
+
+    for (idx = 0; idx < numblocks; idx++)
+    {
+      finfo = &(hblock->fileInfo[idx]);
+
+      if (emptyinfo (finfo))
+        continue;
+
+      if (!inventoryblocks)
+      {
+        inv->starts[inv->nstarts++] = MS_EPOCH2HPTIME (finfo->startTime);
+      }
+      else if (fseek (fp, finfo->filePosition, SEEK_SET) == 0 &&
+               fread (&iblock, sizeof (InfoBlock), 1, fp) == 1 &&
+               iblock.goodID == GOOD_BLK_ID)
+      {
+        inv->starts[inv->nstarts++] = blocktime (&iblock);
+      }
+      else
+      {
+        inv->badblocks++;
+      }
+    }
+
+    inv->version     = version;
+    inv->samprate    = hblock->sampleRate;
+    inv->numchannels = hblock->numChannels;
+    inv->numblocks   = hblock->numBlocks;
+  }
+
+  fclose (fp);
+  free (hblock);
+} /* End of inventoryjob() */
+
+/***************************************************************************
+ * windowblocks:
+ *
+ * Find the data blocks of a file in the time window with binary
+ * searches over the block start times of the used file info blocks,
+ * unused blocks are skipped.  Without a time window, or if the used
+ * blocks are not in time order, all blocks are used and the samples
+ * outside the window are trimmed.
+ *
+ * The first block is set to the last block starting before the
+ * window start, which may contain it, and the end to the first block
+ * starting at or after the window end.
+ ***************************************************************************/
+static void
+windowblocks (HeaderBlock *hblock, int *first, int *end)
+{
+  int used[MAX_FILE_INFO];
+  int numblocks = hblock->numBlocks;
+  int numused   = 0;
+  int low;
+  int high;
+  int mid;
+  int idx;
+
+  if (numblocks < 0)
+    numblocks = 0;
+  if (numblocks > MAX_FILE_INFO)
+    numblocks = MAX_FILE_INFO;
+
+  *first = 0;
+  *end   = numblocks;
+
+  if (winstart == HPTERROR && winend == HPTERROR)
+    return;
+
+  /* Used blocks in time order */
+  for (idx = 0; idx < numblocks; idx++)
+  {
+    if (emptyinfo (&(hblock->fileInfo[idx])))
+      continue;
+
+    if (numused > 0 &&
+        hblock->fileInfo[idx].startTime < hblock->fileInfo[used[numused - 1]].startTime)
+      return;
+
+    used[numused++] = idx;
+  }
+
+  low = 0;
+
+  if (winstart != HPTERROR)
+  {
+    high = numused;
+
+    while (low < high)
+    {
+      mid = low + (high - low) / 2;
+
+      if (MS_EPOCH2HPTIME (hblock->fileInfo[used[mid]].startTime) < winstart)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+    if (low > 0)
+      low--;
+
+    *first = (low < numused) ? used[low] : numblocks;
+  }
+
+  if (winend != HPTERROR)
+  {
+    high = numused;
+
+    while (low < high)
+    {
+      mid = low + (high - low) / 2;
+
+      if (MS_EPOCH2HPTIME (hblock->fileInfo[used[mid]].startTime) < winend)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+    *end = (low < numused) ? used[low] : numblocks;
+  }
+} /* End of windowblocks() */
+
+/***************************************************************************
+ * trimblock:
+ *
+ * Trim the channel samples of a decoded block to the samples at or
+ * after the window start and before the window end.
+ *
+ * Returns 0 on success, and -1 if no samples are in the window.
+ ***************************************************************************/
+static int
+trimblock (struct sdrblock *block, int samprate)
+{
+  int64_t nsamples = 0;
+  int64_t first    = 0;
+  int64_t end;
+  int cidx;
+
+  if (samprate <= 0)
+    return 0;
+
+  /* All requested channels have the same number of samples */
+  for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+  {
+    if (block->chandata[cidx])
+    {
+      nsamples = block->chansamples[cidx];
+      break;
+    }
+  }
+
+  end = nsamples;
+
+  /* First samples at or after the window start and end */
+  if (winstart != HPTERROR && winstart > block->starttime)
+    first = ((winstart - block->starttime) * samprate + HPTMODULUS - 1) / HPTMODULUS;
+
+  if (winend != HPTERROR)
+    end = (winend > block->starttime) ?
+              ((winend - block->starttime) * samprate + HPTMODULUS - 1) / HPTMODULUS : 0;
+
+  if (end > nsamples)
+    end = nsamples;
+
+  if (first >= end)
+    return -1;
+
+  if (first == 0 && end == nsamples)
+    return 0;
+
+  /* Samples are 32-bit integers or floats */
+  for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+  {
+    if (!block->chandata[cidx])
+      continue;
+
+    block->chandata[cidx]    = (int32_t *)block->chandata[cidx] + first;
+    block->chansamples[cidx] = (int)(end - first);
+  }
+
+  block->starttime += (hptime_t) ((double)first / samprate * HPTMODULUS + 0.5);
+
+  return 0;
+} /* End of trimblock() */
+
+/***************************************************************************
+ * startindex:
+ *
+ * Start building the index of an input file, with the position, size
+ * and header time of each used info block, unless a valid index of
+ * the file exists.
+ *
+ * Returns a new SDRIndex, or NULL if the file is indexed or on error.
+ ***************************************************************************/
+static SDRIndex *
+startindex (struct sdrfile *file)
+{
+  HeaderBlock *hblock = &file->hblock;
+  SDRIndex *index;
+  FileInfo *finfo;
+  int numblocks;
+  int idx;
+
+  if ((index = sdrindex_read (file->path)))
+  {
+    if (verbose)
+      fprintf (stderr, "%s: Index is current\n", file->path);
+
+    sdrindex_free (&index);
+    return NULL;
+  }
+
+  if (hblock->numChannels > SDRINDEX_MAXCHANNELS)
+    return NULL;
+
+  numblocks = hblock->numBlocks;
+
+  if (numblocks < 0)
+    numblocks = 0;
+  if (numblocks > MAX_FILE_INFO)
+    numblocks = MAX_FILE_INFO;
+
+  if (!(index = sdrindex_init (file->path, file->version, hblock->sampleRate,
+                               hblock->numChannels, numblocks)))
+    return NULL;
+
+  for (idx = 0; idx < numblocks; idx++)
+  {
+    finfo = &(hblock->fileInfo[idx]);
+
+    if (emptyinfo (finfo))
+      continue;
+
+    index->blocks[idx].starttime = MS_EPOCH2HPTIME (finfo->startTime);
+    index->blocks[idx].offset    = finfo->filePosition;
+    index->blocks[idx].size      = finfo->blockSize;
+  }
+
+  return index;
+} /* End of startindex() */
+
+/***************************************************************************
+ * indexblock:
+ *
+ * Record a decoded data block in the index of its file: the start
+ * time, samples per channel and the range of each channel from the
+ * multiplexed samples.  A block that could not be decoded, with
+ * mssamples below 0, is only marked as decoded.
+ ***************************************************************************/
+static void
+indexblock (struct sdrblock *block, int mssamples)
+{
+  HeaderBlock *hblock = &block->file->hblock;
+  SDRIndexBlock *entry;
+  int16_t *i16muxed = (int16_t *)block->muxed;
+  int32_t *i32muxed = (int32_t *)block->muxed;
+  int32_t sample;
+  int32_t min;
+  int32_t max;
+  int cidx;
+  int midx;
+
+  if (block->idx >= block->file->index->nblocks)
+    return;
+
+  entry        = &(block->file->index->blocks[block->idx]);
+  entry->flags = SDRINDEX_DECODED;
+
+  if (mssamples < hblock->numChannels || hblock->numChannels <= 0)
+    return;
+
+  entry->starttime = block->starttime;
+  entry->nsamples  = mssamples / hblock->numChannels;
+  entry->flags |= SDRINDEX_VALID;
+
+  for (cidx = 0; cidx < hblock->numChannels; cidx++)
+  {
+    min = max = (block->file->version == HDR_VERSION1) ? i16muxed[cidx] : i32muxed[cidx];
+
+    for (midx = cidx; midx < mssamples; midx += hblock->numChannels)
+    {
+      sample = (block->file->version == HDR_VERSION1) ? i16muxed[midx] : i32muxed[midx];
+
+      if (sample < min)
+        min = sample;
+      if (sample > max)
+        max = sample;
+    }
+
+    entry->min[cidx] = min;
+    entry->max[cidx] = max;
+  }
+} /* End of indexblock() */
+
+/***************************************************************************
+ * writeindex:
+ *
+ * Write the index built while converting an input file, if every used
+ * info block of the header was decoded.  A failure is reported but
+ * does not fail the conversion.
+ ***************************************************************************/
+static void
+writeindex (struct sdrfile *file)
+{
+  SDRIndex *index = file->index;
+  int idx;
+  int rv;
+
+  for (idx = 0; idx < index->nblocks; idx++)
+  {
+    if (!emptyinfo (&(file->hblock.fileInfo[idx])) &&
+        !(index->blocks[idx].flags & SDRINDEX_DECODED))
+    {
+      if (verbose)
+        fprintf (stderr, "%s: Not all data blocks decoded, index not written\n", file->path);
+      return;
+    }
+  }
+
+  rv = sdrindex_write (file->path, index);
+
+  if (rv < 0)
+    fprintf (stderr, "%s: Cannot write index file (%s)\n", file->path, strerror (errno));
+  else if (rv > 0 && verbose)
+    fprintf (stderr, "%s: File changed while converting, index not written\n", file->path);
+  else if (rv == 0 && verbose)
+    fprintf (stderr, "%s: Wrote index of %d data blocks\n", file->path, index->nblocks);
+} /* End of writeindex() */
+
+/***************************************************************************
+ * skipindexed:
+ *
+ * Remove input files from the file list whose index shows no data in
+ * the time window, the files are not opened.  Files without a valid
+ * index are kept.
+ ***************************************************************************/
+static void
+skipindexed (void)
+{
+  struct listnode **pflp = &filelist;
+  struct listnode *flp;
+  SDRIndexBlock *entry;
+  SDRIndex *index;
+  int found;
+  int idx;
+
+  while ((flp = *pflp))
+  {
+    if (!(index = sdrindex_read (flp->data)))
+    {
+      pflp = &flp->next;
+      continue;
+    }
+
+    /* Blocks after the window start, until one starts at the window end */
+    found = 0;
+    idx   = (winstart != HPTERROR) ? sdrindex_find (index, winstart) : 0;
+
+    for (; idx < index->nblocks && !found; idx++)
+    {
+      entry = &(index->blocks[idx]);
+
+      if (winend != HPTERROR && entry->starttime >= winend)
+        break;
+
+      found = (entry->flags & SDRINDEX_VALID) && entry->nsamples > 0;
+    }
+
+    sdrindex_free (&index);
+
+    if (found)
+    {
+      pflp = &flp->next;
+      continue;
+    }
+
+    if (verbose)
+      fprintf (stderr, "%s: No data in time window per index, skipping\n", flp->data);
+
+    *pflp = flp->next;
+    free (flp->key);
+    free (flp->data);
+    free (flp);
+  }
+} /* End of skipindexed() */
+
+/***************************************************************************
+ * skipunchanged:
+ *
+ * Open the manifest and remove input files from the file list that
+ * were converted before and not changed since, when their output
+ * still exists.  Only the files are stat()ed, unless their size
+ * matches but not their modification time.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+skipunchanged (void)
+{
+  struct listnode **pflp = &filelist;
+  struct listnode *flp;
+  struct stat st;
+  const char *output;
+  int skipped = 0;
+  int status;
+
+  if (!(journal = journal_open (manifestfile)))
+    return -1;
+
+  while ((flp = *pflp))
+  {
+    if (stat (flp->data, &st) ||
+        !unchanged (flp->data, st.st_size, st.st_mtime, &status) ||
+        status != JOURNAL_CONVERTED ||
+        !journal_lookup (journal, flp->data, NULL, NULL, NULL, NULL, NULL, &output) ||
+        !output || stat (output, &st))
+    {
+      pflp = &flp->next;
+      continue;
+    }
+
+    if (verbose)
+      fprintf (stderr, "%s: Not changed since converted to %s, skipping\n", flp->data, output);
+
+    *pflp = flp->next;
+    free (flp->key);
+    free (flp->data);
+    free (flp);
+    skipped++;
+  }
+
+  if (verbose)
+    fprintf (stderr, "Skipped %d unchanged file(s) per manifest %s\n", skipped, manifestfile);
+
+  return 0;
+} /* End of skipunchanged() */
+
+/***************************************************************************
+ * unchanged:
+ *
+ * Check if a file in the journal did not change since it was
+ * recorded with the current conversion options: its size and
+ * modification time match, or its size and content hash match, e.g.
+ * after it was copied or touched.  In the latter case the record is
+ * updated with the new modification time.  Records without content
+ * hash are updated with the hash when the file did not change.
+ *
+ * Returns 1 and the recorded status if the file did not change, and
+ * 0 otherwise.
+ ***************************************************************************/
+static int
+unchanged (const char *path, int64_t size, int64_t mtime, int *status)
+{
+  const char *output;
+  uint64_t hash;
+  uint64_t jhash;
+  uint32_t joptions;
+  int64_t jsize;
+  int64_t jmtime;
+  char *jout = NULL;
+
+  if (!journal_lookup (journal, path, &jsize, &jmtime, &jhash, &joptions, status, &output) ||
+      jsize != size)
+    return 0;
+
+  if (joptions != optionhash ())
+  {
+    if (verbose)
+      fprintf (stderr, "%s: Conversion options changed since recorded\n", path);
+
+    return 0;
+  }
+
+  if (jmtime == mtime)
+  {
+    /* The content hash is taken the first time the file is found
+     * unchanged, not when converting, to read it only once then */
+    if (jhash || journal_hashfile (path, &hash))
+      return 1;
+  }
+  else if (!jhash || journal_hashfile (path, &hash) || hash != jhash)
+  {
+    return 0;
+  }
+  else if (verbose)
+  {
+    fprintf (stderr, "%s: Modification time changed, content did not\n", path);
+  }
+
+  /* The output path is replaced by the new record */
+  if (output && !(jout = strdup (output)))
+    return 1;
+
+  journal_record (journal, path, size, mtime, hash, joptions, *status, jout);
+  free (jout);
+
+  return 1;
+} /* End of unchanged() */
+
+/***************************************************************************
+ * recordfile:
+ *
+ * Record a file in the journal with the size and modification time it
+ * had before converting and the hash of the conversion options.  The
+ * content hash is left to unchanged(), a file is not read again here.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+recordfile (const char *path, int64_t size, int64_t mtime, int status,
+            const char *output)
+{
+  return journal_record (journal, path, size, mtime, 0, optionhash (), status, output);
+} /* End of recordfile() */
+
+/***************************************************************************
+ * loadcheckpoint:
+ *
+ * Read the checkpoint of an input file and check that it applies: the
+ * header and the converted info blocks are unchanged, it was written
+ * with the same options and the output file is at least as long as
+ * when it was written.
+ *
+ * Returns the checkpoint if it applies, and NULL otherwise.
+ ***************************************************************************/
+static Checkpoint *
+loadcheckpoint (struct sdrinput *input)
+{
+  HeaderBlock *hblock = &input->hblock;
+  Checkpoint *ckp;
+  struct stat st;
+  char mseedfile[1024];
+
+  if (!(ckp = checkpoint_read (input->path)))
+    return NULL;
+
+  snprintf (mseedfile, sizeof (mseedfile), "%s.mseed", input->path);
+
+  if (ckp->version != (hblock->fileVersionFlags & 0xFF) ||
+      ckp->samprate != hblock->sampleRate ||
+      ckp->numchannels != hblock->numChannels ||
+      ckp->lastblock < -1 || ckp->lastblock >= MAX_FILE_INFO ||
+      ckp->infohash != infohash (hblock, ckp->lastblock) ||
+      ckp->optionhash != optionhash () ||
+      stat (mseedfile, &st) || (int64_t)st.st_size < ckp->outsize)
+  {
+    if (verbose)
+      fprintf (stderr, "%s: Checkpoint does not apply, converting the whole file\n",
+               input->path);
+
+    checkpoint_free (&ckp);
+  }
+
+  return ckp;
+} /* End of loadcheckpoint() */
+
+/***************************************************************************
+ * restorecheckpoint:
+ *
+ * Move the traces of the checkpoint of a file into the empty
+ * MSTraceGroup, with record templates as made for the first block of
+ * each trace and the record sequence numbers of the checkpoint.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+restorecheckpoint (struct sdrfile *file, MSTraceGroup *mstg)
+{
+  Checkpoint *ckp = file->checkpoint;
+  MSRecord *msr   = file->msr;
+  MSTrace *mst;
+  int idx;
+
+  for (mst = ckp->mstg->traces, idx = 0; mst; mst = mst->next, idx++)
+  {
+    strcpy (msr->network, mst->network);
+    strcpy (msr->station, mst->station);
+    strcpy (msr->location, mst->location);
+    strcpy (msr->channel, mst->channel);
+    msr->samprate = mst->samprate;
+
+    if (!(mst->prvtptr = maketemplate (msr)))
+    {
+      fprintf (stderr, "[%s] Error duplicate MSRecord for template\n", file->path);
+      return -1;
     }
 
-    /* Read data block from file */
-    if (fread (datablock, finfo->blockSize, 1, ifp) < 1)
-    {
-      fprintf (stderr, "%s: Error reading data block, %d bytes from offset %d\n",
-               sdrfile, finfo->blockSize, finfo->filePosition);
-      break;
-    }
+    ((MSRecord *)mst->prvtptr)->sequence_number = ckp->sequence[idx];
+  }
+
+  mstg->traces    = ckp->mstg->traces;
+  mstg->numtraces = ckp->mstg->numtraces;
+
+  ckp->mstg->traces    = NULL;
+  ckp->mstg->numtraces = 0;
+
+  return 0;
+} /* End of restorecheckpoint() */
+
+/***************************************************************************
+ * savecheckpoint:
+ *
+ * Write the checkpoint of a file after its output was written: the
+ * last converted info block, the size of the output and the traces
+ * with the samples not yet packed.  With --final all samples were
+ * packed and the checkpoint is removed.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+savecheckpoint (struct sdrfile *file, MSTraceGroup *mstg, char *mseedfile)
+{
+  Checkpoint ckp;
+  MSTrace *mst;
+  struct stat st;
+  int idx;
+  int rv;
+
+  if (finalckp)
+    return checkpoint_remove (file->path);
+
+  if (stat (mseedfile, &st))
+  {
+    fprintf (stderr, "Cannot determine size of output file: %s (%s)\n",
+             mseedfile, strerror (errno));
+    return -1;
+  }
+
+  memset (&ckp, 0, sizeof (ckp));
+  ckp.version     = file->version;
+  ckp.samprate    = file->hblock.sampleRate;
+  ckp.numchannels = file->hblock.numChannels;
+  ckp.lastblock   = file->lastblock;
+  ckp.infohash    = infohash (&file->hblock, file->lastblock);
+  ckp.optionhash  = optionhash ();
+  ckp.outsize     = (int64_t)st.st_size;
+  ckp.mstg        = mstg;
+
+  if (mstg->numtraces > 0 &&
+      !(ckp.sequence = (int32_t *)calloc (mstg->numtraces, sizeof (int32_t))))
+  {
+    fprintf (stderr, "%s: Cannot allocate memory\n", file->path);
+    return -1;
+  }
+
+  for (mst = mstg->traces, idx = 0; mst && idx < mstg->numtraces; mst = mst->next, idx++)
+    ckp.sequence[idx] = (mst->prvtptr) ? ((MSRecord *)mst->prvtptr)->sequence_number : 0;
+
+  rv = checkpoint_write (file->path, &ckp);
+
+  if (verbose && rv == 0)
+    fprintf (stderr, "%s: Checkpoint after data block %d\n", file->path, file->lastblock + 1);
+
+  free (ckp.sequence);
+
+  return rv;
+} /* End of savecheckpoint() */
+
+/***************************************************************************
+ * infohash:
+ *
+ * Returns the hash of the info blocks of a header up to lastblock.
+ ***************************************************************************/
+static uint32_t
+infohash (HeaderBlock *hblock, int lastblock)
+{
+  return fnv_hash (hblock->fileInfo, (lastblock + 1) * sizeof (FileInfo), FNV_INIT);
+} /* End of infohash() */
+
+/***************************************************************************
+ * optionhash:
+ *
+ * Returns the hash of the options determining the output records, a
+ * checkpoint or manifest entry only applies to conversions with the
+ * same options.
+ ***************************************************************************/
+static uint32_t
+optionhash (void)
+{
+  char options[256];
+  char spec[64];
+  uint32_t hash;
+  int length;
+  int pidx;
+  int cidx;
+
+  length = snprintf (options, sizeof (options), "%s_%s_%s %d %d %d %d %c %d",
+                     network, station, location, packreclen, encoding,
+                     byteorder, srateblkt, sampletype, fixedpoint);
+
+  if (length < 0 || length >= (int)sizeof (options))
+    length = sizeof (options) - 1;
+
+  hash = fnv_hash (options, length, FNV_INIT);
+  hash = fnv_hash (chanlist, sizeof (chanlist), hash);
+
+  for (pidx = 0; pidx < numproducts; pidx++)
+  {
+    /* The ratio of a target rate is planned per input */
+    length = snprintf (spec, sizeof (spec), "%.17g %d",
+                       products[pidx].rate,
+                       (products[pidx].rate > 0.0) ? 0 : products[pidx].ratio);
+
+    hash = fnv_hash (spec, length, hash);
+    hash = fnv_hash (products[pidx].factors, products[pidx].nfactors * sizeof (int), hash);
+
+    for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+    {
+      if (products[pidx].channel[cidx])
+        hash = fnv_hash (products[pidx].channel[cidx], strlen (products[pidx].channel[cidx]) + 1, hash);
+    }
+  }
+
+  return hash;
+} /* End of optionhash() */
+
+/***************************************************************************
+ * closeinput:
+ *
+ * Wait for all queued reads of an input file and close it, the data
+ * block buffers are kept for the next file.
+ ***************************************************************************/
+static void
+closeinput (struct sdrinput *input)
+{
+  if (!input->path)
+    return;
+
+  if (input->hpending)
+    asyncio_wait (inaio, &input->hreq);
+
+  if (input->apending)
+    asyncio_wait (inaio, &input->areq);
+
+  while (input->nqueued > 0)
+  {
+    asyncio_wait (inaio, &input->reads[input->head].req);
+    input->head = (input->head + 1) % READAHEAD;
+    input->nqueued--;
+  }
+
+  asyncio_close (input->fd);
+
+  checkpoint_free (&input->checkpoint);
+
+  input->path     = NULL;
+  input->hpending = 0;
+  input->apending = 0;
+} /* End of closeinput() */
+
+/***************************************************************************
+ * freeinput:
+ *
+ * Close an input file and free the data block buffers.
+ ***************************************************************************/
+static void
+freeinput (struct sdrinput *input)
+{
+  int idx;
+
+  closeinput (input);
+
+  for (idx = 0; idx < READAHEAD; idx++)
+  {
+    free (input->reads[idx].buf);
+    input->reads[idx].buf  = NULL;
+    input->reads[idx].size = 0;
+  }
+} /* End of freeinput() */
+
+/***************************************************************************
+ * addtogroup:
+ *
+ * Add the samples in an MSRecord to a MSTraceGroup and create an
+ * MSRecord template for the MSTrace if needed.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+addtogroup (MSTraceGroup *mstg, MSRecord *msr, char *sdrfile)
+{
+  MSTrace *mst;
+
+  if (verbose > 2)
+  {
+    fprintf (stderr, "[%s] %lld samps @ %.6f Hz for N: '%s', S: '%s', L: '%s', C: '%s'\n",
+             sdrfile, (long long int)msr->numsamples, msr->samprate,
+             msr->network, msr->station, msr->location, msr->channel);
+  }
+
+  /* Add data to Group */
+  if (!(mst = mst_addmsrtogroup (mstg, msr, 0, -1.0, -1.0)))
+  {
+    fprintf (stderr, "[%s] Error adding samples to MSTraceGroup\n", sdrfile);
+    return -1;
+  }
+
+  /* Create an MSRecord template for the MSTrace by copying the current holder */
+  if (!mst->prvtptr && !(mst->prvtptr = maketemplate (msr)))
+  {
+    fprintf (stderr, "[%s] Error duplicate MSRecord for template\n", sdrfile);
+    return -1;
+  }
+
+  return 0;
+} /* End of addtogroup() */
+
+/***************************************************************************
+ * maketemplate:
+ *
+ * Create an MSRecord template for packing a trace by copying an
+ * MSRecord and adding blockettes 1000 and 1001, and 100 if requested.
+ *
+ * Returns the template on success, and NULL on failure.
+ ***************************************************************************/
+static MSRecord *
+maketemplate (MSRecord *msr)
+{
+  MSRecord *template;
+  struct blkt_1000_s Blkt1000;
+  struct blkt_1001_s Blkt1001;
+  struct blkt_100_s Blkt100;
+
+  if (!(template = msr_duplicate (msr, 0)))
+    return NULL;
+
+  /* Add blockettes 1000 & 1001 to template */
+  memset (&Blkt1000, 0, sizeof (struct blkt_1000_s));
+  msr_addblockette (template, (char *)&Blkt1000,
+                    sizeof (struct blkt_1001_s), 1000, 0);
+  memset (&Blkt1001, 0, sizeof (struct blkt_1001_s));
+  msr_addblockette (template, (char *)&Blkt1001,
+                    sizeof (struct blkt_1001_s), 1001, 0);
+
+  /* Add blockette 100 to template if requested */
+  if (srateblkt)
+  {
+    memset (&Blkt100, 0, sizeof (struct blkt_100_s));
+    Blkt100.samprate = (float)msr->samprate;
+    msr_addblockette (template, (char *)&Blkt100,
+                      sizeof (struct blkt_100_s), 100, 0);
+  }
+
+  return template;
+} /* End of maketemplate() */
+
+/***************************************************************************
+ * setchannel:
+ *
+ * Set the SEED channel code for an SDR channel index, either from the
+ * channel code list of the product or the channel number.
+ ***************************************************************************/
+static void
+setchannel (MSRecord *msr, int cidx, struct product *prod)
+{
+  char chanstr[4];
+
+  if (prod->channel[cidx] != NULL)
+    ms_strncpclean (msr->channel, prod->channel[cidx], 3);
+  else
+  {
+    snprintf (chanstr, sizeof (chanstr), "%03d", cidx + 1);
+    ms_strncpclean (msr->channel, chanstr, 3);
+  }
+} /* End of setchannel() */
+
+/***************************************************************************
+ * decimateblock:
+ *
+ * Pass a block of samples for each channel through the decimation
+ * tree of the channel and add any output samples of the decimated
+ * products to a MSTraceGroup.  The channels are decimated in parallel
+ * on the thread pool, the output is added to the group afterwards in
+ * channel order.
+ *
+ * The chandata array contains the block samples at the input sample
+ * rate for each channel, NULL for channels not decimated.  The
+ * MSRecord must contain the block start time and sample rate, it is
+ * used as a temporary holder for the output.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+decimateblock (MSTraceGroup *mstg, MSRecord *msr, void **chandata,
+               int *chansamples, char *sdrfile)
+{
+  struct decimjob jobs[MAX_CHANNELS];
+  void *args[MAX_CHANNELS];
+  hptime_t blocktime = msr->starttime;
+  double samprate = msr->samprate;
+  int njobs = 0;
+  int cidx;
+  int rv = 0;
+
+  /* Check continuity of each stream, breaks add flushed output to the group */
+  for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+  {
+    if (!chandata[cidx])
+      continue;
+
+    msr->numsamples = chansamples[cidx];
+
+    if (checkstream (mstg, msr, cidx, sdrfile))
+      return -1;
+
+    jobs[njobs].dstream = &decistreams[cidx];
+    jobs[njobs].input   = chandata[cidx];
+    jobs[njobs].nin     = chansamples[cidx];
+    jobs[njobs].rv      = 0;
+    args[njobs]         = &jobs[njobs];
+    njobs++;
+  }
+
+  /* Start the thread pool on first use */
+  if (!pool && threads > 1)
+  {
+    if (!(pool = tpool_init (threads)))
+      return -1;
+
+    if (verbose > 1)
+      fprintf (stderr, "Decimating with %d threads\n", tpool_threads (pool));
+  }
+
+  if (tpool_run (pool, decimatejob, args, njobs))
+    return -1;
+
+  for (cidx = 0, njobs = 0; cidx < MAX_CHANNELS && rv == 0; cidx++)
+  {
+    if (!chandata[cidx])
+      continue;
+
+    if (jobs[njobs++].rv)
+      rv = -1;
+    else
+      rv = addproducts (mstg, msr, cidx, sdrfile);
+  }
+
+  /* Restore block start time and sample rate */
+  msr->starttime = blocktime;
+  msr->samprate  = samprate;
+
+  return rv;
+} /* End of decimateblock() */
+
+/***************************************************************************
+ * checkstream:
+ *
+ * Check that a block of channel samples is contiguous with the current
+ * segment of the channel decimation stream, with a tolerance of 1/2
+ * sample.  If it is not the current segment is flushed and a new one
+ * started.  The block sample count is added to the segment.
+ *
+ * The MSRecord must contain the block start time, sample rate and
+ * sample count.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+checkstream (MSTraceGroup *mstg, MSRecord *msr, int cidx, char *sdrfile)
+{
+  struct decimstream *dstream = &decistreams[cidx];
+  hptime_t nexttime;
+  hptime_t hpdelta;
+  int node;
+
+  if (msr->sampletype != sampletype)
+  {
+    fprintf (stderr, "checkstream(): Unexpected sample type: '%c'\n",
+             msr->sampletype);
+    return -1;
+  }
+
+  if (dstream->insamples > 0)
+  {
+    nexttime = dstream->starttime +
+               (hptime_t) ((double)dstream->insamples / dstream->samprate * HPTMODULUS + 0.5);
+    hpdelta = (hptime_t) (0.5 / dstream->samprate * HPTMODULUS);
+
+    if (msr->samprate != dstream->samprate ||
+        msr->starttime > nexttime + hpdelta || msr->starttime < nexttime - hpdelta)
+    {
+      if (verbose > 1)
+        fprintf (stderr, "[%s] Decimation stream break for channel %d\n", sdrfile, cidx + 1);
+
+      if (flushstream (mstg, cidx, sdrfile))
+        return -1;
+    }
+  }
+
+  /* Start a new segment */
+  if (dstream->insamples == 0)
+  {
+    dstream->starttime = msr->starttime;
+    dstream->samprate  = msr->samprate;
+
+    for (node = 0; node < numnodes; node++)
+      dstream->outsamples[node] = 0;
+
+    if (verbose > 1)
+      fprintf (stderr, "Decimating channel %d time-series (%g sps) into %d node(s)\n",
+               cidx + 1, msr->samprate, numnodes - 1);
+  }
+
+  dstream->insamples += msr->numsamples;
+
+  return 0;
+} /* End of checkstream() */
+
+/***************************************************************************
+ * decimatejob:
+ *
+ * Thread pool job running a channel block through the decimation tree,
+ * each job only uses the state and buffers of its own stream.
+ ***************************************************************************/
+static void
+decimatejob (void *arg, int thread)
+{
+  struct decimjob *job = (struct decimjob *)arg;
+  StatsTimer timer;
+
+  STATS_START (&timer, thread);
+
+  job->rv = runtree (job->dstream, job->input, job->nin, 0);
+
+  STATS_STOP (&timer, thread, STAT_DECIMATE, (int64_t)job->nin * sizeof (int32_t), job->nin, 0);
+} /* End of decimatejob() */
+
+/***************************************************************************
+ * addproducts:
+ *
+ * Add the output of the last decimation tree run of a channel to a
+ * MSTraceGroup for each decimated product, and advance the segment
+ * output counts.  Output sample times follow from the segment start
+ * and the output count of the product node.
+ *
+ * The MSRecord is used as a temporary holder for the output.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+addproducts (MSTraceGroup *mstg, MSRecord *msr, int cidx, char *sdrfile)
+{
+  struct decimstream *dstream = &decistreams[cidx];
+  struct product *prod;
+  int ratio;
+  int node;
+  int pidx;
+
+  for (pidx = 0; pidx < numproducts; pidx++)
+  {
+    prod = &products[pidx];
+    node = prod->node;
+
+    if (node == 0 || dstream->nout[node] == 0)
+      continue;
+
+    ratio = decinodes[node].ratio;
+
+    setchannel (msr, cidx, prod);
+
+    msr->starttime = dstream->starttime +
+                     (hptime_t) ((double)dstream->outsamples[node] * ratio / dstream->samprate * HPTMODULUS + 0.5);
+    msr->samprate    = dstream->samprate / ratio;
+    msr->datasamples = dstream->work[node];
+    msr->samplecnt = msr->numsamples = dstream->nout[node];
+
+    if (addtogroup (mstg, msr, sdrfile))
+      return -1;
+  }
+
+  for (node = 1; node < numnodes; node++)
+    dstream->outsamples[node] += dstream->nout[node];
+
+  return 0;
+} /* End of addproducts() */
+
+/***************************************************************************
+ * flushstreams:
+ *
+ * Flush all decimation streams, see flushstream().
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+flushstreams (MSTraceGroup *mstg, char *sdrfile)
+{
+  int cidx;
+
+  for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+  {
+    if (flushstream (mstg, cidx, sdrfile))
+      return -1;
+  }
+
+  return 0;
+} /* End of flushstreams() */
+
+/***************************************************************************
+ * flushstream:
+ *
+ * Flush the remaining output of a channel decimation stream into a
+ * MSTraceGroup, ending the current segment.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+flushstream (MSTraceGroup *mstg, int cidx, char *sdrfile)
+{
+  struct decimstream *dstream = &decistreams[cidx];
+  MSRecord *msr = NULL;
+  StatsTimer timer;
+  int rv = 0;
+
+  if (dstream->insamples == 0)
+    return 0;
+
+  STATS_START (&timer, 0);
+
+  if (runtree (dstream, NULL, 0, 1))
+    return -1;
+
+  STATS_STOP (&timer, 0, STAT_DECIMATE, 0, 0, 0);
+
+  dstream->insamples = 0;
+
+  if (!(msr = msr_init (NULL)))
+  {
+    fprintf (stderr, "Cannot initialize MSRecord strcture\n");
+    return -1;
+  }
+
+  ms_strncpclean (msr->network, network, 2);
+  ms_strncpclean (msr->station, station, 5);
+  ms_strncpclean (msr->location, location, 2);
+  msr->sampletype = sampletype;
+
+  rv = addproducts (mstg, msr, cidx, sdrfile);
+
+  msr->datasamples = 0;
+  msr_free (&msr);
+
+  return rv;
+} /* End of flushstream() */
 
-    iblock = (InfoBlock *)datablock;
+/***************************************************************************
+ * runtree:
+ *
+ * Run samples through each node of the decimation tree for a stream,
+ * optionally flushing each node.  Each node decimates the output of
+ * its parent, node 0 being the input, so the stages shared by several
+ * products are only run once.  The decimators are created as needed.
+ *
+ * The output of each node is left in the work buffer of the node with
+ * the sample count in nout, valid until the next call.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+runtree (struct decimstream *dstream, void *input, int nin, flag flush)
+{
+  struct decimnode *dnode;
+  void *nodein;
+  void *nodeout;
+  int nodenin;
+  int maxout;
+  int nout;
+  int node;
+
+  for (node = 1; node < numnodes; node++)
+  {
+    dnode = &decinodes[node];
 
-    /* Sanity check ID */
-    if (iblock->goodID != GOOD_BLK_ID)
+    if (dnode->parent == 0)
     {
-      fprintf (stderr, "%s: Error reading data block, good ID not found at offset %d\n",
-               sdrfile, finfo->filePosition);
-      continue;
+      nodein  = input;
+      nodenin = nin;
     }
-
-    /* Report details */
-    if (verbose > 1)
+    else
     {
-      ms_hptime2mdtimestr (MS_EPOCH2HPTIME (iblock->startTime), stime, 0);
-
-      fprintf (stderr, "    Info block: %s, mstick: %d, size: %d\n",
-               stime, iblock->startTimeTick, iblock->blockSize);
+      nodein  = dstream->work[dnode->parent];
+      nodenin = dstream->nout[dnode->parent];
     }
 
-    /* Decompress or unpack data block */
-    if (headerversion == HDR_VERSION1)
-      mssamples = decompressSDR (&hblock, iblock, idx + 1, i16muxed);
-    else
-      mssamples = normalizeSDR24 (&hblock, iblock, idx + 1, i32muxed);
-
-    totalsamples += mssamples;
-
-    /* Determine time at day boundary */
-    ms_hptime2btime (MS_EPOCH2HPTIME (iblock->startTime), &btime);
-    btime.hour = btime.min = btime.sec = btime.fract = 0;
-    daytime                                          = ms_btime2hptime (&btime);
-
-    /* Determine start time, day boundary plus tick in milliseconds */
-    msr->starttime = daytime + ((hptime_t)iblock->startTimeTick * (HPTMODULUS / 1000));
-
-    /* Demultiplex data samples into channels and add to group */
-    for (cidx = 0; cidx < hblock.numChannels; cidx++)
+    if (!dstream->stage[node])
     {
-      /* Skip channel if not requested */
-      if (chanlist[cidx] == 0)
-        continue;
+      if (fixedpoint)
+        dstream->stage[node] = decim_init_fixed (dnode->factor, NULL, -1, -1);
+      else if (sampletype == 'f')
+        dstream->stage[node] = decim_init_float (dnode->factor, NULL, -1, -1);
+      else
+        dstream->stage[node] = decim_init (dnode->factor, NULL, -1, -1);
 
-      /* Extract channel samples from multiplexed array */
-      for (sidx = 0, midx = cidx; midx < mssamples; sidx++, midx += hblock.numChannels)
-      {
-        if (headerversion == HDR_VERSION1)
-          cdata[sidx] = i16muxed[midx];
-        else
-          cdata[sidx] = i32muxed[midx];
-      }
+      if (!dstream->stage[node])
+        return -1;
+    }
 
-      /* Set channel codes */
-      if (channel[cidx] != NULL)
-        ms_strncpclean (msr->channel, channel[cidx], 3);
-      else
-      {
-        snprintf (chanstr, sizeof (chanstr), "%03d", cidx + 1);
-        ms_strncpclean (msr->channel, chanstr, 3);
-      }
+    /* Grow node output buffer as needed, always allocated, int32_t and float samples are 4 bytes */
+    maxout = decim_maxoutput (dstream->stage[node], nodenin);
 
-      /* Set data array and sample count */
-      msr->datasamples = cdata;
-      msr->samplecnt = msr->numsamples = sidx;
+    if (maxout < 1)
+      maxout = 1;
 
-      if (verbose > 2)
+    if (maxout > dstream->worksize[node])
+    {
+      if (!(nodeout = realloc (dstream->work[node], maxout * sizeof (int32_t))))
       {
-        fprintf (stderr, "[%s] %lld samps @ %.6f Hz for N: '%s', S: '%s', L: '%s', C: '%s'\n",
-                 sdrfile, (long long int)msr->numsamples, msr->samprate,
-                 msr->network, msr->station, msr->location, msr->channel);
+        fprintf (stderr, "runtree(): Error allocating sample buffer\n");
+        return -1;
       }
 
-      /* Add data to Group */
-      if (!(mst = mst_addmsrtogroup (mstg, msr, 0, -1.0, -1.0)))
-      {
-        fprintf (stderr, "[%s] Error adding samples to MSTraceGroup\n", sdrfile);
-      }
+      dstream->work[node]     = nodeout;
+      dstream->worksize[node] = maxout;
+    }
 
-      /* Create an MSRecord template for the MSTrace by copying the current holder */
-      if (!mst->prvtptr)
-      {
-        mst->prvtptr = msr_duplicate (msr, 0);
+    nodeout = dstream->work[node];
 
-        if (!mst->prvtptr)
-        {
-          fprintf (stderr, "[%s] Error duplicate MSRecord for template\n", sdrfile);
-          return -1;
-        }
+    if ((nout = decim_process (dstream->stage[node], nodein, nodenin, sampletype, nodeout)) < 0)
+      return -1;
 
-        /* Add blockettes 1000 & 1001 to template */
-        memset (&Blkt1000, 0, sizeof (struct blkt_1000_s));
-        msr_addblockette ((MSRecord *)mst->prvtptr, (char *)&Blkt1000,
-                          sizeof (struct blkt_1001_s), 1000, 0);
-        memset (&Blkt1001, 0, sizeof (struct blkt_1001_s));
-        msr_addblockette ((MSRecord *)mst->prvtptr, (char *)&Blkt1001,
-                          sizeof (struct blkt_1001_s), 1001, 0);
+    if (flush)
+    {
+      if ((maxout = decim_flush (dstream->stage[node], (int32_t *)nodeout + nout, sampletype)) < 0)
+        return -1;
 
-        /* Add blockette 100 to template if requested */
-        if (srateblkt)
-        {
-          memset (&Blkt100, 0, sizeof (struct blkt_100_s));
-          Blkt100.samprate = (float)msr->samprate;
-          msr_addblockette ((MSRecord *)mst->prvtptr, (char *)&Blkt100,
-                            sizeof (struct blkt_100_s), 100, 0);
-        }
-      }
+      nout += maxout;
     }
-  } /* Done looping through file info blocks */
-
-  if (datablock)
-    free (datablock);
 
-  if (i16muxed)
-    free (i16muxed);
-
-  if (cdata)
-    free (cdata);
-
-  if (msr)
-  {
-    msr->datasamples = 0;
-    msr_free (&msr);
+    dstream->nout[node] = nout;
   }
 
-  return totalsamples;
-} /* End of sdr2group() */
+  return 0;
+} /* End of runtree() */
 
 /***************************************************************************
- * decompressSDR:
- *
- * Decompress SDR data block and place in supplied integer array.
+ * planproducts:
  *
- * The InfoBlock buffer contains the entire data block starting with
- * the InfoBlock, then the flag block and finally the compressed data.
- * Each reading is either 8- or 16-bit.  The flagBlk array contains a
- * flag for each data point telling whether it is 8- or 16-bit data.
+ * Build the decimation tree for the output products.  Products are
+ * planned in order of increasing decimation ratio, each one continuing
+ * from the node of the highest ratio product that divides its ratio
+ * so that common stages are shared.  Products with explicit factors
+ * use them from the input, sharing any identical leading stages.
  *
- * Routine from sdrmanip source code (windsdr.c) by Karl Cunningham.
- * Originally (probably) by Larry Cochrane.
+ * Planning is done once for products with fixed ratios and again when
+ * the input sample rate changes for products with target rates, in
+ * which case any pending decimation output for the previous plan is
+ * flushed first.  The filters of all stages are designed when
+ * planning, before any decimators are created.
  *
- * Returns number of samples decompressed on success and -1 on error.
+ * Returns 0 on success and -1 on error.
  ***************************************************************************/
-int
-decompressSDR (HeaderBlock *hblock, InfoBlock *iblock, int blocknum,
-               int16_t *i16data)
-{
-  int bitCount       = 0;
-  int samplesDecoded = 0;
-  int byteCnt;
-  int8_t *inPtr;
-  int16_t *outPtr;
-  int8_t *flagBlk;
-  int8_t tmpFlag;
+static int
+planproducts (MSTraceGroup *mstg, double samprate, char *sdrfile)
+{
+  static double plannedrate = 0.0;
+  struct product *prod;
+  int order[MAX_PRODUCTS];
+  int factors[MAX_DECIMATION];
+  int nfactors;
+  int byrate = 0;
   double ratio;
-  int tooShort = 0;
-  int numShort = 0;
-  int numChar  = 0;
+  double *fir;
+  int firnc;
+  int firsym;
+  int base;
+  int child;
+  int pidx;
+  int oidx;
+  int idx;
+  int cidx;
 
-  if (!hblock || !iblock || !i16data)
-    return -1;
+  for (pidx = 0; pidx < numproducts; pidx++)
+    if (products[pidx].rate > 0.0)
+      byrate = 1;
 
-  /* Decompress one minute's worth of data. Compute the data block
-   * size in bytes, and stop when we get to the end of the valid data. */
+  if (numnodes > 0 && (!byrate || samprate == plannedrate))
+    return 0;
 
-  byteCnt = iblock->blockSize - flagBlkSize (hblock->numSamples) - sizeof (InfoBlock);
+  /* Target rates are planned when the input sample rate is known */
+  if (byrate && samprate <= 0.0)
+    return 0;
 
-  if (verbose > 1)
-    fprintf (stderr, "  Decompressing block size: %d, flag block size: %d, bytes: %d\n",
-             iblock->blockSize, flagBlkSize (hblock->numSamples), byteCnt);
+  /* Determine ratios for target rates */
+  for (pidx = 0; pidx < numproducts; pidx++)
+  {
+    prod = &products[pidx];
+
+    if (prod->rate <= 0.0)
+      continue;
+
+    ratio = samprate / prod->rate;
+
+    if (ratio < 1.0 || fabs (ratio - floor (ratio + 0.5)) > 1e-6)
+    {
+      fprintf (stderr, "%s: Cannot decimate %g sps to %g sps by an integer factor\n",
+               sdrfile, samprate, prod->rate);
+      return -1;
+    }
+
+    prod->ratio = (int)floor (ratio + 0.5);
+  }
+
+  /* End segments decimated with a previous plan */
+  if (numnodes > 0)
+  {
+    if (flushstreams (mstg, sdrfile))
+      return -1;
 
-  outPtr  = i16data;
-  flagBlk = (int8_t *)iblock + sizeof (InfoBlock);
-  tmpFlag = *flagBlk;
-  inPtr   = (int8_t *)flagBlk + flagBlkSize (hblock->numSamples);
+    for (cidx = 0; cidx < MAX_CHANNELS; cidx++)
+      for (idx = 0; idx < numnodes; idx++)
+        decim_free (&decistreams[cidx].stage[idx]);
+  }
+
+  /* Node 0 is the input */
+  decinodes[0].parent = -1;
+  decinodes[0].factor = 1;
+  decinodes[0].ratio  = 1;
+  numnodes            = 1;
+
+  /* Order products by increasing ratio */
+  for (pidx = 0; pidx < numproducts; pidx++)
+  {
+    for (oidx = pidx; oidx > 0 && products[order[oidx - 1]].ratio > products[pidx].ratio; oidx--)
+      order[oidx] = order[oidx - 1];
 
-  while (byteCnt > 0)
+    order[oidx] = pidx;
+  }
+
+  for (oidx = 0; oidx < numproducts; oidx++)
   {
-    if (tmpFlag & 1) // 16-bit integer
+    prod = &products[order[oidx]];
+    base = 0;
+
+    if (prod->nfactors > 0)
+    {
+      memcpy (factors, prod->factors, prod->nfactors * sizeof (int));
+      nfactors = prod->nfactors;
+    }
+    else
     {
-      *outPtr++ = *((int16_t *)inPtr);
+      /* Continue from the highest planned ratio dividing this ratio */
+      for (idx = 0; idx < oidx; idx++)
+        if (prod->ratio % decinodes[products[order[idx]].node].ratio == 0)
+          base = products[order[idx]].node;
 
-      if ((verbose > 1) && (*(outPtr - 1)) && (*((outPtr - 1)) < 128) && (*((outPtr - 1)) > -127))
+      if ((nfactors = decim_plan (prod->ratio / decinodes[base].ratio,
+                                  MAX_DECIMATION, factors)) < 0)
       {
-        tooShort++;
+        fprintf (stderr, "Error, cannot plan decimation by a total factor of %d\n",
+                 prod->ratio);
+        return -1;
       }
-
-      inPtr += 2;
-      byteCnt -= 2;
-      numShort++;
     }
-    else // 8-bit integer
+
+    /* Add nodes for the stages, reusing existing identical nodes */
+    for (idx = 0; idx < nfactors; idx++)
     {
-      *outPtr++ = *((int8_t *)inPtr);
+      for (child = 1; child < numnodes; child++)
+        if (decinodes[child].parent == base && decinodes[child].factor == factors[idx])
+          break;
 
-      inPtr++;
-      byteCnt--;
-      numChar++;
-    }
+      if (child == numnodes)
+      {
+        if (numnodes >= MAX_NODES)
+        {
+          fprintf (stderr, "Error, more than %d decimation stages needed\n", MAX_NODES - 1);
+          return -1;
+        }
 
-    samplesDecoded++;
+        decinodes[child].parent = base;
+        decinodes[child].factor = factors[idx];
+        decinodes[child].ratio  = decinodes[base].ratio * factors[idx];
+        numnodes++;
+      }
 
-    if (++bitCount >= 8)
-    { // next bit
-      bitCount = 0;
-      tmpFlag  = *(++flagBlk);
-    }
-    else
-    {
-      tmpFlag >>= 1;
+      base = child;
     }
+
+    prod->node = base;
   }
 
-  if (byteCnt < 0)
+  /* Design the filters of all stages now, the filter cache is not
+   * locked and decimators are created on the pool threads */
+  for (idx = 1; idx < numnodes; idx++)
   {
-    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
-    fprintf (stderr, "  Flags did not match the number of data bytes when decompressing data in Block No %d\n",
-             blocknum);
+    if (decim_getfir (decinodes[idx].factor, &fir, &firnc, &firsym))
+    {
+      fprintf (stderr, "Error, cannot design the filter for decimation by %d\n",
+               decinodes[idx].factor);
+      return -1;
+    }
   }
 
-  if (verbose > 1)
-  {
-    ratio = (double)samplesDecoded * 2.0 / (iblock->blockSize - flagBlkSize (hblock->numSamples) - sizeof (InfoBlock));
+  plannedrate = samprate;
 
-    fprintf (stderr, "  Decompressed %d samples (for %d channels)  Compression: %.2f:1  numShort: %d  numChar: %d Too Short: %d\n",
-             samplesDecoded, hblock->numChannels, ratio, numShort, numChar, tooShort);
-  }
+  if (verbose)
+    reportplan ();
+
+  return 0;
+} /* End of planproducts() */
+
+/***************************************************************************
+ * reportplan:
+ *
+ * Print the decimation stages used for each output product, stages
+ * shared with a previously reported product are marked.
+ ***************************************************************************/
+static void
+reportplan (void)
+{
+  int path[MAX_NODES];
+  int reported[MAX_NODES];
+  int npath;
+  int node;
+  int pidx;
+  int idx;
+
+  for (node = 0; node < numnodes; node++)
+    reported[node] = 0;
 
-  if (samplesDecoded > (hblock->numChannels * hblock->sampleRate * BLOCK_LEN))
+  for (pidx = 0; pidx < numproducts; pidx++)
   {
-    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
-    fprintf (stderr, "  More than one minute's samples for %d channels * %d sps rate * %d seconds per block\n",
-             hblock->numChannels, hblock->sampleRate, BLOCK_LEN);
-  }
+    for (npath = 0, node = products[pidx].node; node > 0; node = decinodes[node].parent)
+      path[npath++] = node;
+
+    fprintf (stderr, "Product %d (%s): decimation by %d in %d stage(s):",
+             pidx + 1, (products[pidx].channel[0]) ? products[pidx].channel[0] : "001",
+             decinodes[products[pidx].node].ratio, npath);
+
+    for (idx = npath - 1; idx >= 0; idx--)
+    {
+      node = path[idx];
 
-  return samplesDecoded;
-} /* End of decompressSDR() */
+      fprintf (stderr, " %d (%d coefficients%s)", decinodes[node].factor,
+               decim_firlength (decinodes[node].factor), (reported[node]) ? ", shared" : "");
+
+      reported[node] = 1;
+    }
+
+    fprintf (stderr, "\n");
+  }
+} /* End of reportplan() */
 
 /***************************************************************************
- * normalizeSDR:
+ * packtraces:
  *
- * Convert 24-bit integer data to 32-bit integers.
+ * Pack all traces in a group using per-MSTrace templates.
  *
- * Routine referenced from drf2txt by Larry Cochrane.
+ * Returns 0 on success, and -1 on failure
+ ***************************************************************************/
+static void
+packtraces (MSTraceGroup *mstg, flag flush)
+{
+  MSTrace *mst;
+
+  for (mst = mstg->traces; mst; mst = mst->next)
+    packtrace (mst, flush);
+} /* End of packtraces() */
+
+/***************************************************************************
+ * packlatency:
  *
- * Returns number of samples decompressed on success and -1 on error.
+ * Pack the full records of all traces in a group after a block of
+ * span data time was added.  Samples not filling a record are packed
+ * in a partial record unless they can be held for the next block: the
+ * oldest sample would be less than the maximum latency of data time
+ * before the end of the next block.
  ***************************************************************************/
-int
-normalizeSDR24 (HeaderBlock *hblock, InfoBlock *iblock, int blocknum,
-                int32_t *i32data)
+static void
+packlatency (MSTraceGroup *mstg, hptime_t span)
 {
-  int samplesDecoded = 0;
-  int byteCnt;
-  uint8_t *inPtr;
-  uint8_t *outPtr;
+  MSTrace *mst;
 
-  if (!hblock || !iblock || !i32data)
-    return -1;
+  for (mst = mstg->traces; mst; mst = mst->next)
+  {
+    packtrace (mst, 0);
+
+    if (mst->numsamples > 0 &&
+        mst->endtime + span - mst->starttime >= (hptime_t)(latency * HPTMODULUS))
+      packtrace (mst, 1);
+  }
+} /* End of packlatency() */
 
-  /* Decompress one minute's worth of data. Compute the data block
-   * size in bytes, and stop when we get to the end of the valid data. */
+/***************************************************************************
+ * packtrace:
+ *
+ * Pack the samples of a trace using its template, all samples if
+ * flush is set and otherwise only full records.
+ ***************************************************************************/
+static void
+packtrace (MSTrace *mst, flag flush)
+{
+  StatsTimer timer;
+  int64_t trpackedsamples = 0;
+  int trpackedrecords     = 0;
 
-  byteCnt = iblock->blockSize - sizeof (InfoBlock);
+  if (mst->numsamples <= 0)
+    return;
 
-  if (verbose > 1)
-    fprintf (stderr, "  Decompressing block size: %d, bytes: %d\n",
-             iblock->blockSize, byteCnt);
+  STATS_START (&timer, 0);
 
-  inPtr  = (uint8_t *)iblock + sizeof (InfoBlock);
-  outPtr = (uint8_t *)i32data;
+  trpackedrecords = mst_pack (mst, &record_handler, 0, packreclen, encoding, byteorder,
+                              &trpackedsamples, flush, verbose - 3, (MSRecord *)mst->prvtptr);
 
-  /* Unpack 24-bit values into an array of 32-bit integers */
-  while (byteCnt > 0)
+  if (trpackedrecords < 0)
   {
-    /* Sign extension */
-    if (inPtr[0] & 0x80)
-      outPtr[3] = 0xFF;
-    else
-      outPtr[3] = 0x0;
-    outPtr[2]   = inPtr[0];
-    outPtr[1]   = inPtr[1];
-    outPtr[0]   = inPtr[2];
-
-    inPtr += 3;  /* Advance 24 bits */
-    outPtr += 4; /* Advance 32 bits */
-    byteCnt -= 3;
-    samplesDecoded++;
+    fprintf (stderr, "Error packing data\n");
   }
-
-  if (byteCnt < 0)
+  else
   {
-    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
-    fprintf (stderr, "  Flags did not match the number of data bytes when decompressing data in Block No %d\n",
-             blocknum);
+    packedrecords += trpackedrecords;
+    packedsamples += trpackedsamples;
+
+    STATS_STOP (&timer, 0, STAT_PACK, trpackedsamples * (int64_t)sizeof (int32_t),
+                trpackedsamples, trpackedrecords);
   }
+} /* End of packtrace() */
 
-  if (verbose > 1)
+/***************************************************************************
+ * record_handler:
+ * Saves passed records to the output file, records are gathered and
+ * written in batches of the write buffer size.  With a writer thread
+ * the record is copied to a buffer of the pool and queued for it.
+ ***************************************************************************/
+static void
+record_handler (char *record, int reclen, void *handlerdata)
+{
+  struct recbuf *rb;
+  StatsTimer timer;
+
+  STATS_START (&timer, 0);
+
+  if (recindexfp)
+    indexrecord (record, reclen);
+
+  if (!recpool.writer)
   {
-    fprintf (stderr, "  Decompressed %d samples (for %d channels)\n",
-             samplesDecoded, hblock->numChannels);
+    if (writerecord (record, reclen))
+      recpool.error = -1;
+
+    STATS_STOP (&timer, 0, STAT_WRITE, reclen, 0, 1);
+    return;
   }
 
-  if (samplesDecoded > (hblock->numChannels * hblock->sampleRate * BLOCK_LEN))
+  if (reclen > recpool.reclen)
   {
-    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
-    fprintf (stderr, "  More than one minute's samples for %d channels * %d sps rate * %d seconds per block\n",
-             hblock->numChannels, hblock->sampleRate, BLOCK_LEN);
+    fprintf (stderr, "Record length %d exceeds record buffer size %d\n",
+             reclen, recpool.reclen);
+    recpool.error = -1;
+    return;
   }
 
-  return samplesDecoded;
-} /* End of normalizeSDR24() */
+  /* Waits while all buffers are queued, bounding records in flight */
+  rb = (struct recbuf *)pipequeue_pop (recpool.freeq);
+
+  memcpy (rb->record, record, reclen);
+  rb->reclen = reclen;
+
+  pipequeue_push (recpool.recq, rb);
+
+  STATS_STOP (&timer, 0, STAT_WRITE, 0, 0, 0);
+} /* End of record_handler() */
+
+/***************************************************************************
+ * indexrecord:
+ * Add a record to the record index of the output file, the record
+ * header is unpacked for the source name and times and the record is
+ * at the current output offset.
+ ***************************************************************************/
+static void
+indexrecord (char *record, int reclen)
+{
+  int retcode;
+
+  if ((retcode = msr_unpack (record, reclen, &indexmsr, 0, 0)) != MS_NOERROR)
+    fprintf (stderr, "Error indexing record: %s\n", ms_errorstr (retcode));
+  else if (msr_writeindex (recindexfp, indexmsr, outoffset))
+    fprintf (stderr, "Error writing record index: %s\n", strerror (errno));
+
+  outoffset += reclen;
+} /* End of indexrecord() */
+
+/***************************************************************************
+ * writerecord:
+ * Write a record to the output file, its day file of the archive or
+ * the DataLink server, errors are reported by the writer.  With a
+ * maximum latency each record is written to the output file at once.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+writerecord (char *record, int reclen)
+{
+  if (archive)
+    return archive_write (archive, record, reclen);
+
+  if (datalink)
+    return dlclient_write (datalink, record, reclen);
+
+  if (recwriter_write (ofp, record, reclen))
+    return -1;
+
+  return (latency >= 0.0) ? recwriter_flush (ofp) : 0;
+} /* End of writerecord() */
 
 /***************************************************************************
- * decimate:
+ * openoutput:
+ * Open the output file and, when converting in stage threads, start a
+ * writer thread so records are written while following records are
+ * packed.  Without a writer thread records are written inline.
  *
- * Decimates the time-series by a given factor.  Integer and float
- * samples will be converted to doubles.
+ * If offset is not negative the existing output file is truncated to
+ * offset and records are appended after it.
  *
- * Returns 0 on success and non-zero on error.
+ * With --record-index the record index <path>.idx is also opened,
+ * except for stdout.
+ *
+ * With an archive directory the archive is opened instead, with a
+ * DataLink server address a connection to the server, path and
+ * offset are not used.  The records must fit the DataLink packets of
+ * the server, see datalinkreclen().
+ *
+ * Returns 0 on success, and -1 on failure.
  ***************************************************************************/
 static int
-decimate (MSTrace *mst, int factor)
+openoutput (char *path, int64_t offset)
 {
-  int numsamples;
+  char indexpath[1030];
+
+  if (archivedir)
+    archive = archive_open (archivelayout, archivedir, archiveopen, ARCHIVE_BUFSIZE);
+  else if (datalinkaddr)
+    datalink = dlclient_open (datalinkaddr, PACKAGE, datalinkack);
+  else if (offset >= 0)
+    ofp = recwriter_append (path, offset, writesize, outaio);
+  else
+    ofp = recwriter_open (path, writesize, (latency >= 0.0) ? NULL : outaio);
 
-  if (!mst)
+  if (ofp == NULL && archive == NULL && datalink == NULL)
     return -1;
 
-  /* Check for integer data */
-  if (mst->sampletype != 'i')
+  if (datalink && datalinkreclen ())
   {
-    fprintf (stderr, "decimate(): Unexpected sample type: '%c'\n",
-             mst->sampletype);
+    dlclient_close (&datalink);
     return -1;
   }
 
-  if (verbose)
-    fprintf (stderr, "Decimating time-series by a factor of %d (%g -> %g sps)\n",
-             factor, mst->samprate, mst->samprate / factor);
-
-  /* Perform the decimation and filtering on int32_t samples */
-  numsamples = idecimate (mst->datasamples, mst->numsamples, factor, NULL, -1, -1);
+  outoffset     = (offset > 0) ? offset : 0;
+  recpool.error = 0;
 
-  if (numsamples >= 0)
+  if (recindex && path && strcmp (path, "-"))
   {
-    /* Adjust sample rate, sample count, end time and sample buffer size */
-    mst->samprate /= factor;
-    mst->samplecnt  = numsamples;
-    mst->numsamples = numsamples;
-    mst->endtime    = mst->starttime +
-                   (((double)(mst->numsamples - 1) / mst->samprate * HPTMODULUS) + 0.5);
+    snprintf (indexpath, sizeof (indexpath), "%s.idx", path);
 
-    /* Reduce sample buffer to new size */
-    if (!(mst->datasamples = realloc (mst->datasamples, numsamples * sizeof (int32_t))))
+    if ((recindexfp = fopen (indexpath, "w")) == NULL)
     {
-      fprintf (stderr, "decimate(): Error reallocating sample buffer\n");
+      fprintf (stderr, "Cannot open record index file: %s (%s)\n",
+               indexpath, strerror (errno));
+      recwriter_close (&ofp);
       return -1;
     }
+
+    fprintf (recindexfp, "# NET_STA_LOC_CHAN_QUAL START END OFFSET RECLEN\n");
+  }
+
+  if (pipelined && (recpool.data || initrecpool () == 0))
+    recpool.writer = pipethread_start (writestage, NULL);
+
+  return 0;
+} /* End of openoutput() */
+
+/***************************************************************************
+ * datalinkreclen:
+ *
+ * Check the record length against the packet size of the DataLink
+ * server.  Without -r the record length is set to the largest power
+ * of two up to 4096 that fits the packets.
+ *
+ * Returns 0 on success, and -1 if the records do not fit.
+ ***************************************************************************/
+static int
+datalinkreclen (void)
+{
+  int packetsize = dlclient_packetsize (datalink);
+  int reclen     = packreclen;
+
+  if (reclen <= 0)
+  {
+    for (reclen = 4096; reclen > 128 && reclen > packetsize; reclen /= 2)
+      ;
+  }
+
+  if (reclen > packetsize)
+  {
+    fprintf (stderr, "Error, record length %d exceeds the DataLink packet size %d of the server\n",
+             reclen, packetsize);
+    return -1;
+  }
+
+  if (verbose && packreclen <= 0)
+    fprintf (stderr, "Packing records of %d bytes for DataLink packets of %d bytes\n",
+             reclen, packetsize);
+
+  packreclen = reclen;
+
+  return 0;
+} /* End of datalinkreclen() */
+
+/***************************************************************************
+ * closeoutput:
+ * Write any buffered records and close the output file and record
+ * index, the archive or the DataLink connection.  A writer thread is
+ * stopped after writing all queued records.
+ *
+ * Returns 0 on success, and -1 on failure, also when writing any
+ * record failed.
+ ***************************************************************************/
+static int
+closeoutput (void)
+{
+  struct recbuf *rb;
+  StatsTimer timer;
+  int rv;
+
+  STATS_START (&timer, 0);
+
+  if (recpool.writer)
+  {
+    rb         = (struct recbuf *)pipequeue_pop (recpool.freeq);
+    rb->reclen = 0;
+    pipequeue_push (recpool.recq, rb);
+
+    pipethread_join (&recpool.writer);
   }
+
+  if (archive)
+    rv = archive_close (&archive);
+  else if (datalink)
+    rv = dlclient_close (&datalink);
   else
+    rv = recwriter_close (&ofp);
+
+  /* Records not written before closing */
+  if (recpool.error)
+    rv = -1;
+
+  if (recindexfp && fclose (recindexfp))
+  {
+    fprintf (stderr, "Error writing record index: %s\n", strerror (errno));
+    rv = -1;
+  }
+
+  recindexfp = 0;
+
+  STATS_STOP (&timer, 0, STAT_WRITE, 0, 0, 0);
+
+  return rv;
+} /* End of closeoutput() */
+
+/***************************************************************************
+ * initrecpool:
+ * Allocate the record buffer pool, WRITEDEPTH buffers of the packing
+ * record length, and the queues passing them to and from the writer.
+ * All buffers start in the free queue.
+ *
+ * Returns 0 on success, and -1 on failure.
+ ***************************************************************************/
+static int
+initrecpool (void)
+{
+  int idx;
+
+  recpool.nbufs  = WRITEDEPTH;
+  recpool.reclen = (packreclen > 0) ? packreclen : 4096;
+
+  if (!(recpool.recq = pipequeue_init ("write", recpool.nbufs)) ||
+      !(recpool.freeq = pipequeue_init ("writefree", recpool.nbufs)) ||
+      !(recpool.bufs = (struct recbuf *)calloc (recpool.nbufs, sizeof (struct recbuf))) ||
+      !(recpool.data = (char *)malloc ((size_t)recpool.nbufs * recpool.reclen)))
   {
-    fprintf (stderr, "decimate(): Error decimating time-series\n");
+    freerecpool ();
     return -1;
   }
 
-  return 0;
-} /* End of decimate() */
+  for (idx = 0; idx < recpool.nbufs; idx++)
+  {
+    recpool.bufs[idx].record = recpool.data + (size_t)idx * recpool.reclen;
+    pipequeue_push (recpool.freeq, &recpool.bufs[idx]);
+  }
+
+  return 0;
+} /* End of initrecpool() */
+
+/***************************************************************************
+ * freerecpool:
+ * Free the record buffer pool and its queues, the writer thread must
+ * be stopped.
+ ***************************************************************************/
+static void
+freerecpool (void)
+{
+  pipequeue_free (&recpool.recq);
+  pipequeue_free (&recpool.freeq);
+
+  free (recpool.bufs);
+  free (recpool.data);
+
+  recpool.bufs = NULL;
+  recpool.data = NULL;
+} /* End of freerecpool() */
 
 /***************************************************************************
- * packtraces:
- *
- * Pack all traces in a group using per-MSTrace templates.
- *
- * Returns 0 on success, and -1 on failure
+ * writestage:
+ * Writer thread, write the queued records to the output file and
+ * return the buffers to the pool until a stop record.  A failed write
+ * is recorded in the pool for closeoutput().
  ***************************************************************************/
 static void
-packtraces (MSTraceGroup *mstg, flag flush)
+writestage (void *arg)
 {
-  MSTrace *mst;
-  int64_t trpackedsamples = 0;
-  int trpackedrecords     = 0;
+  struct recbuf *rb;
+  StatsTimer timer;
+  int reclen;
 
-  mst = mstg->traces;
-  while (mst)
+  do
   {
+    rb     = (struct recbuf *)pipequeue_pop (recpool.recq);
+    reclen = rb->reclen;
 
-    if (mst->numsamples <= 0)
+    if (reclen > 0)
     {
-      mst = mst->next;
-      continue;
-    }
+      STATS_START (&timer, WRITETHREAD);
 
-    trpackedrecords = mst_pack (mst, &record_handler, 0, packreclen, encoding, byteorder,
-                                &trpackedsamples, flush, verbose - 3, (MSRecord *)mst->prvtptr);
+      if (writerecord (rb->record, reclen))
+        recpool.error = -1;
 
-    if (trpackedrecords < 0)
-    {
-      fprintf (stderr, "Error packing data\n");
-    }
-    else
-    {
-      packedrecords += trpackedrecords;
-      packedsamples += trpackedsamples;
+      STATS_STOP (&timer, WRITETHREAD, STAT_WRITE, reclen, 0, 1);
     }
 
-    mst = mst->next;
-  }
-} /* End of packtraces() */
-
-/***************************************************************************
- * record_handler:
- * Saves passed records to the output file.
- ***************************************************************************/
-static void
-record_handler (char *record, int reclen, void *handlerdata)
-{
-  if (fwrite (record, reclen, 1, ofp) != 1)
-  {
-    fprintf (stderr, "Error writing to output file\n");
-  }
-} /* End of record_handler() */
+    pipequeue_push (recpool.freeq, rb);
+  } while (reclen > 0);
+} /* End of writestage() */
 
 /***************************************************************************
  * parameter_proc:
@@ -830,6 +3925,8 @@ parameter_proc (int argcount, char **argvec)
   char *channelstr  = NULL;
   char *chanliststr = NULL;
   char *deciliststr = NULL;
+  double decirate   = 0.0;
+  struct product *prod;
 
   /* Process all command line arguments */
   for (optind = 1; optind < argcount; optind++)
@@ -856,6 +3953,37 @@ parameter_proc (int argcount, char **argvec)
     {
       deciliststr = getoptval (argcount, argvec, optind++);
     }
+    else if (strcmp (argvec[optind], "--rate") == 0)
+    {
+      decirate = strtod (getoptval (argcount, argvec, optind++), NULL);
+    }
+    else if (strcmp (argvec[optind], "--stats") == 0)
+    {
+      printstats = 1;
+    }
+    else if (strcmp (argvec[optind], "--stats-json") == 0)
+    {
+      statsjson = getoptval (argcount, argvec, optind++);
+    }
+    else if (strcmp (argvec[optind], "-P") == 0)
+    {
+      if (numproducts >= MAX_PRODUCTS)
+      {
+        fprintf (stderr, "Error, more than %d output products specified\n", MAX_PRODUCTS);
+        exit (1);
+      }
+
+      if (parseproduct (getoptval (argcount, argvec, optind++), &products[numproducts++]))
+        exit (1);
+    }
+    else if (strcmp (argvec[optind], "-Q") == 0)
+    {
+      fixedpoint = 1;
+    }
+    else if (strcmp (argvec[optind], "-T") == 0)
+    {
+      threads = strtoul (getoptval (argcount, argvec, optind++), NULL, 10);
+    }
     else if (strcmp (argvec[optind], "-n") == 0)
     {
       network = getoptval (argcount, argvec, optind++);
@@ -892,6 +4020,109 @@ parameter_proc (int argcount, char **argvec)
     {
       outputfile = getoptval (argcount, argvec, optind++);
     }
+    else if (strcmp (argvec[optind], "--sds") == 0)
+    {
+      archivedir    = getoptval (argcount, argvec, optind++);
+      archivelayout = ARCHIVE_SDS;
+    }
+    else if (strcmp (argvec[optind], "--bud") == 0)
+    {
+      archivedir    = getoptval (argcount, argvec, optind++);
+      archivelayout = ARCHIVE_BUD;
+    }
+    else if (strcmp (argvec[optind], "--datalink") == 0)
+    {
+      datalinkaddr = getoptval (argcount, argvec, optind++);
+    }
+    else if (strcmp (argvec[optind], "--no-ack") == 0)
+    {
+      datalinkack = 0;
+    }
+    else if (strcmp (argvec[optind], "--latency") == 0)
+    {
+      latency = strtod (getoptval (argcount, argvec, optind++), NULL);
+    }
+    else if (strcmp (argvec[optind], "--open-files") == 0)
+    {
+      archiveopen = strtoul (getoptval (argcount, argvec, optind++), NULL, 10);
+    }
+    else if (strcmp (argvec[optind], "-ts") == 0)
+    {
+      if ((winstart = parsetime (getoptval (argcount, argvec, optind++))) == HPTERROR)
+      {
+        fprintf (stderr, "Error, invalid start time: %s\n", argvec[optind]);
+        exit (1);
+      }
+    }
+    else if (strcmp (argvec[optind], "-te") == 0)
+    {
+      if ((winend = parsetime (getoptval (argcount, argvec, optind++))) == HPTERROR)
+      {
+        fprintf (stderr, "Error, invalid end time: %s\n", argvec[optind]);
+        exit (1);
+      }
+    }
+    else if (strcmp (argvec[optind], "-B") == 0)
+    {
+      writesize = strtoul (getoptval (argcount, argvec, optind++), NULL, 10);
+    }
+    else if (strcmp (argvec[optind], "--io") == 0)
+    {
+      if ((iobackend = asyncio_parse (getoptval (argcount, argvec, optind++))) < 0)
+      {
+        fprintf (stderr, "Error, unknown I/O backend: %s\n", argvec[optind]);
+        exit (1);
+      }
+    }
+    else if (strcmp (argvec[optind], "--pipeline") == 0)
+    {
+      pipelined = 1;
+    }
+    else if (strcmp (argvec[optind], "--serial") == 0)
+    {
+      pipelined = 0;
+    }
+    else if (strcmp (argvec[optind], "--inventory") == 0)
+    {
+      inventorymode = 1;
+    }
+    else if (strcmp (argvec[optind], "--inventory-blocks") == 0)
+    {
+      inventorymode   = 1;
+      inventoryblocks = 1;
+    }
+    else if (strcmp (argvec[optind], "--index") == 0)
+    {
+      indexing = 1;
+    }
+    else if (strcmp (argvec[optind], "--record-index") == 0)
+    {
+      recindex = 1;
+    }
+    else if (strcmp (argvec[optind], "--checkpoint") == 0)
+    {
+      checkpointing = 1;
+    }
+    else if (strcmp (argvec[optind], "--final") == 0)
+    {
+      finalckp = 1;
+    }
+    else if (strcmp (argvec[optind], "--watch") == 0)
+    {
+      addnode (&watchlist, NULL, getoptval (argcount, argvec, optind++));
+    }
+    else if (strcmp (argvec[optind], "--settle") == 0)
+    {
+      settle = strtoul (getoptval (argcount, argvec, optind++), NULL, 10);
+    }
+    else if (strcmp (argvec[optind], "--journal") == 0)
+    {
+      journalfile = getoptval (argcount, argvec, optind++);
+    }
+    else if (strcmp (argvec[optind], "--manifest") == 0)
+    {
+      manifestfile = getoptval (argcount, argvec, optind++);
+    }
     else if (strncmp (argvec[optind], "-", 1) == 0 &&
              strlen (argvec[optind]) > 1)
     {
@@ -904,8 +4135,61 @@ parameter_proc (int argcount, char **argvec)
     }
   }
 
+  /* Input files are found in watched directories */
+  if (watchlist && (filelist || outputfile || inventorymode))
+  {
+    fprintf (stderr, "Error, watching directories (--watch) is exclusive with input files, -o and --inventory\n");
+    exit (1);
+  }
+
+  /* Records are written as blocks are converted to the single output */
+  if (latency >= 0.0 && !outputfile && !datalinkaddr)
+  {
+    fprintf (stderr, "Error, a maximum latency (--latency) requires -o or --datalink\n");
+    exit (1);
+  }
+
+  /* The records are written to stdout with -o - */
+  if (statsjson && outputfile && !strcmp (statsjson, "-") && !strcmp (outputfile, "-"))
+  {
+    fprintf (stderr, "Error, statistics (--stats-json) cannot be written to stdout with the records (-o -)\n");
+    exit (1);
+  }
+
+  /* Records are routed to the day files of the archive */
+  if (archivedir && (outputfile || datalinkaddr || recindex || checkpointing ||
+                     manifestfile || watchlist || inventorymode))
+  {
+    fprintf (stderr, "Error, archive output (--sds, --bud) is exclusive with -o, --datalink, --record-index, --checkpoint, --manifest, --watch and --inventory\n");
+    exit (1);
+  }
+
+  /* Records are sent to the DataLink server */
+  if (datalinkaddr && (outputfile || recindex || checkpointing || manifestfile ||
+                       watchlist || inventorymode))
+  {
+    fprintf (stderr, "Error, DataLink output (--datalink) is exclusive with -o, --record-index, --checkpoint, --manifest, --watch and --inventory\n");
+    exit (1);
+  }
+
+  /* All input files are converted to a single output */
+  if (outputfile)
+    sharedoutput = outputfile;
+  else if (archivedir)
+    sharedoutput = archivedir;
+  else
+    sharedoutput = datalinkaddr;
+
+  /* The manifest records per-file output of whole files */
+  if (manifestfile && (watchlist || outputfile || inventorymode ||
+                       winstart != HPTERROR || winend != HPTERROR))
+  {
+    fprintf (stderr, "Error, the manifest (--manifest) is exclusive with --watch, -o, -ts, -te and --inventory\n");
+    exit (1);
+  }
+
   /* Make sure an input files were specified */
-  if (filelist == 0)
+  if (filelist == 0 && watchlist == 0)
   {
     fprintf (stderr, "No input files were specified\n\n");
     fprintf (stderr, "%s version %s\n\n", PACKAGE, VERSION);
@@ -917,27 +4201,10 @@ parameter_proc (int argcount, char **argvec)
   if (verbose)
     fprintf (stderr, "%s version: %s\n", PACKAGE, VERSION);
 
-  /* Init channel code list */
-  for (idx = 0; idx < MAX_CHANNELS; idx++)
-    channel[idx] = NULL;
-
-  /* Parse channel code list */
-  if (channelstr)
+  if (winstart != HPTERROR && winend != HPTERROR && winend <= winstart)
   {
-    char *ptr = strdup (channelstr);
-
-    /* Parse comma separated list */
-    idx          = 0;
-    channel[idx] = ptr;
-    while ((ptr = strchr (ptr, ',')) != NULL)
-      {
-        idx++;
-        *ptr++ = '\0';
-        channel[idx] = ptr;
-
-        if (idx > MAX_CHANNELS)
-          break;
-      }
+    fprintf (stderr, "Error, end time must be after start time\n");
+    exit (1);
   }
 
   /* Parse channel selection list */
@@ -986,44 +4253,84 @@ parameter_proc (int argcount, char **argvec)
       chanlist[idx] = 1;
   }
 
-  /* Initialize for no decimation */
-  for (idx        = 0; idx < MAX_DECIMATION; idx++)
-    decilist[idx] = 0;
+  if (deciliststr && decirate)
+  {
+    fprintf (stderr, "Error, decimation factors (-D) and target rate (--rate) are exclusive\n");
+    exit (1);
+  }
 
-  /* Parse decimation list */
-  if (deciliststr)
+  if (numproducts > 0 && (channelstr || deciliststr || decirate))
   {
-    char *sarr[MAX_DECIMATION];
-    char *ptr;
-    int count = 1;
-    int factor;
+    fprintf (stderr, "Error, output products (-P) are exclusive with -c, -D and --rate\n");
+    exit (1);
+  }
 
-    /* Parse comma separated list */
-    ptr       = deciliststr;
-    idx       = 0;
-    sarr[idx] = ptr;
-    while ((ptr = strchr (ptr, ',')) != NULL)
+  if (decirate < 0.0)
+  {
+    fprintf (stderr, "Error, invalid target sample rate: %g\n", decirate);
+    exit (1);
+  }
+
+  /* Float encoding carries the whole pipeline in single precision */
+  if (encoding == DE_FLOAT32)
+    sampletype = 'f';
+
+  if (fixedpoint && sampletype == 'f')
+  {
+    fprintf (stderr, "Error, fixed-point decimation (-Q) cannot be used with float encoding\n");
+    exit (1);
+  }
+
+  /* Without products a single product is defined by -c, -D and --rate */
+  if (numproducts == 0)
+  {
+    prod        = &products[numproducts++];
+    prod->ratio = 1;
+    prod->rate  = decirate;
+
+    if (channelstr && parsechannels (channelstr, prod->channel))
+      exit (1);
+
+    if (deciliststr && parsefactors (deciliststr, prod))
+      exit (1);
+  }
+
+  /* Scan inventory files with the given threads or the default */
+  invthreads = (threads > 0) ? threads : INVENTORYTHREADS;
+
+  /* Default to a decimation thread per CPU, at most one per channel */
+  if (threads <= 0)
+    threads = tpool_cpucount ();
+  if (threads > MAX_CHANNELS)
+    threads = MAX_CHANNELS;
+
+  /* Plan decimation, products with target rates are planned for the input */
+  if (planproducts (NULL, 0.0, NULL))
+    exit (1);
+
+  /* Checkpoints hold the traces of per-file output at the input rate */
+  if (checkpointing)
+  {
+    if (outputfile || winstart != HPTERROR || winend != HPTERROR || recindex)
     {
-      idx++;
-      *ptr++    = '\0';
-      sarr[idx] = ptr;
-      count++;
+      fprintf (stderr, "Error, checkpoints (--checkpoint) are exclusive with -o, -ts, -te and --record-index\n");
+      exit (1);
     }
 
-    /* Populate decimation list */
-    for (idx = 0; idx < count && idx < MAX_DECIMATION; idx++)
+    for (idx = 0; idx < numproducts; idx++)
     {
-      factor = strtoul (sarr[idx], NULL, 10);
-
-      if (factor < 2 || factor > 7)
+      if (products[idx].node != 0 || products[idx].rate > 0.0)
       {
-        fprintf (stderr, "Error, invalid decimation factor: %d, must be 2-7\n", factor);
+        fprintf (stderr, "Error, checkpoints (--checkpoint) cannot be used with decimation\n");
         exit (1);
       }
-
-      decilist[idx] = factor;
     }
   }
+  else if (finalckp)
+  {
+    fprintf (stderr, "Error, --final requires --checkpoint\n");
+    exit (1);
+  }
 
   /* Check the input files for any list files, if any are found
    * remove them from the list and add the contained list */
@@ -1070,6 +4377,172 @@ parameter_proc (int argcount, char **argvec)
   return 0;
 } /* End of parameter_proc() */
 
+/***************************************************************************
+ * parseproduct:
+ *
+ * Parse an output product specification of the form:
+ *   factor[,factor...]:chan[,chan...]
+ *   <rate>sps:chan[,chan...]
+ *
+ * A single factor of 1 specifies the input sample rate.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+parseproduct (char *spec, struct product *prod)
+{
+  char *str;
+  char *chans;
+  char *endptr;
+  int rv = -1;
+
+  if (!(str = strdup (spec)))
+  {
+    fprintf (stderr, "Cannot allocate memory\n");
+    return -1;
+  }
+
+  if (!(chans = strchr (str, ':')))
+  {
+    fprintf (stderr, "Error, output product not factors:channels or <rate>sps:channels: %s\n",
+             spec);
+    free (str);
+    return -1;
+  }
+
+  *chans++    = '\0';
+  prod->ratio = 1;
+
+  /* Target sample rate */
+  if (strlen (str) > 3 && strcmp (str + strlen (str) - 3, "sps") == 0)
+  {
+    prod->rate = strtod (str, &endptr);
+
+    if (prod->rate <= 0.0 || strcmp (endptr, "sps"))
+      fprintf (stderr, "Error, invalid target sample rate: %s\n", str);
+    else
+      rv = 0;
+  }
+  /* Decimation factors, other than the input rate */
+  else if (!strcmp (str, "1") || !parsefactors (str, prod))
+  {
+    rv = 0;
+  }
+
+  /* The channel codes are copied */
+  if (rv == 0)
+    rv = parsechannels (chans, prod->channel);
+
+  free (str);
+
+  return rv;
+} /* End of parseproduct() */
+
+/***************************************************************************
+ * parsefactors:
+ *
+ * Parse a comma separated list of decimation factors into a product.
+ * If any factor does not have an internal filter (greater than 7) the
+ * stages are planned for the total ratio instead.  The total ratio
+ * must not exceed INT_MAX.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+parsefactors (char *str, struct product *prod)
+{
+  char *ptr = str;
+  long factor;
+  int plan = 0;
+  int idx  = 0;
+
+  prod->ratio = 1;
+
+  while (ptr)
+  {
+    if (idx >= MAX_DECIMATION)
+    {
+      fprintf (stderr, "Error, more than %d decimation factors specified\n", MAX_DECIMATION);
+      return -1;
+    }
+
+    factor = strtol (ptr, NULL, 10);
+
+    if (factor < 2)
+    {
+      fprintf (stderr, "Error, invalid decimation factor: %ld, must be 2 or greater\n", factor);
+      return -1;
+    }
+
+    if (factor > INT_MAX / prod->ratio)
+    {
+      fprintf (stderr, "Error, total decimation ratio of %s exceeds %d\n", str, INT_MAX);
+      return -1;
+    }
+
+    /* Factors without internal filters trigger stage planning */
+    if (factor > 7)
+      plan = 1;
+
+    prod->factors[idx++] = (int)factor;
+    prod->ratio *= (int)factor;
+
+    if ((ptr = strchr (ptr, ',')) != NULL)
+      ptr++;
+  }
+
+  prod->nfactors = (plan) ? 0 : idx;
+
+  return 0;
+} /* End of parsefactors() */
+
+/***************************************************************************
+ * parsechannels:
+ *
+ * Parse a comma separated list of SEED channel codes into an array
+ * indexed by SDR channel.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+parsechannels (char *str, char **chanarr)
+{
+  char *ptr = strdup (str);
+  int idx   = 0;
+
+  chanarr[idx] = ptr;
+  while ((ptr = strchr (ptr, ',')) != NULL)
+  {
+    if (++idx >= MAX_CHANNELS)
+    {
+      fprintf (stderr, "Error, more than %d channel codes specified\n", MAX_CHANNELS);
+      return -1;
+    }
+
+    *ptr++       = '\0';
+    chanarr[idx] = ptr;
+  }
+
+  return 0;
+} /* End of parsechannels() */
+
+/***************************************************************************
+ * parsetime:
+ *
+ * Parse a time as YYYY[-MM-DDThh:mm:ss.ffff] or, if it contains a
+ * comma, as YYYY[,DDD,hh:mm:ss.ffff].
+ *
+ * Returns the time on success and HPTERROR on error.
+ ***************************************************************************/
+static hptime_t
+parsetime (char *timestr)
+{
+  if (strchr (timestr, ','))
+    return ms_seedtimestr2hptime (timestr);
+
+  return ms_timestr2hptime (timestr);
+} /* End of parsetime() */
+
 /***************************************************************************
  * getoptval:
  * Return the value to a command line option; checking that the value is
@@ -1092,8 +4565,9 @@ getoptval (int argcount, char **argvec, int argopt)
     return 0;
   }
 
-  /* Special case of '-o -' usage */
-  if ((argopt + 1) < argcount && strcmp (argvec[argopt], "-o") == 0)
+  /* Special case of '-o -' and '--stats-json -' usage */
+  if ((argopt + 1) < argcount &&
+      (strcmp (argvec[argopt], "-o") == 0 || strcmp (argvec[argopt], "--stats-json") == 0))
     if (strcmp (argvec[argopt + 1], "-") == 0)
       return argvec[argopt + 1];
 
@@ -1266,18 +4740,72 @@ usage (void)
            " -h              Show this usage message\n"
            " -v              Be more verbose, multiple flags can be used\n"
            " -C chanlist     List of channel numbers to extract (1-8), e.g. 1,2,3\n"
-           " -D fact,fact,.. Decimate data by various factors (2-7), e.g. 5,4\n"
+           " -D fact,fact,.. Decimate data by one or more factors, e.g. 5,4 or 200\n"
+           " --rate sps      Decimate data to a target sample rate, e.g. 1\n"
+           " -Q              Decimate using fixed-point integer arithmetic\n"
+           " -T threads      Number of decimation threads, default: number of CPUs\n"
+           " -P fact:chans   Add an output product, decimation factors or rate and\n"
+           "                   channel codes, e.g. 1:HHZ,HHN,HHE or 1sps:LHZ,LHN,LHE\n"
+           "                   Repeat for each product, exclusive with -D, --rate and -c\n"
            "\n"
            " -n netcode      Specify the SEED network code, default is XX\n"
            " -s stacode      Specify the SEED station code, default is SDR\n"
            " -l locid        Specify the SEED location ID, default is blank (space-space)\n"
            " -c chanlist     Specify list of SEED channel codes, default is channel number\n"
            " -S              Include SEED blockette 100 for very irrational sample rates\n"
-           " -r bytes        Specify record length in bytes for packing, default: 4096\n"
+           " -r bytes        Specify record length in bytes for packing, default: 4096,\n"
+           "                   with --datalink at most the server packet size\n"
            " -e encoding     Specify SEED encoding format for packing, default: 11 (Steim2)\n"
            " -b byteorder    Specify byte order for packing, MSBF: 1 (default), LSBF: 0\n"
            "\n"
            " -o outfile      Specify the output file, default is <inputfile>.mseed\n"
+           " --datalink host[:port]\n"
+           "                 Send records to a DataLink server, default port: 16000\n"
+           " --no-ack        Do not request acknowledgements of the DataLink server\n"
+           " --latency secs  With -o or --datalink, write the records of each block as\n"
+           "                   it is converted, samples held secs of data time in a\n"
+           "                   partial record\n"
+           " --sds dir       Write records to day files of an SDS archive under dir:\n"
+           "                   YEAR/NET/STA/CHAN.D/NET.STA.LOC.CHAN.D.YEAR.DAY\n"
+           " --bud dir       Write records to day files of a BUD archive under dir:\n"
+           "                   NET/STA/STA.NET.LOC.CHAN.YEAR.DAY\n"
+           " --open-files n  Maximum number of archive day files kept open, default: 64\n"
+           " -ts time        Convert only samples at or after time,\n"
+           "                   YYYY-MM-DDThh:mm:ss.ffff or YYYY,DDD,hh:mm:ss.ffff,\n"
+           "                   only blocks in the window are read\n"
+           " -te time        Convert only samples before time\n"
+           " -B bytes        Bytes of records gathered for each write, default: 1048576\n"
+           " --record-index  Write an index of the output records, <outfile>.idx: source\n"
+           "                   name, start and end time, byte offset and record length\n"
+           " --io backend    I/O backend: auto (default), uring, threads or sync\n"
+           " --pipeline      Read, decode and convert in stage threads, default with\n"
+           "                   more than one CPU\n"
+           " --serial        Read, decode and convert in one thread\n"
+           " --inventory     Report coverage and gaps from the file headers, no conversion\n"
+           " --inventory-blocks\n"
+           "                 As --inventory with block start times from each info block,\n"
+           "                   files with a valid index use the index\n"
+           " --index         Write a block index <inputfile>.idx when converting a whole\n"
+           "                   file, used to skip files outside the time window and\n"
+           "                   for the inventory without opening the files\n"
+           " --checkpoint    Keep a checkpoint <inputfile>.ckp of each input file and\n"
+           "                   convert only blocks added since, appending to the output,\n"
+           "                   samples not filling a record are kept for the next run\n"
+           " --final         With --checkpoint, the input files are complete: pack all\n"
+           "                   samples and remove the checkpoints\n"
+           " --watch dir     Run as a daemon converting files completed in directory,\n"
+           "                   repeat for more directories, no input files are given\n"
+           " --settle secs   Seconds a file must not change to be complete, files\n"
+           "                   closed after writing are complete at once, default: 60\n"
+           " --journal file  Journal of processed files, default: .sdr2mseed.journal in\n"
+           "                   the first watched directory\n"
+           " --manifest file Record converted files with their size, modification time,\n"
+           "                   content hash, options and output in file and skip files\n"
+           "                   not changed since, files recorded with other options\n"
+           "                   are converted again\n"
+           " --stats         Print time, bytes, samples and records of each stage\n"
+           " --stats-json file\n"
+           "                 Write the statistics as JSON to file, '-' for stdout\n"
            "\n"
            " file(s)         File(s) of SDR input data\n"
            "                   If a file is prefixed with an '@' it is assumed to contain\n"
@@ -1285,6 +4813,7 @@ usage (void)
            "\n"
            "Supported Mini-SEED encoding formats:\n"
            " 3  : 32-bit integers\n"
+           " 4  : 32-bit floats, decimated in single precision\n"
            " 10 : Steim 1 compression of 32-bit integers\n"
            " 11 : Steim 2 compression of 32-bit integers\n"
            "\n");
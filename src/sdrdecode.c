@@ -0,0 +1,200 @@
+/***************************************************************************
+ * sdrdecode.c
+ *
+ * Decoding of (Win)SDR data blocks, shared by sdr2mseed and the
+ * benchmark programs.
+ *
+ * Modified: 2026.292
+ ***************************************************************************/
+
+#include <stdio.h>
+
+#include "sdrdecode.h"
+
+/***************************************************************************
+ * decompressSDR:
+ *
+ * Decompress SDR data block and place in supplied integer array.
+ *
+ * The InfoBlock buffer contains the entire data block starting with
+ * the InfoBlock, then the flag block and finally the compressed data.
+ * Each reading is either 8- or 16-bit.  The flagBlk array contains a
+ * flag for each data point telling whether it is 8- or 16-bit data.
+ *
+ * Details are reported to stderr when verbose is greater than 1.
+ *
+ * Routine from sdrmanip source code (windsdr.c) by Karl Cunningham.
+ * Originally (probably) by Larry Cochrane.
+ *
+ * Returns number of samples decompressed on success and -1 on error.
+ ***************************************************************************/
+int
+decompressSDR (HeaderBlock *hblock, InfoBlock *iblock, int blocknum,
+               int16_t *i16data, int verbose)
+{
+  int bitCount       = 0;
+  int samplesDecoded = 0;
+  int byteCnt;
+  int8_t *inPtr;
+  int16_t *outPtr;
+  int8_t *flagBlk;
+  int8_t tmpFlag;
+  double ratio;
+  int tooShort = 0;
+  int numShort = 0;
+  int numChar  = 0;
+
+  if (!hblock || !iblock || !i16data)
+    return -1;
+
+  /* Decompress one minute's worth of data. Compute the data block
+   * size in bytes, and stop when we get to the end of the valid data. */
+
+  byteCnt = iblock->blockSize - flagBlkSize (hblock->numSamples) - sizeof (InfoBlock);
+
+  if (verbose > 1)
+    fprintf (stderr, "  Decompressing block size: %d, flag block size: %d, bytes: %d\n",
+             iblock->blockSize, flagBlkSize (hblock->numSamples), byteCnt);
+
+  outPtr  = i16data;
+  flagBlk = (int8_t *)iblock + sizeof (InfoBlock);
+  tmpFlag = *flagBlk;
+  inPtr   = (int8_t *)flagBlk + flagBlkSize (hblock->numSamples);
+
+  while (byteCnt > 0)
+  {
+    if (tmpFlag & 1) // 16-bit integer
+    {
+      *outPtr++ = *((int16_t *)inPtr);
+
+      if ((verbose > 1) && (*(outPtr - 1)) && (*((outPtr - 1)) < 128) && (*((outPtr - 1)) > -127))
+      {
+        tooShort++;
+      }
+
+      inPtr += 2;
+      byteCnt -= 2;
+      numShort++;
+    }
+    else // 8-bit integer
+    {
+      *outPtr++ = *((int8_t *)inPtr);
+
+      inPtr++;
+      byteCnt--;
+      numChar++;
+    }
+
+    samplesDecoded++;
+
+    if (++bitCount >= 8)
+    { // next bit
+      bitCount = 0;
+      tmpFlag  = *(++flagBlk);
+    }
+    else
+    {
+      tmpFlag >>= 1;
+    }
+  }
+
+  if (byteCnt < 0)
+  {
+    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
+    fprintf (stderr, "  Flags did not match the number of data bytes when decompressing data in Block No %d\n",
+             blocknum);
+  }
+
+  if (verbose > 1)
+  {
+    ratio = (double)samplesDecoded * 2.0 / (iblock->blockSize - flagBlkSize (hblock->numSamples) - sizeof (InfoBlock));
+
+    fprintf (stderr, "  Decompressed %d samples (for %d channels)  Compression: %.2f:1  numShort: %d  numChar: %d Too Short: %d\n",
+             samplesDecoded, hblock->numChannels, ratio, numShort, numChar, tooShort);
+  }
+
+  if (samplesDecoded > (hblock->numChannels * hblock->sampleRate * BLOCK_LEN))
+  {
+    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
+    fprintf (stderr, "  More than one minute's samples for %d channels * %d sps rate * %d seconds per block\n",
+             hblock->numChannels, hblock->sampleRate, BLOCK_LEN);
+  }
+
+  return samplesDecoded;
+} /* End of decompressSDR() */
+
+/***************************************************************************
+ * normalizeSDR24:
+ *
+ * Convert 24-bit integer data to 32-bit integers.
+ *
+ * Details are reported to stderr when verbose is greater than 1.
+ *
+ * Routine referenced from drf2txt by Larry Cochrane.
+ *
+ * Returns number of samples decompressed on success and -1 on error.
+ ***************************************************************************/
+int
+normalizeSDR24 (HeaderBlock *hblock, InfoBlock *iblock, int blocknum,
+                int32_t *i32data, int verbose)
+{
+  int samplesDecoded = 0;
+  int byteCnt;
+  uint8_t *inPtr;
+  uint8_t *outPtr;
+
+  if (!hblock || !iblock || !i32data)
+    return -1;
+
+  /* Decompress one minute's worth of data. Compute the data block
+   * size in bytes, and stop when we get to the end of the valid data. */
+
+  byteCnt = iblock->blockSize - sizeof (InfoBlock);
+
+  if (verbose > 1)
+    fprintf (stderr, "  Decompressing block size: %d, bytes: %d\n",
+             iblock->blockSize, byteCnt);
+
+  inPtr  = (uint8_t *)iblock + sizeof (InfoBlock);
+  outPtr = (uint8_t *)i32data;
+
+  /* Unpack 24-bit values into an array of 32-bit integers */
+  while (byteCnt > 0)
+  {
+    /* Sign extension */
+    if (inPtr[0] & 0x80)
+      outPtr[3] = 0xFF;
+    else
+      outPtr[3] = 0x0;
+    outPtr[2]   = inPtr[0];
+    outPtr[1]   = inPtr[1];
+    outPtr[0]   = inPtr[2];
+
+    inPtr += 3;  /* Advance 24 bits */
+    outPtr += 4; /* Advance 32 bits */
+    byteCnt -= 3;
+    samplesDecoded++;
+  }
+
+  if (byteCnt < 0)
+  {
+    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
+    fprintf (stderr, "  Flags did not match the number of data bytes when decompressing data in Block No %d\n",
+             blocknum);
+  }
+
+  if (verbose > 1)
+  {
+    fprintf (stderr, "  Decompressed %d samples (for %d channels)\n",
+             samplesDecoded, hblock->numChannels);
+  }
+
+  if (samplesDecoded > (hblock->numChannels * hblock->sampleRate * BLOCK_LEN))
+  {
+    fprintf (stderr, "WARNING -- Possible Data Corruption.\n");
+    fprintf (stderr, "  More than one minute's samples for %d channels * %d sps rate * %d seconds per block\n",
+             hblock->numChannels, hblock->sampleRate, BLOCK_LEN);
+  }
+
+  return samplesDecoded;
+} /* End of normalizeSDR24() */
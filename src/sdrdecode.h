@@ -0,0 +1,21 @@
+/* Decoding of (Win)SDR data blocks */
+
+#ifndef SDRDECODE_H
+#define SDRDECODE_H 1
+
+#include "sdrformat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int decompressSDR (HeaderBlock *hblock, InfoBlock *iblock, int blocknum,
+                   int16_t *i16data, int verbose);
+int normalizeSDR24 (HeaderBlock *hblock, InfoBlock *iblock, int blocknum,
+                    int32_t *i32data, int verbose);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SDRDECODE_H */
@@ -0,0 +1,383 @@
+/*********************************************************************
+ * sdrindex.c
+ *
+ * Sidecar block index files of SDR files.
+ *
+ * An index holds, for each data block of an SDR file, its start time
+ * from the info block, file position and size, the number of samples
+ * per channel and the minimum and maximum sample of each channel, in
+ * time order.  It is written next to the SDR file, with the .idx
+ * suffix, after the file was converted completely and is read
+ * instead of the SDR file when only the times of the blocks are
+ * needed.
+ *
+ * The size and modification time of the SDR file are recorded in the
+ * index, an index no longer matching them is stale and not used.
+ * Index files are in the byte order of the host that wrote them and
+ * are not used on hosts with a different byte order or layout.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "sdrindex.h"
+
+/* Index file identification and byte order check */
+#define SDRINDEX_MAGIC     "SDRIDX1"
+#define SDRINDEX_BYTEORDER 0x01020304
+
+/* Maximum number of blocks accepted from an index file */
+#define SDRINDEX_MAXBLOCKS 65536
+
+/* Header of an index file, followed by the blocks */
+struct idxheader
+{
+  char magic[8];        /* SDRINDEX_MAGIC */
+  uint32_t byteorder;   /* SDRINDEX_BYTEORDER in host byte order */
+  int32_t blocksize;    /* Size of each block entry */
+  int32_t version;      /* SDR header version */
+  int32_t samprate;     /* Sample rate */
+  int32_t numchannels;  /* Number of channels */
+  int32_t nblocks;      /* Number of blocks */
+  int64_t filesize;     /* Size of the indexed SDR file */
+  int64_t mtime;        /* Modification time of the indexed SDR file */
+};
+
+static char *indexpath (const char *sdrfile, const char *suffix);
+static int filestat (const char *sdrfile, int64_t *size, int64_t *mtime);
+static int compareblocks (const void *a, const void *b);
+
+/*********************************************************************
+ * sdrindex_init:
+ *
+ * Create an empty index of nblocks blocks for an SDR file, recording
+ * the current size and modification time of the file.
+ *
+ * Returns a new SDRIndex on success and NULL on error.
+ *********************************************************************/
+SDRIndex *
+sdrindex_init (const char *sdrfile, int version, int samprate,
+               int numchannels, int nblocks)
+{
+  SDRIndex *index;
+
+  if (nblocks < 0 || nblocks > SDRINDEX_MAXBLOCKS)
+    return NULL;
+
+  if (!(index = (SDRIndex *)calloc (1, sizeof (SDRIndex))) ||
+      (nblocks > 0 &&
+       !(index->blocks = (SDRIndexBlock *)calloc (nblocks, sizeof (SDRIndexBlock)))))
+  {
+    fprintf (stderr, "sdrindex_init(): Cannot allocate memory\n");
+    free (index);
+    return NULL;
+  }
+
+  if (filestat (sdrfile, &index->filesize, &index->mtime))
+  {
+    free (index->blocks);
+    free (index);
+    return NULL;
+  }
+
+  index->version     = version;
+  index->samprate    = samprate;
+  index->numchannels = numchannels;
+  index->nblocks     = nblocks;
+
+  return index;
+} /* End of sdrindex_init() */
+
+/*********************************************************************
+ * sdrindex_read:
+ *
+ * Read the index of an SDR file.  The SDR file itself is not opened.
+ *
+ * Returns the SDRIndex on success and NULL if there is no index, it
+ * is stale or it cannot be read.
+ *********************************************************************/
+SDRIndex *
+sdrindex_read (const char *sdrfile)
+{
+  struct idxheader header;
+  SDRIndex *index = NULL;
+  int64_t filesize;
+  int64_t mtime;
+  char *path;
+  FILE *fp;
+
+  if (filestat (sdrfile, &filesize, &mtime))
+    return NULL;
+
+  if (!(path = indexpath (sdrfile, NULL)))
+    return NULL;
+
+  fp = fopen (path, "rb");
+  free (path);
+
+  if (!fp)
+    return NULL;
+
+  /* Check identification, layout and the state of the SDR file */
+  if (fread (&header, sizeof (header), 1, fp) != 1 ||
+      memcmp (header.magic, SDRINDEX_MAGIC, sizeof (header.magic)) ||
+      header.byteorder != SDRINDEX_BYTEORDER ||
+      header.blocksize != (int32_t)sizeof (SDRIndexBlock) ||
+      header.nblocks < 0 || header.nblocks > SDRINDEX_MAXBLOCKS ||
+      header.numchannels < 0 || header.numchannels > SDRINDEX_MAXCHANNELS ||
+      header.filesize != filesize || header.mtime != mtime)
+  {
+    fclose (fp);
+    return NULL;
+  }
+
+  if (!(index = (SDRIndex *)calloc (1, sizeof (SDRIndex))) ||
+      (header.nblocks > 0 &&
+       !(index->blocks = (SDRIndexBlock *)malloc (header.nblocks * sizeof (SDRIndexBlock)))))
+  {
+    fprintf (stderr, "sdrindex_read(): Cannot allocate memory\n");
+    fclose (fp);
+    free (index);
+    return NULL;
+  }
+
+  index->version     = header.version;
+  index->samprate    = header.samprate;
+  index->numchannels = header.numchannels;
+  index->filesize    = header.filesize;
+  index->mtime       = header.mtime;
+  index->nblocks     = header.nblocks;
+
+  if (header.nblocks > 0 &&
+      fread (index->blocks, sizeof (SDRIndexBlock), header.nblocks, fp) != (size_t)header.nblocks)
+  {
+    fclose (fp);
+    sdrindex_free (&index);
+    return NULL;
+  }
+
+  fclose (fp);
+
+  return index;
+} /* End of sdrindex_read() */
+
+/*********************************************************************
+ * sdrindex_write:
+ *
+ * Write the index of an SDR file.  Blocks without flags, unused info
+ * blocks of the header, are dropped and the others sorted by start
+ * time.  The index is written to a temporary file renamed to the
+ * index file, readers never see a partial index.
+ *
+ * Returns 0 on success, 1 if the SDR file changed since the index was
+ * created and nothing was written, and -1 on error with errno set.
+ *********************************************************************/
+int
+sdrindex_write (const char *sdrfile, SDRIndex *index)
+{
+  struct idxheader header;
+  int64_t filesize;
+  int64_t mtime;
+  char *path;
+  char *tmppath;
+  FILE *fp;
+  int count;
+  int idx;
+  int rv = -1;
+
+  if (!index)
+    return -1;
+
+  if (filestat (sdrfile, &filesize, &mtime))
+    return -1;
+
+  /* The blocks may not match a file written to meanwhile */
+  if (filesize != index->filesize || mtime != index->mtime)
+    return 1;
+
+  /* Drop unused blocks and sort by time */
+  for (idx = 0, count = 0; idx < index->nblocks; idx++)
+  {
+    if (index->blocks[idx].flags)
+      index->blocks[count++] = index->blocks[idx];
+  }
+
+  index->nblocks = count;
+
+  if (count > 1)
+    qsort (index->blocks, count, sizeof (SDRIndexBlock), compareblocks);
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, SDRINDEX_MAGIC, sizeof (header.magic));
+  header.byteorder   = SDRINDEX_BYTEORDER;
+  header.blocksize   = sizeof (SDRIndexBlock);
+  header.version     = index->version;
+  header.samprate    = index->samprate;
+  header.numchannels = index->numchannels;
+  header.nblocks     = index->nblocks;
+  header.filesize    = index->filesize;
+  header.mtime       = index->mtime;
+
+  path    = indexpath (sdrfile, NULL);
+  tmppath = indexpath (sdrfile, ".tmp");
+
+  if (path && tmppath && (fp = fopen (tmppath, "wb")))
+  {
+    if (fwrite (&header, sizeof (header), 1, fp) == 1 &&
+        (index->nblocks == 0 ||
+         fwrite (index->blocks, sizeof (SDRIndexBlock), index->nblocks, fp) == (size_t)index->nblocks))
+      rv = 0;
+
+    if (fclose (fp))
+      rv = -1;
+
+#if defined(WIN32) || defined(_WIN32)
+    /* rename() does not replace an existing file */
+    if (rv == 0)
+      remove (path);
+#endif
+
+    if (rv == 0 && rename (tmppath, path))
+      rv = -1;
+
+    if (rv)
+      remove (tmppath);
+  }
+
+  free (path);
+  free (tmppath);
+
+  return rv;
+} /* End of sdrindex_write() */
+
+/*********************************************************************
+ * sdrindex_find:
+ *
+ * Find the first block of an index with samples at or after a time,
+ * assuming the blocks do not overlap.
+ *
+ * Returns the block index, or the number of blocks if no block ends
+ * after the time.
+ *********************************************************************/
+int
+sdrindex_find (SDRIndex *index, int64_t time)
+{
+  SDRIndexBlock *block;
+  int64_t endtime;
+  int low  = 0;
+  int high = index->nblocks;
+  int mid;
+
+  /* Find the last block starting at or before the time */
+  while (low < high)
+  {
+    mid = low + (high - low) / 2;
+
+    if (index->blocks[mid].starttime <= time)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if (low > 0)
+    low--;
+
+  /* Skip blocks ending at or before the time */
+  for (; low < index->nblocks; low++)
+  {
+    block   = &index->blocks[low];
+    endtime = block->starttime;
+
+    if (index->samprate > 0)
+      endtime += (int64_t)block->nsamples * 1000000 / index->samprate;
+
+    if (endtime > time)
+      break;
+  }
+
+  return low;
+} /* End of sdrindex_find() */
+
+/*********************************************************************
+ * sdrindex_free:
+ *
+ * Free an index.
+ *********************************************************************/
+void
+sdrindex_free (SDRIndex **pindex)
+{
+  if (!pindex || !*pindex)
+    return;
+
+  free ((*pindex)->blocks);
+  free (*pindex);
+  *pindex = NULL;
+} /* End of sdrindex_free() */
+
+/*********************************************************************
+ * indexpath:
+ *
+ * Returns a newly allocated index file path of an SDR file with an
+ * optional further suffix, or NULL on error.
+ *********************************************************************/
+static char *
+indexpath (const char *sdrfile, const char *suffix)
+{
+  size_t length;
+  char *path;
+
+  length = strlen (sdrfile) + strlen (SDRINDEX_SUFFIX) + ((suffix) ? strlen (suffix) : 0) + 1;
+
+  if (!(path = (char *)malloc (length)))
+    return NULL;
+
+  snprintf (path, length, "%s%s%s", sdrfile, SDRINDEX_SUFFIX, (suffix) ? suffix : "");
+
+  return path;
+} /* End of indexpath() */
+
+/*********************************************************************
+ * filestat:
+ *
+ * Determine the size and modification time of a file.
+ *
+ * Returns 0 on success and -1 on error with errno set.
+ *********************************************************************/
+static int
+filestat (const char *sdrfile, int64_t *size, int64_t *mtime)
+{
+  struct stat st;
+
+  if (stat (sdrfile, &st))
+    return -1;
+
+  *size  = (int64_t)st.st_size;
+  *mtime = (int64_t)st.st_mtime;
+
+  return 0;
+} /* End of filestat() */
+
+/*********************************************************************
+ * compareblocks:
+ *
+ * Order blocks by start time and file position for qsort().
+ *********************************************************************/
+static int
+compareblocks (const void *a, const void *b)
+{
+  const SDRIndexBlock *ba = (const SDRIndexBlock *)a;
+  const SDRIndexBlock *bb = (const SDRIndexBlock *)b;
+
+  if (ba->starttime != bb->starttime)
+    return (ba->starttime < bb->starttime) ? -1 : 1;
+
+  if (ba->offset != bb->offset)
+    return (ba->offset < bb->offset) ? -1 : 1;
+
+  return 0;
+} /* End of compareblocks() */
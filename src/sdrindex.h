@@ -0,0 +1,57 @@
+/* Sidecar block index files of SDR files */
+
+#ifndef SDRINDEX_H
+#define SDRINDEX_H 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Index file name suffix added to the SDR file name */
+#define SDRINDEX_SUFFIX ".idx"
+
+/* Maximum number of channels, as MAX_CHANNELS of sdrformat.h */
+#define SDRINDEX_MAXCHANNELS 8
+
+/* Block flags */
+#define SDRINDEX_DECODED 0x01 /* Block was read and decoded */
+#define SDRINDEX_VALID   0x02 /* Block has a valid info block and samples */
+
+/* Index entry of a data block */
+typedef struct SDRIndexBlock_s
+{
+  int64_t starttime;                 /* Start time, microseconds since the epoch */
+  uint32_t offset;                   /* Data block file position */
+  uint32_t size;                     /* Data block size in bytes */
+  int32_t nsamples;                  /* Samples per channel */
+  int32_t flags;                     /* Block flags, SDRINDEX_* */
+  int32_t min[SDRINDEX_MAXCHANNELS]; /* Minimum sample of each channel */
+  int32_t max[SDRINDEX_MAXCHANNELS]; /* Maximum sample of each channel */
+} SDRIndexBlock;
+
+/* Index of an SDR file, the data blocks in time order */
+typedef struct SDRIndex_s
+{
+  int version;           /* SDR header version */
+  int samprate;          /* Sample rate */
+  int numchannels;       /* Number of channels */
+  int64_t filesize;      /* Size of the indexed SDR file */
+  int64_t mtime;         /* Modification time of the indexed SDR file */
+  int nblocks;           /* Number of data blocks */
+  SDRIndexBlock *blocks; /* Data blocks */
+} SDRIndex;
+
+SDRIndex *sdrindex_init (const char *sdrfile, int version, int samprate,
+                         int numchannels, int nblocks);
+SDRIndex *sdrindex_read (const char *sdrfile);
+int sdrindex_write (const char *sdrfile, SDRIndex *index);
+int sdrindex_find (SDRIndex *index, int64_t time);
+void sdrindex_free (SDRIndex **pindex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SDRINDEX_H */
@@ -0,0 +1,423 @@
+/*********************************************************************
+ * stats.c
+ *
+ * Per-stage timing and counters of the conversion.
+ *
+ * Each thread accumulates wall time from a monotonic clock, CPU time
+ * of the thread, bytes, samples and records for each stage in its own
+ * counters, so no locking is needed.  Nested stages are timed
+ * exclusively: the time of an inner stage is not included in the
+ * stage it is nested in, e.g. writing records during packing.
+ *
+ * Collection is disabled until stats_init() is called, the
+ * STATS_START() and STATS_STOP() macros then cost a single test.
+ *
+ * Queues between stages report their occupancy with stats_queue().
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#define STATS_WIN32 1
+#include <windows.h>
+#endif
+
+#include "stats.h"
+
+/* Counters of a stage */
+struct statcounter
+{
+  double wall;     /* Wall time in seconds */
+  double cpu;      /* CPU time in seconds */
+  int64_t bytes;   /* Bytes handled */
+  int64_t samples; /* Samples handled */
+  int64_t records; /* Records handled */
+  int64_t calls;   /* Number of timed intervals */
+};
+
+/* Counters of a thread, padded to keep threads on separate cache lines */
+struct threadstats
+{
+  struct statcounter stage[STAT_COUNT];
+  double nestedwall; /* Wall time of all stopped intervals */
+  double nestedcpu;  /* CPU time of all stopped intervals */
+  char pad[64];
+};
+
+/* Counters of a queue between stages */
+struct queuestats
+{
+  const char *name;     /* Queue name */
+  int depth;            /* Maximum items in the queue */
+  int64_t items;        /* Items passed */
+  double meanoccupancy; /* Mean occupancy after each push */
+  int maxoccupancy;     /* Maximum occupancy */
+  int64_t fullwaits;    /* Pushes that waited for space */
+  int64_t emptywaits;   /* Pops that waited for an item */
+};
+
+int stats_enabled = 0;
+
+static struct threadstats threadstats[STATS_MAXTHREADS];
+static struct queuestats queuestats[STATS_MAXQUEUES];
+static int numqueues;
+static double startwall;
+static double startcpu;
+
+static const char *stagenames[STAT_COUNT] = {
+    "read", "decode", "demux", "decimate", "pack", "write"};
+
+static double wallclock (void);
+static double threadcpu (void);
+static double processcpu (void);
+static void sumstage (int stage, struct statcounter *sum, int *nthreads);
+
+/*********************************************************************
+ * stats_init:
+ *
+ * Reset all counters and enable collection.
+ *********************************************************************/
+void
+stats_init (void)
+{
+  memset (threadstats, 0, sizeof (threadstats));
+  numqueues = 0;
+
+  startwall     = wallclock ();
+  startcpu      = processcpu ();
+  stats_enabled = 1;
+} /* End of stats_init() */
+
+/*********************************************************************
+ * stats_start:
+ *
+ * Start timing an interval in a thread.
+ *********************************************************************/
+void
+stats_start (StatsTimer *timer, int thread)
+{
+  struct threadstats *ts;
+
+  if (thread < 0 || thread >= STATS_MAXTHREADS)
+    thread = STATS_MAXTHREADS - 1;
+
+  ts = &threadstats[thread];
+
+  timer->nestedwall = ts->nestedwall;
+  timer->nestedcpu  = ts->nestedcpu;
+  timer->wall       = wallclock ();
+  timer->cpu        = threadcpu ();
+} /* End of stats_start() */
+
+/*********************************************************************
+ * stats_stop:
+ *
+ * Stop timing an interval and add it to the counters of a stage for
+ * the thread, excluding the time of intervals nested within it.
+ *********************************************************************/
+void
+stats_stop (StatsTimer *timer, int thread, int stage,
+            int64_t bytes, int64_t samples, int64_t records)
+{
+  struct threadstats *ts;
+  struct statcounter *sc;
+  double wall;
+  double cpu;
+
+  wall = wallclock () - timer->wall;
+  cpu  = threadcpu () - timer->cpu;
+
+  if (thread < 0 || thread >= STATS_MAXTHREADS)
+    thread = STATS_MAXTHREADS - 1;
+
+  if (stage < 0 || stage >= STAT_COUNT)
+    return;
+
+  ts = &threadstats[thread];
+  sc = &ts->stage[stage];
+
+  sc->wall += wall - (ts->nestedwall - timer->nestedwall);
+  sc->cpu += cpu - (ts->nestedcpu - timer->nestedcpu);
+  sc->bytes += bytes;
+  sc->samples += samples;
+  sc->records += records;
+  sc->calls++;
+
+  /* The whole interval is nested time for an enclosing interval */
+  ts->nestedwall = timer->nestedwall + wall;
+  ts->nestedcpu  = timer->nestedcpu + cpu;
+} /* End of stats_stop() */
+
+/*********************************************************************
+ * stats_queue:
+ *
+ * Add the counters of a queue between stages to the statistics.
+ *********************************************************************/
+void
+stats_queue (const char *name, int depth, int64_t items, double meanoccupancy,
+             int maxoccupancy, int64_t fullwaits, int64_t emptywaits)
+{
+  struct queuestats *qs;
+
+  if (numqueues >= STATS_MAXQUEUES)
+    return;
+
+  qs = &queuestats[numqueues++];
+
+  qs->name          = name;
+  qs->depth         = depth;
+  qs->items         = items;
+  qs->meanoccupancy = meanoccupancy;
+  qs->maxoccupancy  = maxoccupancy;
+  qs->fullwaits     = fullwaits;
+  qs->emptywaits    = emptywaits;
+} /* End of stats_queue() */
+
+/*********************************************************************
+ * stats_print:
+ *
+ * Print the counters of each stage summed over all threads, followed
+ * by the total wall and process CPU time since stats_init().  Stage
+ * times of several threads are summed, they can exceed the total.
+ * The occupancy of any queues between stages follows.
+ *********************************************************************/
+void
+stats_print (FILE *fp)
+{
+  struct statcounter sum;
+  struct queuestats *qs;
+  int nthreads;
+  int stage;
+  int idx;
+
+  fprintf (fp, "%-9s %10s %10s %13s %12s %9s %9s %7s\n",
+           "Stage", "Wall (s)", "CPU (s)", "Bytes", "Samples", "Records", "MB/s", "Threads");
+
+  for (stage = 0; stage < STAT_COUNT; stage++)
+  {
+    sumstage (stage, &sum, &nthreads);
+
+    fprintf (fp, "%-9s %10.4f %10.4f %13lld %12lld %9lld %9.1f %7d\n",
+             stagenames[stage], sum.wall, sum.cpu, (long long int)sum.bytes,
+             (long long int)sum.samples, (long long int)sum.records,
+             (sum.wall > 0.0) ? sum.bytes / sum.wall / 1e6 : 0.0, nthreads);
+  }
+
+  fprintf (fp, "%-9s %10.4f %10.4f\n", "total",
+           wallclock () - startwall, processcpu () - startcpu);
+
+  if (numqueues == 0)
+    return;
+
+  fprintf (fp, "%-9s %10s %10s %13s %12s %9s %9s\n",
+           "Queue", "Depth", "Items", "Mean occ", "Max occ", "Full", "Empty");
+
+  for (idx = 0; idx < numqueues; idx++)
+  {
+    qs = &queuestats[idx];
+
+    fprintf (fp, "%-9s %10d %10lld %13.2f %12d %9lld %9lld\n",
+             qs->name, qs->depth, (long long int)qs->items, qs->meanoccupancy,
+             qs->maxoccupancy, (long long int)qs->fullwaits, (long long int)qs->emptywaits);
+  }
+} /* End of stats_print() */
+
+/*********************************************************************
+ * stats_writejson:
+ *
+ * Write the counters of each stage, with the counters of each thread
+ * that took part, the totals and the queue occupancy as a JSON object
+ * to a file, or to stdout if the path is "-".
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+stats_writejson (const char *path)
+{
+  struct statcounter sum;
+  struct statcounter *sc;
+  struct queuestats *qs;
+  FILE *fp;
+  int nthreads;
+  int thread;
+  int stage;
+  int count;
+
+  if (strcmp (path, "-") == 0)
+    fp = stdout;
+  else if (!(fp = fopen (path, "w")))
+  {
+    fprintf (stderr, "Cannot open statistics file: %s\n", path);
+    return -1;
+  }
+
+  fprintf (fp, "{\n  \"wall\": %.6f,\n  \"cpu\": %.6f,\n  \"stages\": {\n",
+           wallclock () - startwall, processcpu () - startcpu);
+
+  for (stage = 0; stage < STAT_COUNT; stage++)
+  {
+    sumstage (stage, &sum, &nthreads);
+
+    fprintf (fp, "    \"%s\": {\"wall\": %.6f, \"cpu\": %.6f, \"bytes\": %lld, "
+                 "\"samples\": %lld, \"records\": %lld, \"calls\": %lld, \"threads\": [",
+             stagenames[stage], sum.wall, sum.cpu, (long long int)sum.bytes,
+             (long long int)sum.samples, (long long int)sum.records,
+             (long long int)sum.calls);
+
+    for (thread = 0, count = 0; thread < STATS_MAXTHREADS; thread++)
+    {
+      sc = &threadstats[thread].stage[stage];
+
+      if (sc->calls == 0)
+        continue;
+
+      fprintf (fp, "%s\n      {\"thread\": %d, \"wall\": %.6f, \"cpu\": %.6f, \"bytes\": %lld, "
+                   "\"samples\": %lld, \"records\": %lld, \"calls\": %lld}",
+               (count++) ? "," : "", thread, sc->wall, sc->cpu, (long long int)sc->bytes,
+               (long long int)sc->samples, (long long int)sc->records, (long long int)sc->calls);
+    }
+
+    fprintf (fp, "%s]}%s\n", (count) ? "\n    " : "", (stage < STAT_COUNT - 1) ? "," : "");
+  }
+
+  fprintf (fp, "  },\n  \"queues\": [");
+
+  for (count = 0; count < numqueues; count++)
+  {
+    qs = &queuestats[count];
+
+    fprintf (fp, "%s\n    {\"name\": \"%s\", \"depth\": %d, \"items\": %lld, "
+                 "\"meanoccupancy\": %.3f, \"maxoccupancy\": %d, "
+                 "\"fullwaits\": %lld, \"emptywaits\": %lld}",
+             (count) ? "," : "", qs->name, qs->depth, (long long int)qs->items,
+             qs->meanoccupancy, qs->maxoccupancy, (long long int)qs->fullwaits,
+             (long long int)qs->emptywaits);
+  }
+
+  fprintf (fp, "%s]\n}\n", (numqueues) ? "\n  " : "");
+
+  if (fp != stdout)
+    fclose (fp);
+
+  return 0;
+} /* End of stats_writejson() */
+
+/*********************************************************************
+ * sumstage:
+ *
+ * Sum the counters of a stage over all threads and count the threads
+ * that took part.
+ *********************************************************************/
+static void
+sumstage (int stage, struct statcounter *sum, int *nthreads)
+{
+  struct statcounter *sc;
+  int thread;
+
+  memset (sum, 0, sizeof (struct statcounter));
+  *nthreads = 0;
+
+  for (thread = 0; thread < STATS_MAXTHREADS; thread++)
+  {
+    sc = &threadstats[thread].stage[stage];
+
+    if (sc->calls == 0)
+      continue;
+
+    sum->wall += sc->wall;
+    sum->cpu += sc->cpu;
+    sum->bytes += sc->bytes;
+    sum->samples += sc->samples;
+    sum->records += sc->records;
+    sum->calls += sc->calls;
+    (*nthreads)++;
+  }
+} /* End of sumstage() */
+
+#if defined(STATS_WIN32)
+/*********************************************************************
+ * filetimesec:
+ *
+ * Returns the FILETIME duration in seconds.
+ *********************************************************************/
+static double
+filetimesec (FILETIME *ft)
+{
+  return ((((uint64_t)ft->dwHighDateTime) << 32) | ft->dwLowDateTime) * 1e-7;
+} /* End of filetimesec() */
+#endif
+
+/*********************************************************************
+ * wallclock:
+ *
+ * Returns the monotonic clock time in seconds.
+ *********************************************************************/
+static double
+wallclock (void)
+{
+#if defined(STATS_WIN32)
+  LARGE_INTEGER count;
+  LARGE_INTEGER freq;
+
+  QueryPerformanceCounter (&count);
+  QueryPerformanceFrequency (&freq);
+
+  return (double)count.QuadPart / freq.QuadPart;
+#else
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+} /* End of wallclock() */
+
+/*********************************************************************
+ * threadcpu:
+ *
+ * Returns the CPU time of the calling thread in seconds.
+ *********************************************************************/
+static double
+threadcpu (void)
+{
+#if defined(STATS_WIN32)
+  FILETIME create, exit, kernel, user;
+
+  if (!GetThreadTimes (GetCurrentThread (), &create, &exit, &kernel, &user))
+    return 0.0;
+
+  return filetimesec (&kernel) + filetimesec (&user);
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+
+  clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+  return (double)clock () / CLOCKS_PER_SEC;
+#endif
+} /* End of threadcpu() */
+
+/*********************************************************************
+ * processcpu:
+ *
+ * Returns the CPU time of the process, all threads, in seconds.
+ *********************************************************************/
+static double
+processcpu (void)
+{
+#if defined(STATS_WIN32)
+  FILETIME create, exit, kernel, user;
+
+  if (!GetProcessTimes (GetCurrentProcess (), &create, &exit, &kernel, &user))
+    return 0.0;
+
+  return filetimesec (&kernel) + filetimesec (&user);
+#else
+  return (double)clock () / CLOCKS_PER_SEC;
+#endif
+} /* End of processcpu() */
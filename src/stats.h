@@ -0,0 +1,60 @@
+/* Per-stage timing and counters of the conversion */
+
+#ifndef STATS_H
+#define STATS_H 1
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Conversion stages */
+#define STAT_READ     0
+#define STAT_DECODE   1
+#define STAT_DEMUX    2
+#define STAT_DECIMATE 3
+#define STAT_PACK     4
+#define STAT_WRITE    5
+#define STAT_COUNT    6
+
+/* Maximum number of threads with separate counters */
+#define STATS_MAXTHREADS 64
+
+/* Maximum number of queues reported */
+#define STATS_MAXQUEUES 8
+
+/* Start times of a timed interval */
+typedef struct StatsTimer_s
+{
+  double wall;       /* Monotonic clock time at start */
+  double cpu;        /* Thread CPU time at start */
+  double nestedwall; /* Nested wall time of the thread at start */
+  double nestedcpu;  /* Nested CPU time of the thread at start */
+} StatsTimer;
+
+/* Non-zero when statistics are collected */
+extern int stats_enabled;
+
+/* Time a stage only when enabled, costing a single test otherwise */
+#define STATS_START(TIMER, THREAD) \
+  do { if (stats_enabled) stats_start ((TIMER), (THREAD)); } while (0)
+
+#define STATS_STOP(TIMER, THREAD, STAGE, BYTES, SAMPLES, RECORDS) \
+  do { if (stats_enabled) stats_stop ((TIMER), (THREAD), (STAGE), (BYTES), (SAMPLES), (RECORDS)); } while (0)
+
+void stats_init (void);
+void stats_start (StatsTimer *timer, int thread);
+void stats_stop (StatsTimer *timer, int thread, int stage,
+                 int64_t bytes, int64_t samples, int64_t records);
+void stats_queue (const char *name, int depth, int64_t items, double meanoccupancy,
+                  int maxoccupancy, int64_t fullwaits, int64_t emptywaits);
+void stats_print (FILE *fp);
+int stats_writejson (const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATS_H */
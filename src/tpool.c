@@ -0,0 +1,303 @@
+/*********************************************************************
+ * tpool.c
+ *
+ * A fixed-size thread pool for running batches of independent jobs.
+ *
+ * The calling thread takes part in each batch as thread 0 and
+ * tpool_run() returns when all jobs in the batch are complete.  Jobs
+ * are handed out in order, each job is run exactly once.
+ *
+ * On platforms without POSIX threads jobs are run serially by the
+ * calling thread.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#define TPOOL_PTHREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "tpool.h"
+
+struct TPool_s
+{
+  int nthreads;           /* Number of threads including the caller */
+#ifdef TPOOL_PTHREADS
+  pthread_t *threads;     /* Worker threads, nthreads - 1 */
+  pthread_mutex_t lock;   /* Protects all fields below */
+  pthread_cond_t start;   /* Signaled when a batch is started */
+  pthread_cond_t done;    /* Signaled when the workers finish a batch */
+#endif
+  tpool_func func;        /* Job function of the current batch */
+  void **args;            /* Job arguments of the current batch */
+  int count;              /* Number of jobs in the current batch */
+  int next;               /* Index of the next job to run */
+  int active;             /* Workers not finished with the current batch */
+  unsigned long batch;    /* Batch sequence number */
+  int shutdown;           /* Flag for workers to exit */
+};
+
+#ifdef TPOOL_PTHREADS
+struct worker
+{
+  TPool *pool;
+  int thread;
+};
+
+/*********************************************************************
+ * tpool_jobs:
+ *
+ * Run jobs of the current batch until none remain.  The pool lock
+ * must be held by the caller, it is released while jobs run.
+ *********************************************************************/
+static void
+tpool_jobs (TPool *pool, int thread)
+{
+  int idx;
+
+  while (pool->next < pool->count)
+  {
+    idx = pool->next++;
+
+    pthread_mutex_unlock (&pool->lock);
+    pool->func (pool->args[idx], thread);
+    pthread_mutex_lock (&pool->lock);
+  }
+} /* End of tpool_jobs() */
+
+/*********************************************************************
+ * tpool_worker:
+ *
+ * Worker thread loop, run jobs for each batch until shut down.
+ *********************************************************************/
+static void *
+tpool_worker (void *arg)
+{
+  struct worker *worker = (struct worker *)arg;
+  TPool *pool = worker->pool;
+  unsigned long seen = 0;
+
+  pthread_mutex_lock (&pool->lock);
+
+  for (;;)
+  {
+    while (!pool->shutdown && pool->batch == seen)
+      pthread_cond_wait (&pool->start, &pool->lock);
+
+    if (pool->shutdown)
+      break;
+
+    seen = pool->batch;
+
+    tpool_jobs (pool, worker->thread);
+
+    if (--pool->active == 0)
+      pthread_cond_signal (&pool->done);
+  }
+
+  pthread_mutex_unlock (&pool->lock);
+
+  free (worker);
+
+  return NULL;
+} /* End of tpool_worker() */
+#endif
+
+/*********************************************************************
+ * tpool_init:
+ *
+ * Create a thread pool with nthreads threads, including the calling
+ * thread.  If nthreads is less than 1 the number of online CPUs is
+ * used.
+ *
+ * Returns a new TPool on success and NULL on error.
+ *********************************************************************/
+TPool *
+tpool_init (int nthreads)
+{
+  TPool *pool;
+#ifdef TPOOL_PTHREADS
+  struct worker *worker;
+  int idx;
+#endif
+
+  if (nthreads < 1)
+    nthreads = tpool_cpucount ();
+
+  if (!(pool = (TPool *)calloc (1, sizeof (TPool))))
+  {
+    fprintf (stderr, "tpool_init(): Cannot allocate memory\n");
+    return NULL;
+  }
+
+#ifdef TPOOL_PTHREADS
+  pool->nthreads = 1;
+
+  if (nthreads > 1)
+  {
+    if (!(pool->threads = (pthread_t *)calloc (nthreads - 1, sizeof (pthread_t))))
+    {
+      fprintf (stderr, "tpool_init(): Cannot allocate memory\n");
+      free (pool);
+      return NULL;
+    }
+  }
+
+  pthread_mutex_init (&pool->lock, NULL);
+  pthread_cond_init (&pool->start, NULL);
+  pthread_cond_init (&pool->done, NULL);
+
+  for (idx = 1; idx < nthreads; idx++)
+  {
+    if (!(worker = (struct worker *)malloc (sizeof (struct worker))))
+    {
+      fprintf (stderr, "tpool_init(): Cannot allocate memory\n");
+      tpool_free (&pool);
+      return NULL;
+    }
+
+    worker->pool   = pool;
+    worker->thread = idx;
+
+    if (pthread_create (&pool->threads[idx - 1], NULL, tpool_worker, worker))
+    {
+      fprintf (stderr, "tpool_init(): Cannot create thread %d\n", idx);
+      free (worker);
+      tpool_free (&pool);
+      return NULL;
+    }
+
+    pool->nthreads++;
+  }
+#else
+  pool->nthreads = 1;
+#endif
+
+  return pool;
+} /* End of tpool_init() */
+
+/*********************************************************************
+ * tpool_threads:
+ *
+ * Returns the number of threads in a pool, including the caller.
+ *********************************************************************/
+int
+tpool_threads (TPool *pool)
+{
+  return (pool) ? pool->nthreads : 1;
+} /* End of tpool_threads() */
+
+/*********************************************************************
+ * tpool_run:
+ *
+ * Run func for each of count args on the pool threads and wait for
+ * all of them to complete.  A NULL pool runs the jobs serially.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+tpool_run (TPool *pool, tpool_func func, void **args, int count)
+{
+  int idx;
+
+  if (!func || (!args && count > 0) || count < 0)
+    return -1;
+
+  if (!pool || pool->nthreads <= 1 || count <= 1)
+  {
+    for (idx = 0; idx < count; idx++)
+      func (args[idx], 0);
+
+    return 0;
+  }
+
+#ifdef TPOOL_PTHREADS
+  pthread_mutex_lock (&pool->lock);
+
+  pool->func   = func;
+  pool->args   = args;
+  pool->count  = count;
+  pool->next   = 0;
+  pool->active = pool->nthreads - 1;
+  pool->batch++;
+
+  pthread_cond_broadcast (&pool->start);
+
+  /* The caller runs jobs as thread 0 */
+  tpool_jobs (pool, 0);
+
+  while (pool->active > 0)
+    pthread_cond_wait (&pool->done, &pool->lock);
+
+  pool->func  = NULL;
+  pool->args  = NULL;
+  pool->count = 0;
+
+  pthread_mutex_unlock (&pool->lock);
+#endif
+
+  return 0;
+} /* End of tpool_run() */
+
+/*********************************************************************
+ * tpool_free:
+ *
+ * Stop the threads of a pool and free all associated memory.
+ *********************************************************************/
+void
+tpool_free (TPool **ppool)
+{
+  TPool *pool;
+#ifdef TPOOL_PTHREADS
+  int idx;
+#endif
+
+  if (!ppool || !*ppool)
+    return;
+
+  pool = *ppool;
+
+#ifdef TPOOL_PTHREADS
+  pthread_mutex_lock (&pool->lock);
+  pool->shutdown = 1;
+  pthread_cond_broadcast (&pool->start);
+  pthread_mutex_unlock (&pool->lock);
+
+  for (idx = 0; idx < pool->nthreads - 1; idx++)
+    pthread_join (pool->threads[idx], NULL);
+
+  pthread_mutex_destroy (&pool->lock);
+  pthread_cond_destroy (&pool->start);
+  pthread_cond_destroy (&pool->done);
+
+  if (pool->threads)
+    free (pool->threads);
+#endif
+
+  free (pool);
+  *ppool = NULL;
+} /* End of tpool_free() */
+
+/*********************************************************************
+ * tpool_cpucount:
+ *
+ * Returns the number of online CPUs, 1 if unknown.
+ *********************************************************************/
+int
+tpool_cpucount (void)
+{
+#if defined(TPOOL_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+  long count = sysconf (_SC_NPROCESSORS_ONLN);
+
+  if (count > 0)
+    return (int)count;
+#endif
+
+  return 1;
+} /* End of tpool_cpucount() */
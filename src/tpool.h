@@ -0,0 +1,25 @@
+/* Fixed-size thread pool running batches of independent jobs */
+
+#ifndef TPOOL_H
+#define TPOOL_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Job function, thread is the pool thread number (0 is the caller) */
+typedef void (*tpool_func) (void *arg, int thread);
+
+typedef struct TPool_s TPool;
+
+TPool *tpool_init (int nthreads);
+int tpool_threads (TPool *pool);
+int tpool_run (TPool *pool, tpool_func func, void **args, int count);
+void tpool_free (TPool **ppool);
+int tpool_cpucount (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TPOOL_H */
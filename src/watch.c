@@ -0,0 +1,480 @@
+/*********************************************************************
+ * watch.c
+ *
+ * Watching directories for complete files.
+ *
+ * Files in the watched directories, existing when a directory is
+ * added and created or written later, are candidates until they are
+ * complete: closed after writing or moved into the directory, or not
+ * grown nor modified for a settle time.  Complete files are returned
+ * one at a time in the order they completed.
+ *
+ * On Linux changes are reported by inotify, elsewhere the directories
+ * are scanned every WATCH_POLLINTERVAL seconds.  Subdirectories are
+ * not watched.  Watching is not supported on Windows.
+ *
+ * Modified: 2026.292
+ *********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#define WATCH_WIN32 1
+#else
+#include <dirent.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#define WATCH_INOTIFY 1
+#include <sys/inotify.h>
+#endif
+#endif
+
+#include "watch.h"
+
+#ifndef WATCH_WIN32
+/* Watched directory */
+struct watchdir
+{
+  char *path; /* Directory path */
+  int wd;     /* inotify watch descriptor or -1 */
+};
+
+/* File that is not yet complete */
+struct candidate
+{
+  char *path;     /* File path */
+  int64_t size;   /* Size at the last check */
+  int64_t mtime;  /* Modification time at the last check */
+  time_t changed; /* Time of the last change seen */
+  int closed;     /* Closed after writing or moved in since the change */
+};
+
+struct Watcher_s
+{
+  int settle;               /* Seconds without change until complete */
+  watch_filter filter;      /* File name filter */
+  int fd;                   /* inotify descriptor or -1 when polling */
+  struct watchdir *dirs;    /* Watched directories */
+  int ndirs;                /* Number of watched directories */
+  struct candidate *cands;  /* Files not yet complete */
+  int ncands;               /* Number of candidates */
+  int maxcands;             /* Allocated candidates */
+  time_t lastscan;          /* Time of the last scan when polling */
+};
+
+static int scandir_files (Watcher *watcher, const char *dir);
+static int addcandidate (Watcher *watcher, const char *dir, const char *name,
+                         int closed, int existing);
+static void dropcandidate (Watcher *watcher, int idx);
+#endif
+
+/*********************************************************************
+ * watcher_init:
+ *
+ * Create a watcher reporting files as complete when closed after
+ * writing or not changed for settle seconds.  Only file names
+ * accepted by the filter, if given, are watched.
+ *
+ * Returns a new Watcher on success and NULL on error.
+ *********************************************************************/
+Watcher *
+watcher_init (int settle, watch_filter filter)
+{
+#ifndef WATCH_WIN32
+  Watcher *watcher;
+
+  if (!(watcher = (Watcher *)calloc (1, sizeof (Watcher))))
+  {
+    fprintf (stderr, "watcher_init(): Cannot allocate memory\n");
+    return NULL;
+  }
+
+  watcher->settle = (settle > 0) ? settle : 0;
+  watcher->filter = filter;
+  watcher->fd     = -1;
+
+#if defined(WATCH_INOTIFY)
+  /* Poll the directories if inotify is not available */
+  watcher->fd = inotify_init ();
+#endif
+
+  return watcher;
+#else
+  fprintf (stderr, "Watching directories is not supported on this platform\n");
+  return NULL;
+#endif
+} /* End of watcher_init() */
+
+/*********************************************************************
+ * watcher_method:
+ *
+ * Returns the name of the change detection method of a watcher.
+ *********************************************************************/
+const char *
+watcher_method (Watcher *watcher)
+{
+#ifndef WATCH_WIN32
+  if (watcher && watcher->fd >= 0)
+    return "inotify";
+#endif
+
+  return "polling";
+} /* End of watcher_method() */
+
+/*********************************************************************
+ * watcher_add:
+ *
+ * Watch a directory, the files already in it are candidates as if
+ * changed at their modification time.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+int
+watcher_add (Watcher *watcher, const char *dir)
+{
+#ifndef WATCH_WIN32
+  struct watchdir *dirs;
+
+  if (!(dirs = (struct watchdir *)realloc (watcher->dirs, (watcher->ndirs + 1) * sizeof (struct watchdir))))
+  {
+    fprintf (stderr, "watcher_add(): Cannot allocate memory\n");
+    return -1;
+  }
+
+  watcher->dirs = dirs;
+  dirs          = &watcher->dirs[watcher->ndirs];
+
+  if (!(dirs->path = strdup (dir)))
+  {
+    fprintf (stderr, "watcher_add(): Cannot allocate memory\n");
+    return -1;
+  }
+
+  dirs->wd = -1;
+
+#if defined(WATCH_INOTIFY)
+  if (watcher->fd >= 0 &&
+      (dirs->wd = inotify_add_watch (watcher->fd, dir,
+                                     IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY)) < 0)
+  {
+    fprintf (stderr, "Cannot watch directory %s (%s)\n", dir, strerror (errno));
+    free (dirs->path);
+    return -1;
+  }
+#endif
+
+  watcher->ndirs++;
+
+  return scandir_files (watcher, dir);
+#else
+  return -1;
+#endif
+} /* End of watcher_add() */
+
+/*********************************************************************
+ * watcher_next:
+ *
+ * Wait for the next complete file and return its path, size and
+ * modification time.  Waits return after changes, a signal or at
+ * most WATCH_POLLINTERVAL seconds, letting the caller check for a
+ * stop request.
+ *
+ * Returns 1 when a file is returned, 0 when no file is complete yet
+ * and -1 on error.
+ *********************************************************************/
+int
+watcher_next (Watcher *watcher, char *path, size_t pathsize,
+              int64_t *size, int64_t *mtime)
+{
+#ifndef WATCH_WIN32
+  struct candidate *cand;
+  struct stat st;
+  struct pollfd pfd;
+  time_t now;
+  time_t wait;
+  int timeout;
+  int idx;
+  int rv;
+#if defined(WATCH_INOTIFY)
+  char events[4096] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+  struct inotify_event *event;
+  ssize_t length;
+  char *ptr;
+#endif
+
+  now = time (NULL);
+
+  /* Rescan the directories when polling */
+  if (watcher->fd < 0 && now - watcher->lastscan >= WATCH_POLLINTERVAL)
+  {
+    for (idx = 0; idx < watcher->ndirs; idx++)
+      scandir_files (watcher, watcher->dirs[idx].path);
+
+    watcher->lastscan = now;
+  }
+
+  /* Return the first complete candidate, the others wait */
+  wait = -1;
+
+  for (idx = 0; idx < watcher->ncands; idx++)
+  {
+    cand = &watcher->cands[idx];
+
+    if (stat (cand->path, &st) || !S_ISREG (st.st_mode))
+    {
+      dropcandidate (watcher, idx--);
+      continue;
+    }
+
+    if ((int64_t)st.st_size != cand->size || (int64_t)st.st_mtime != cand->mtime)
+    {
+      cand->size    = (int64_t)st.st_size;
+      cand->mtime   = (int64_t)st.st_mtime;
+      cand->changed = now;
+      cand->closed  = 0;
+    }
+
+    if (cand->closed || now - cand->changed >= watcher->settle)
+    {
+      snprintf (path, pathsize, "%s", cand->path);
+      *size  = cand->size;
+      *mtime = cand->mtime;
+
+      dropcandidate (watcher, idx);
+      return 1;
+    }
+
+    if (wait < 0 || cand->changed + watcher->settle - now < wait)
+      wait = cand->changed + watcher->settle - now;
+  }
+
+  /* Sleep until a candidate may settle, a change or the next scan */
+  if (watcher->fd < 0 && (wait < 0 || wait > watcher->lastscan + WATCH_POLLINTERVAL - now))
+    wait = watcher->lastscan + WATCH_POLLINTERVAL - now;
+  if (wait < 0 || wait > WATCH_POLLINTERVAL)
+    wait = WATCH_POLLINTERVAL;
+
+  timeout = (int)((wait < 1) ? 1000 : wait * 1000);
+
+  pfd.fd      = watcher->fd;
+  pfd.events  = POLLIN;
+  pfd.revents = 0;
+
+  rv = poll (&pfd, (watcher->fd >= 0) ? 1 : 0, timeout);
+
+  if (rv < 0)
+  {
+    if (errno == EINTR)
+      return 0;
+
+    fprintf (stderr, "watcher_next(): poll() failed (%s)\n", strerror (errno));
+    return -1;
+  }
+
+#if defined(WATCH_INOTIFY)
+  if (rv == 0 || watcher->fd < 0)
+    return 0;
+
+  if ((length = read (watcher->fd, events, sizeof (events))) < 0)
+  {
+    if (errno == EINTR || errno == EAGAIN)
+      return 0;
+
+    fprintf (stderr, "watcher_next(): Cannot read events (%s)\n", strerror (errno));
+    return -1;
+  }
+
+  for (ptr = events; ptr < events + length; ptr += sizeof (struct inotify_event) + event->len)
+  {
+    event = (struct inotify_event *)ptr;
+
+    /* Events were lost, rescan all directories */
+    if (event->mask & IN_Q_OVERFLOW)
+    {
+      for (idx = 0; idx < watcher->ndirs; idx++)
+        scandir_files (watcher, watcher->dirs[idx].path);
+      continue;
+    }
+
+    if (!event->len || (event->mask & IN_ISDIR))
+      continue;
+
+    for (idx = 0; idx < watcher->ndirs; idx++)
+    {
+      if (watcher->dirs[idx].wd == event->wd)
+      {
+        addcandidate (watcher, watcher->dirs[idx].path, event->name,
+                      (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) ? 1 : 0, 0);
+        break;
+      }
+    }
+  }
+#endif
+
+  return 0;
+#else
+  return -1;
+#endif
+} /* End of watcher_next() */
+
+/*********************************************************************
+ * watcher_free:
+ *
+ * Stop watching and free a watcher.
+ *********************************************************************/
+void
+watcher_free (Watcher **pwatcher)
+{
+#ifndef WATCH_WIN32
+  Watcher *watcher;
+  int idx;
+
+  if (!pwatcher || !*pwatcher)
+    return;
+
+  watcher = *pwatcher;
+
+  if (watcher->fd >= 0)
+    close (watcher->fd);
+
+  for (idx = 0; idx < watcher->ndirs; idx++)
+    free (watcher->dirs[idx].path);
+
+  for (idx = 0; idx < watcher->ncands; idx++)
+    free (watcher->cands[idx].path);
+
+  free (watcher->dirs);
+  free (watcher->cands);
+  free (watcher);
+  *pwatcher = NULL;
+#endif
+} /* End of watcher_free() */
+
+#ifndef WATCH_WIN32
+/*********************************************************************
+ * scandir_files:
+ *
+ * Add the files of a directory as candidates.
+ *
+ * Returns 0 on success and -1 on error.
+ *********************************************************************/
+static int
+scandir_files (Watcher *watcher, const char *dir)
+{
+  struct dirent *de;
+  DIR *dp;
+
+  if (!(dp = opendir (dir)))
+  {
+    fprintf (stderr, "Cannot open directory %s (%s)\n", dir, strerror (errno));
+    return -1;
+  }
+
+  while ((de = readdir (dp)))
+    addcandidate (watcher, dir, de->d_name, 0, 1);
+
+  closedir (dp);
+
+  return 0;
+} /* End of scandir_files() */
+
+/*********************************************************************
+ * addcandidate:
+ *
+ * Add a file of a directory as a candidate or note a change of a
+ * candidate.  An existing file, found by a scan, is taken as changed
+ * at its modification time, otherwise as changed now.
+ *
+ * Returns 0 on success and -1 if the file is not a candidate.
+ *********************************************************************/
+static int
+addcandidate (Watcher *watcher, const char *dir, const char *name,
+              int closed, int existing)
+{
+  struct candidate *cand = NULL;
+  struct candidate *cands;
+  struct stat st;
+  char path[1024];
+  time_t now = time (NULL);
+  int idx;
+
+  /* Skip hidden files and names rejected by the filter */
+  if (*name == '.' || (watcher->filter && !watcher->filter (name)))
+    return -1;
+
+  snprintf (path, sizeof (path), "%s/%s", dir, name);
+
+  if (stat (path, &st) || !S_ISREG (st.st_mode))
+    return -1;
+
+  for (idx = 0; idx < watcher->ncands; idx++)
+  {
+    if (!strcmp (watcher->cands[idx].path, path))
+    {
+      cand = &watcher->cands[idx];
+      break;
+    }
+  }
+
+  if (!cand)
+  {
+    if (watcher->ncands == watcher->maxcands)
+    {
+      watcher->maxcands = (watcher->maxcands) ? watcher->maxcands * 2 : 64;
+
+      if (!(cands = (struct candidate *)realloc (watcher->cands, watcher->maxcands * sizeof (struct candidate))))
+      {
+        fprintf (stderr, "addcandidate(): Cannot allocate memory\n");
+        return -1;
+      }
+
+      watcher->cands = cands;
+    }
+
+    cand = &watcher->cands[watcher->ncands];
+
+    if (!(cand->path = strdup (path)))
+    {
+      fprintf (stderr, "addcandidate(): Cannot allocate memory\n");
+      return -1;
+    }
+
+    cand->closed = 0;
+    watcher->ncands++;
+  }
+  else if (existing)
+  {
+    /* Already a candidate, changes are found when checked */
+    return 0;
+  }
+
+  cand->size    = (int64_t)st.st_size;
+  cand->mtime   = (int64_t)st.st_mtime;
+  cand->changed = (existing && st.st_mtime < now) ? st.st_mtime : now;
+  cand->closed  = closed;
+
+  return 0;
+} /* End of addcandidate() */
+
+/*********************************************************************
+ * dropcandidate:
+ *
+ * Remove a candidate, keeping the order of the others.
+ *********************************************************************/
+static void
+dropcandidate (Watcher *watcher, int idx)
+{
+  free (watcher->cands[idx].path);
+
+  memmove (&watcher->cands[idx], &watcher->cands[idx + 1],
+           (watcher->ncands - idx - 1) * sizeof (struct candidate));
+
+  watcher->ncands--;
+} /* End of dropcandidate() */
+#endif
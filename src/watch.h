@@ -0,0 +1,32 @@
+/* Watching directories for complete files */
+
+#ifndef WATCH_H
+#define WATCH_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Interval of directory scans when polling, in seconds */
+#define WATCH_POLLINTERVAL 10
+
+typedef struct Watcher_s Watcher;
+
+/* File name filter, returns non-zero for names to watch */
+typedef int (*watch_filter) (const char *name);
+
+Watcher *watcher_init (int settle, watch_filter filter);
+const char *watcher_method (Watcher *watcher);
+int watcher_add (Watcher *watcher, const char *dir);
+int watcher_next (Watcher *watcher, char *path, size_t pathsize,
+                  int64_t *size, int64_t *mtime);
+void watcher_free (Watcher **pwatcher);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WATCH_H */
@@ -0,0 +1,219 @@
+/***************************************************************************
+ * decimtest.c
+ *
+ * Tests of the streaming decimator of sdr2mseed.
+ *
+ * A pseudo-random 24-bit time-series is decimated in chunks of
+ * varying length with the streaming decimator and the output is
+ * compared to decimating the whole time-series at once with
+ * ddecimate(), idecimate() and qdecimate(), for the internal filters,
+ * a designed filter and FFT filtering.  The fixed-point output of
+ * qdecimate() is compared to idecimate(), the double reference.
+ *
+ * For each test a line with the result is printed to stdout.
+ *
+ * modified 2026.292
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libmseed.h>
+
+#include "decimate.h"
+
+#define NSAMPLES 20000
+
+static uint32_t seed = 1;
+
+static int chunked (DecimState *ds, void *input, char sampletype, void *output);
+static void testdouble (int factor, const char *name);
+static void testint (int factor);
+static uint32_t lcg (void);
+
+static int32_t isamples[NSAMPLES];
+
+int
+main (int argc, char **argv)
+{
+  int factors[] = {2, 3, 4, 5, 6, 7, 11};
+  int idx;
+
+  /* 24-bit samples: a slow sine-like ramp with noise */
+  for (idx = 0; idx < NSAMPLES; idx++)
+    isamples[idx] = (int32_t) ((idx % 400 - 200) * 20000) + (int32_t) (lcg () % 2000001) - 1000000;
+
+  for (idx = 0; idx < (int)(sizeof (factors) / sizeof (factors[0])); idx++)
+    testdouble (factors[idx], "direct form");
+
+  /* Overlap-save FFT filtering */
+  decim_setfft (1);
+  testdouble (5, "FFT");
+  testdouble (11, "FFT");
+  decim_setfft (-1);
+
+  for (idx = 0; idx < (int)(sizeof (factors) / sizeof (factors[0])); idx++)
+    testint (factors[idx]);
+
+  decim_freescratch ();
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * testdouble():
+ * Compare chunked streaming decimation of double samples to
+ * ddecimate() of the whole time-series.
+ ***************************************************************************/
+static void
+testdouble (int factor, const char *name)
+{
+  DecimState *ds;
+  double *fir;
+  double *whole;
+  double *input;
+  double *output;
+  int firnc;
+  int firsym;
+  int nwhole;
+  int nout;
+  int idx;
+
+  /* Designed filters are passed explicitly to the whole array routines */
+  decim_getfir (factor, &fir, &firnc, &firsym);
+
+  whole  = (double *)malloc (NSAMPLES * sizeof (double));
+  input  = (double *)malloc (NSAMPLES * sizeof (double));
+  output = (double *)malloc ((NSAMPLES + 1000) * sizeof (double));
+
+  for (idx = 0; idx < NSAMPLES; idx++)
+    whole[idx] = input[idx] = (double)isamples[idx];
+
+  nwhole = ddecimate (whole, NSAMPLES, factor, fir, firnc, firsym);
+
+  ds   = decim_init (factor, fir, firnc, firsym);
+  nout = chunked (ds, input, 'd', output);
+
+  if (nout != nwhole || memcmp (whole, output, nout * sizeof (double)))
+    printf ("FAILED: double decimation by %d (%s): chunked output differs\n", factor, name);
+  else
+    printf ("Double decimation by %d (%s): %d samples, chunked output identical\n",
+            factor, name, nout);
+
+  decim_free (&ds);
+  free (whole);
+  free (input);
+  free (output);
+} /* End of testdouble() */
+
+/***************************************************************************
+ * testint():
+ * Compare chunked fixed-point streaming decimation to qdecimate() of
+ * the whole time-series, and qdecimate() to idecimate().
+ ***************************************************************************/
+static void
+testint (int factor)
+{
+  DecimState *ds;
+  double *fir;
+  int32_t *whole;
+  int32_t *fixed;
+  int32_t *output;
+  int firnc;
+  int firsym;
+  int nwhole;
+  int nfixed;
+  int nout;
+  int maxerr = 0;
+  int idx;
+
+  decim_getfir (factor, &fir, &firnc, &firsym);
+
+  whole  = (int32_t *)malloc (NSAMPLES * sizeof (int32_t));
+  fixed  = (int32_t *)malloc (NSAMPLES * sizeof (int32_t));
+  output = (int32_t *)malloc ((NSAMPLES + 1000) * sizeof (int32_t));
+
+  memcpy (whole, isamples, NSAMPLES * sizeof (int32_t));
+  memcpy (fixed, isamples, NSAMPLES * sizeof (int32_t));
+
+  nwhole = idecimate (whole, NSAMPLES, factor, fir, firnc, firsym);
+  nfixed = qdecimate (fixed, NSAMPLES, factor, fir, firnc, firsym);
+
+  ds   = decim_init_fixed (factor, fir, firnc, firsym);
+  nout = chunked (ds, isamples, 'i', output);
+
+  if (nout != nfixed || memcmp (fixed, output, nout * sizeof (int32_t)))
+    printf ("FAILED: fixed-point decimation by %d: chunked output differs\n", factor);
+  else
+    printf ("Fixed-point decimation by %d: %d samples, chunked output identical\n",
+            factor, nout);
+
+  if (nfixed != nwhole)
+  {
+    printf ("FAILED: fixed-point decimation by %d: %d samples, double reference %d\n",
+            factor, nfixed, nwhole);
+  }
+  else
+  {
+    for (idx = 0; idx < nfixed; idx++)
+      if (abs (fixed[idx] - whole[idx]) > maxerr)
+        maxerr = abs (fixed[idx] - whole[idx]);
+
+    if (maxerr > 1)
+      printf ("FAILED: fixed-point decimation by %d: error of %d counts against double reference\n",
+              factor, maxerr);
+    else
+      printf ("Fixed-point decimation by %d: error of at most 1 count against double reference\n",
+              factor);
+  }
+
+  decim_free (&ds);
+  free (whole);
+  free (fixed);
+  free (output);
+} /* End of testint() */
+
+/***************************************************************************
+ * chunked():
+ * Decimate the time-series in chunks of 0 to 999 samples followed by
+ * a flush.
+ *
+ * Returns the number of output samples.
+ ***************************************************************************/
+static int
+chunked (DecimState *ds, void *input, char sampletype, void *output)
+{
+  size_t size = (sampletype == 'd') ? sizeof (double) : sizeof (int32_t);
+  int offset  = 0;
+  int nout    = 0;
+  int nin;
+
+  while (offset < NSAMPLES)
+  {
+    nin = lcg () % 1000;
+
+    if (nin > NSAMPLES - offset)
+      nin = NSAMPLES - offset;
+
+    nout += decim_process (ds, (char *)input + offset * size, nin, sampletype,
+                           (char *)output + nout * size);
+    offset += nin;
+  }
+
+  nout += decim_flush (ds, (char *)output + nout * size, sampletype);
+
+  return nout;
+} /* End of chunked() */
+
+/***************************************************************************
+ * lcg():
+ * Returns the next number of a deterministic pseudo-random sequence.
+ ***************************************************************************/
+static uint32_t
+lcg (void)
+{
+  seed = seed * 1103515245U + 12345U;
+
+  return seed >> 8;
+} /* End of lcg() */
@@ -0,0 +1,424 @@
+/***************************************************************************
+ * dlmock.c
+ *
+ * A mock DataLink server for sdr2mseed DataLink output tests.
+ *
+ * Listens on a free port of the loopback interface, written to the
+ * port file when ready, and accepts one client connection at a time.
+ * ID packets are answered with a server ID accepting WRITE packets,
+ * WRITE packets requesting an acknowledgement are acknowledged.  The
+ * record of each WRITE packet is unpacked and checked against its
+ * header.  With -d the connection is ended when the given WRITE
+ * packet is received, once, without using the packet or any packet
+ * following it, to test reconnecting.
+ *
+ * When a client closes its connection a summary of the records of
+ * each stream is printed to stdout and the server exits.
+ *
+ * modified 2026.292
+ ***************************************************************************/
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <libmseed.h>
+
+#define PACKAGE "dlmock"
+#define VERSION "[libmseed " LIBMSEED_VERSION " " PACKAGE " ]"
+
+#define MAXSTREAMS 16
+
+/* Records received of a stream */
+struct stream
+{
+  char streamid[60];  /* DataLink stream ID */
+  int records;        /* Records received */
+  int64_t samples;    /* Samples of the records */
+  hptime_t starttime; /* Start of the first record */
+  hptime_t endtime;   /* End of the last record */
+  int gaps;           /* Records not following the previous record */
+};
+
+static struct stream streams[MAXSTREAMS];
+static int numstreams   = 0;
+static int packetsize   = 512;
+static int droppacket   = 0;
+static char *portfile   = 0;
+static int connections  = 0;
+static int writepackets = 0;
+static int ackpackets   = 0;
+static int badpackets   = 0;
+static MSRecord *msr    = 0;
+
+static int serve (int fd);
+static int readfull (int fd, char *buf, int len);
+static void drain (int fd);
+static int sendresponse (int fd, char *header);
+static void addrecord (char *streamid, hptime_t start, hptime_t end, char *record, int reclen);
+static void summary (void);
+static int parameter_proc (int argcount, char **argvec);
+static void usage (void);
+
+int
+main (int argc, char **argv)
+{
+  struct sockaddr_in addr;
+  socklen_t addrlen = sizeof (addr);
+  char tmpfile[1024];
+  FILE *fp;
+  int lfd;
+  int fd;
+
+  if (parameter_proc (argc, argv) < 0)
+    return -1;
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  addr.sin_port        = 0;
+
+  if ((lfd = socket (AF_INET, SOCK_STREAM, 0)) < 0 ||
+      bind (lfd, (struct sockaddr *)&addr, sizeof (addr)) ||
+      listen (lfd, 1) ||
+      getsockname (lfd, (struct sockaddr *)&addr, &addrlen))
+  {
+    fprintf (stderr, "Cannot listen: %s\n", strerror (errno));
+    return 1;
+  }
+
+  /* Write the port file complete at once */
+  snprintf (tmpfile, sizeof (tmpfile), "%s.tmp", portfile);
+
+  if (!(fp = fopen (tmpfile, "w")) ||
+      fprintf (fp, "%d\n", ntohs (addr.sin_port)) < 0 ||
+      fclose (fp) || rename (tmpfile, portfile))
+  {
+    fprintf (stderr, "Cannot write port file %s: %s\n", portfile, strerror (errno));
+    return 1;
+  }
+
+  /* Serve connections until a client closes its connection */
+  while ((fd = accept (lfd, NULL, NULL)) >= 0)
+  {
+    connections++;
+
+    if (serve (fd) == 0)
+    {
+      close (fd);
+      break;
+    }
+
+    close (fd);
+  }
+
+  close (lfd);
+
+  summary ();
+
+  msr_free (&msr);
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * serve():
+ * Serve a client connection.
+ *
+ * Returns 0 when the client closed the connection and -1 when it was
+ * closed by the server or on error.
+ ***************************************************************************/
+static int
+serve (int fd)
+{
+  static char record[MAXRECLEN];
+  char header[256];
+  char response[256];
+  char streamid[256];
+  unsigned char preamble[3];
+  long long int start;
+  long long int end;
+  char flag;
+  int size;
+
+  for (;;)
+  {
+    if (readfull (fd, (char *)preamble, 3) <= 0)
+      return 0;
+
+    if (preamble[0] != 'D' || preamble[1] != 'L' ||
+        readfull (fd, header, preamble[2]) <= 0)
+      return -1;
+
+    header[preamble[2]] = '\0';
+
+    if (!strncmp (header, "ID ", 3))
+    {
+      snprintf (response, sizeof (response),
+                "ID DataLink 2026.292 :: DLPROTO:1.0 PACKETSIZE:%d WRITE", packetsize);
+
+      if (sendresponse (fd, response))
+        return -1;
+    }
+    else if (sscanf (header, "WRITE %255s %lld %lld %c %d", streamid, &start, &end, &flag, &size) == 5)
+    {
+      if (size < 0 || size > packetsize || readfull (fd, record, size) <= 0)
+        return -1;
+
+      writepackets++;
+
+      /* Close the connection without using the packet */
+      if (writepackets == droppacket)
+      {
+        drain (fd);
+        return -1;
+      }
+
+      addrecord (streamid, (hptime_t)start, (hptime_t)end, record, size);
+
+      if (flag == 'A')
+      {
+        ackpackets++;
+        snprintf (response, sizeof (response), "OK %d 0", writepackets);
+
+        if (sendresponse (fd, response))
+          return -1;
+      }
+    }
+    else
+    {
+      fprintf (stderr, "Unexpected packet: %s\n", header);
+      return -1;
+    }
+  }
+} /* End of serve() */
+
+/***************************************************************************
+ * readfull():
+ * Read len bytes from a socket.
+ *
+ * Returns 1 on success, 0 at the end of the connection and -1 on
+ * error.
+ ***************************************************************************/
+static int
+readfull (int fd, char *buf, int len)
+{
+  ssize_t nread;
+  int have = 0;
+
+  while (have < len)
+  {
+    if ((nread = recv (fd, buf + have, len - have, 0)) <= 0)
+      return (nread == 0 && have == 0) ? 0 : -1;
+
+    have += (int)nread;
+  }
+
+  return 1;
+} /* End of readfull() */
+
+/***************************************************************************
+ * drain():
+ * End the connection after the responses sent so far and discard the
+ * packets still sent by the client until it closes the connection.
+ * Closing with unread packets would reset the connection and could
+ * lose responses.
+ ***************************************************************************/
+static void
+drain (int fd)
+{
+  char buf[4096];
+
+  shutdown (fd, SHUT_WR);
+
+  while (recv (fd, buf, sizeof (buf), 0) > 0)
+    ;
+} /* End of drain() */
+
+/***************************************************************************
+ * sendresponse():
+ * Send a response packet without data.
+ *
+ * Returns 0 on success and -1 on error.
+ ***************************************************************************/
+static int
+sendresponse (int fd, char *header)
+{
+  char packet[258];
+  size_t hlen = strlen (header);
+
+  packet[0] = 'D';
+  packet[1] = 'L';
+  packet[2] = (char)hlen;
+  memcpy (packet + 3, header, hlen);
+
+  return (send (fd, packet, 3 + hlen, 0) == (ssize_t)(3 + hlen)) ? 0 : -1;
+} /* End of sendresponse() */
+
+/***************************************************************************
+ * addrecord():
+ * Check a record against its WRITE packet header and add it to its
+ * stream.
+ ***************************************************************************/
+static void
+addrecord (char *streamid, hptime_t start, hptime_t end, char *record, int reclen)
+{
+  struct stream *stream = NULL;
+  char srcname[60];
+  int idx;
+
+  if (msr_unpack (record, reclen, &msr, 0, 0) != MS_NOERROR)
+  {
+    badpackets++;
+    return;
+  }
+
+  msr_srcname (msr, srcname, 0);
+  strcat (srcname, "/MSEED");
+
+  if (strcmp (srcname, streamid) || msr->starttime != start || msr_endtime (msr) != end)
+  {
+    badpackets++;
+    return;
+  }
+
+  for (idx = 0; idx < numstreams; idx++)
+  {
+    if (!strcmp (streams[idx].streamid, streamid))
+      stream = &streams[idx];
+  }
+
+  if (!stream)
+  {
+    if (numstreams >= MAXSTREAMS)
+    {
+      badpackets++;
+      return;
+    }
+
+    stream = &streams[numstreams++];
+    strcpy (stream->streamid, streamid);
+    stream->starttime = start;
+  }
+  else if (start != stream->endtime + (hptime_t)(HPTMODULUS / msr->samprate))
+  {
+    stream->gaps++;
+  }
+
+  stream->records++;
+  stream->samples += msr->samplecnt;
+  stream->endtime = end;
+} /* End of addrecord() */
+
+/***************************************************************************
+ * summary():
+ * Print the connections, packets and records of each stream.
+ ***************************************************************************/
+static void
+summary (void)
+{
+  char starttime[30];
+  char endtime[30];
+  int idx;
+
+  printf ("Connections: %d\n", connections);
+  printf ("WRITE packets: %d, acknowledged: %d, invalid: %d\n",
+          writepackets - ((droppacket && droppacket <= writepackets) ? 1 : 0),
+          ackpackets, badpackets);
+
+  for (idx = 0; idx < numstreams; idx++)
+  {
+    ms_hptime2isotimestr (streams[idx].starttime, starttime, 1);
+    ms_hptime2isotimestr (streams[idx].endtime, endtime, 1);
+
+    printf ("%s: %d records, %lld samples, %s - %s, %d gaps\n",
+            streams[idx].streamid, streams[idx].records,
+            (long long int)streams[idx].samples, starttime, endtime,
+            streams[idx].gaps);
+  }
+} /* End of summary() */
+
+/***************************************************************************
+ * parameter_proc():
+ * Process the command line parameters.
+ *
+ * Returns 0 on success, and -1 on failure
+ ***************************************************************************/
+static int
+parameter_proc (int argcount, char **argvec)
+{
+  int optind;
+
+  for (optind = 1; optind < argcount; optind++)
+  {
+    if (strcmp (argvec[optind], "-V") == 0)
+    {
+      fprintf (stderr, "%s version: %s\n", PACKAGE, VERSION);
+      exit (0);
+    }
+    else if (strcmp (argvec[optind], "-h") == 0)
+    {
+      usage ();
+      exit (0);
+    }
+    else if (strcmp (argvec[optind], "-d") == 0 && optind + 1 < argcount)
+    {
+      droppacket = atoi (argvec[++optind]);
+    }
+    else if (strcmp (argvec[optind], "-s") == 0 && optind + 1 < argcount)
+    {
+      packetsize = atoi (argvec[++optind]);
+    }
+    else if (strncmp (argvec[optind], "-", 1) == 0 &&
+             strlen (argvec[optind]) > 1)
+    {
+      fprintf (stderr, "Unknown option: %s\n", argvec[optind]);
+      exit (1);
+    }
+    else if (portfile == 0)
+    {
+      portfile = argvec[optind];
+    }
+    else
+    {
+      fprintf (stderr, "Unknown option: %s\n", argvec[optind]);
+      exit (1);
+    }
+  }
+
+  if (!portfile)
+  {
+    fprintf (stderr, "No port file was specified\n\n");
+    fprintf (stderr, "Try %s -h for usage\n", PACKAGE);
+    exit (1);
+  }
+
+  if (packetsize <= 0 || packetsize > MAXRECLEN)
+    packetsize = 512;
+
+  return 0;
+} /* End of parameter_proc() */
+
+/***************************************************************************
+ * usage():
+ * Print the usage message and exit.
+ ***************************************************************************/
+static void
+usage (void)
+{
+  fprintf (stderr, "%s version: %s\n\n", PACKAGE, VERSION);
+  fprintf (stderr, "Usage: %s [options] portfile\n\n", PACKAGE);
+  fprintf (stderr,
+           " ## Options ##\n"
+           " -V             Report program version\n"
+           " -h             Show this usage message\n"
+           " -d packet      Close the connection when receiving WRITE packet number\n"
+           " -s bytes       Packet size reported to clients, default: 512\n"
+           "\n"
+           " portfile       File the listening port is written to\n"
+           "\n");
+} /* End of usage() */
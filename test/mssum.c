@@ -0,0 +1,190 @@
+/***************************************************************************
+ * mssum.c
+ *
+ * Summarize the Mini-SEED records of files for sdr2mseed output tests.
+ *
+ * For each stream, in source name order, the number of records and a
+ * hash of the records that does not depend on their order are
+ * printed, followed by each contiguous segment with its time range,
+ * number of samples and a hash of the samples.  Output of different
+ * conversions, e.g. written to one file or to archive day files, can
+ * be compared with the summaries.
+ *
+ * modified 2026.292
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libmseed.h>
+
+#define PACKAGE "mssum"
+#define VERSION "[libmseed " LIBMSEED_VERSION " " PACKAGE " ]"
+
+/* Records of a stream */
+struct streamsum
+{
+  int records;   /* Number of records */
+  uint64_t hash; /* Sum of the record hashes */
+};
+
+static uint64_t hashbytes (const void *data, size_t length);
+static int cmpsrcname (const void *a, const void *b);
+static void summary (MSTraceList *mstl);
+static void usage (void);
+
+int
+main (int argc, char **argv)
+{
+  MSFileParam *msfp = NULL;
+  MSRecord *msr     = NULL;
+  MSTraceList *mstl = NULL;
+  MSTraceSeg *seg;
+  struct streamsum *sum;
+  int retcode;
+  int idx;
+
+  if (argc < 2 || !strcmp (argv[1], "-h"))
+  {
+    usage ();
+    return (argc < 2) ? 1 : 0;
+  }
+
+  if (!strcmp (argv[1], "-V"))
+  {
+    fprintf (stderr, "%s version: %s\n", PACKAGE, VERSION);
+    return 0;
+  }
+
+  if (!(mstl = mstl_init (NULL)))
+    return 1;
+
+  for (idx = 1; idx < argc; idx++)
+  {
+    while ((retcode = ms_readmsr_r (&msfp, &msr, argv[idx], 0, NULL, NULL, 1, 1, 0)) == MS_NOERROR)
+    {
+      if (!(seg = mstl_addmsr (mstl, msr, 0, 1, -1.0, -1.0)))
+      {
+        fprintf (stderr, "Cannot add record of %s\n", argv[idx]);
+        return 1;
+      }
+
+      /* The trace ID of the record is the last used */
+      if (!(sum = (struct streamsum *)mstl->last->prvtptr))
+      {
+        if (!(sum = (struct streamsum *)calloc (1, sizeof (struct streamsum))))
+          return 1;
+
+        mstl->last->prvtptr = sum;
+      }
+
+      sum->records++;
+      sum->hash += hashbytes (msr->record, msr->reclen);
+    }
+
+    if (retcode != MS_ENDOFFILE)
+    {
+      fprintf (stderr, "Cannot read %s: %s\n", argv[idx], ms_errorstr (retcode));
+      return 1;
+    }
+
+    ms_readmsr_r (&msfp, &msr, NULL, 0, NULL, NULL, 0, 0, 0);
+  }
+
+  summary (mstl);
+
+  mstl_free (&mstl, 1);
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * summary():
+ * Print the records and segments of each stream in source name order.
+ ***************************************************************************/
+static void
+summary (MSTraceList *mstl)
+{
+  MSTraceID **ids;
+  MSTraceID *id;
+  MSTraceSeg *seg;
+  struct streamsum *sum;
+  char starttime[30];
+  char endtime[30];
+  size_t size;
+  int count = 0;
+  int idx;
+
+  if (!(ids = (MSTraceID **)malloc ((mstl->numtraces + 1) * sizeof (MSTraceID *))))
+    return;
+
+  for (id = mstl->traces; id; id = id->next)
+    ids[count++] = id;
+
+  qsort (ids, count, sizeof (MSTraceID *), cmpsrcname);
+
+  for (idx = 0; idx < count; idx++)
+  {
+    id  = ids[idx];
+    sum = (struct streamsum *)id->prvtptr;
+
+    printf ("%s: %d records, record hash %016llx\n", id->srcname,
+            sum->records, (unsigned long long int)sum->hash);
+
+    for (seg = id->first; seg; seg = seg->next)
+    {
+      ms_hptime2isotimestr (seg->starttime, starttime, 1);
+      ms_hptime2isotimestr (seg->endtime, endtime, 1);
+      size = (seg->sampletype == 'd') ? 8 : (seg->sampletype == 'a') ? 1 : 4;
+
+      printf ("  %s - %s, %g sps, %lld samples, sample hash %016llx\n",
+              starttime, endtime, seg->samprate, (long long int)seg->numsamples,
+              (unsigned long long int)hashbytes (seg->datasamples, seg->numsamples * size));
+    }
+  }
+
+  free (ids);
+} /* End of summary() */
+
+/***************************************************************************
+ * hashbytes():
+ * Returns the 64-bit FNV-1a hash of bytes.
+ ***************************************************************************/
+static uint64_t
+hashbytes (const void *data, size_t length)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  uint64_t hash              = 14695981039346656037ULL;
+  size_t idx;
+
+  for (idx = 0; idx < length; idx++)
+  {
+    hash ^= bytes[idx];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+} /* End of hashbytes() */
+
+/***************************************************************************
+ * cmpsrcname():
+ * Compare the source names of two trace IDs for qsort().
+ ***************************************************************************/
+static int
+cmpsrcname (const void *a, const void *b)
+{
+  return strcmp ((*(MSTraceID *const *)a)->srcname, (*(MSTraceID *const *)b)->srcname);
+} /* End of cmpsrcname() */
+
+/***************************************************************************
+ * usage():
+ * Print the usage message.
+ ***************************************************************************/
+static void
+usage (void)
+{
+  fprintf (stderr, "%s version: %s\n\n", PACKAGE, VERSION);
+  fprintf (stderr, "Usage: %s file [file ...]\n\n", PACKAGE);
+  fprintf (stderr, "Print a summary of the records and samples of each stream\n\n");
+} /* End of usage() */
@@ -0,0 +1,197 @@
+/***************************************************************************
+ * sdrcut.c
+ *
+ * Write a modified copy of an SDR file for sdr2mseed tests.
+ *
+ * With -n the copy holds only the first data blocks, as a growing
+ * file does while it is written.  With -z the file info entry of a
+ * data block is cleared in the header, the block is unused.
+ *
+ * modified 2026.292
+ ***************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sdrformat.h"
+
+#define PACKAGE "sdrcut"
+#define VERSION "[libmseed " LIBMSEED_VERSION " " PACKAGE " ]"
+
+#define MAXCLEAR 16
+
+static int numblocks = -1;
+static int clear[MAXCLEAR];
+static int numclear  = 0;
+static char *infile  = 0;
+static char *outfile = 0;
+
+static int parameter_proc (int argcount, char **argvec);
+static void usage (void);
+
+int
+main (int argc, char **argv)
+{
+  static HeaderBlock hblock;
+  FileInfo *last;
+  FILE *ifp;
+  FILE *ofp;
+  char buf[4096];
+  long length = -1;
+  size_t nread;
+  int idx;
+
+  if (parameter_proc (argc, argv) < 0)
+    return 1;
+
+  if (!(ifp = fopen (infile, "rb")) || fread (&hblock, sizeof (HeaderBlock), 1, ifp) != 1)
+  {
+    fprintf (stderr, "Cannot read %s: %s\n", infile, strerror (errno));
+    return 1;
+  }
+
+  /* Keep the first blocks, the file ends at the following block */
+  if (numblocks >= 0 && numblocks < hblock.numBlocks)
+  {
+    if (numblocks > 0)
+    {
+      last                   = &hblock.fileInfo[numblocks - 1];
+      hblock.lastTime        = last->startTime;
+      hblock.lastBlockSize   = last->blockSize;
+      hblock.lastBlockOffset = last->filePosition;
+    }
+
+    length = hblock.fileInfo[numblocks].filePosition;
+
+    memset (&hblock.fileInfo[numblocks], 0, (MAX_FILE_INFO - numblocks) * sizeof (FileInfo));
+    hblock.numBlocks = numblocks;
+  }
+
+  for (idx = 0; idx < numclear; idx++)
+  {
+    if (clear[idx] >= 0 && clear[idx] < MAX_FILE_INFO)
+      memset (&hblock.fileInfo[clear[idx]], 0, sizeof (FileInfo));
+  }
+
+  if (!(ofp = fopen (outfile, "wb")) || fwrite (&hblock, sizeof (HeaderBlock), 1, ofp) != 1)
+  {
+    fprintf (stderr, "Cannot write %s: %s\n", outfile, strerror (errno));
+    return 1;
+  }
+
+  length -= (length >= 0) ? (long)sizeof (HeaderBlock) : 0;
+
+  while (length != 0 &&
+         (nread = fread (buf, 1, (length > 0 && length < (long)sizeof (buf)) ? (size_t)length : sizeof (buf), ifp)) > 0)
+  {
+    if (fwrite (buf, 1, nread, ofp) != nread)
+    {
+      fprintf (stderr, "Cannot write %s: %s\n", outfile, strerror (errno));
+      return 1;
+    }
+
+    if (length > 0)
+      length -= (long)nread;
+  }
+
+  fclose (ifp);
+
+  if (fclose (ofp))
+  {
+    fprintf (stderr, "Cannot write %s: %s\n", outfile, strerror (errno));
+    return 1;
+  }
+
+  return 0;
+} /* End of main() */
+
+/***************************************************************************
+ * parameter_proc():
+ * Process the command line parameters.
+ *
+ * Returns 0 on success, and -1 on failure
+ ***************************************************************************/
+static int
+parameter_proc (int argcount, char **argvec)
+{
+  int optind;
+
+  for (optind = 1; optind < argcount; optind++)
+  {
+    if (strcmp (argvec[optind], "-V") == 0)
+    {
+      fprintf (stderr, "%s version: %s\n", PACKAGE, VERSION);
+      exit (0);
+    }
+    else if (strcmp (argvec[optind], "-h") == 0)
+    {
+      usage ();
+      exit (0);
+    }
+    else if (strcmp (argvec[optind], "-n") == 0 && optind + 1 < argcount)
+    {
+      numblocks = atoi (argvec[++optind]);
+    }
+    else if (strcmp (argvec[optind], "-z") == 0 && optind + 1 < argcount)
+    {
+      if (numclear >= MAXCLEAR)
+      {
+        fprintf (stderr, "More than %d blocks to clear\n", MAXCLEAR);
+        exit (1);
+      }
+
+      clear[numclear++] = atoi (argvec[++optind]);
+    }
+    else if (strncmp (argvec[optind], "-", 1) == 0 &&
+             strlen (argvec[optind]) > 1)
+    {
+      fprintf (stderr, "Unknown option: %s\n", argvec[optind]);
+      exit (1);
+    }
+    else if (infile == 0)
+    {
+      infile = argvec[optind];
+    }
+    else if (outfile == 0)
+    {
+      outfile = argvec[optind];
+    }
+    else
+    {
+      fprintf (stderr, "Unknown option: %s\n", argvec[optind]);
+      exit (1);
+    }
+  }
+
+  if (!infile || !outfile)
+  {
+    fprintf (stderr, "No input and output files were specified\n\n");
+    fprintf (stderr, "Try %s -h for usage\n", PACKAGE);
+    exit (1);
+  }
+
+  return 0;
+} /* End of parameter_proc() */
+
+/***************************************************************************
+ * usage():
+ * Print the usage message and exit.
+ ***************************************************************************/
+static void
+usage (void)
+{
+  fprintf (stderr, "%s version: %s\n\n", PACKAGE, VERSION);
+  fprintf (stderr, "Usage: %s [options] infile outfile\n\n", PACKAGE);
+  fprintf (stderr,
+           " ## Options ##\n"
+           " -V             Report program version\n"
+           " -h             Show this usage message\n"
+           " -n blocks      Copy only the first number of data blocks\n"
+           " -z block       Clear the file info entry of a data block, starting at 0\n"
+           "\n"
+           " infile         SDR file to copy\n"
+           " outfile        Copy written\n"
+           "\n");
+} /* End of usage() */